@@ -0,0 +1,709 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+// rme-bench, times the map code of the editor on synthetic maps without
+// opening a window and prints the results as JSON.
+//
+//   rme-bench [--width=512] [--height=512] [--floors=1] [--density=0.9]
+//             [--items=1.5] [--containers=0.02] [--container-items=4]
+//             [--houses=64] [--spawns=128] [--zones=16] [--seed=1]
+//             [--iterations=5] [--actions=256] [--dir=<temp dir>]
+//             [--output=<file>] [--only=<benchmark,...>]
+//
+// peak_rss_kb in the report is the peak of the whole process, compare readers
+// by running them on their own: --only=read_disk and --only=read_mapped.
+
+#include "main.h"
+
+#include "settings.h"
+#include "editor.h"
+#include "copybuffer.h"
+#include "iomap_otbm.h"
+#include "tile.h"
+#include "item.h"
+#include "complexitem.h"
+#include "action.h"
+#include "map_reachability.h"
+#include "sprite_batch.h"
+#include "filehandle.h"
+
+#include "map_generator.h"
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <wx/init.h>
+
+#ifdef _WIN32
+#	include <windows.h>
+#	include <psapi.h>
+#else
+#	include <sys/resource.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace {
+	struct BenchOptions
+	{
+		MapGeneratorOptions map;
+		int iterations = 5;
+		int actions = 256;
+		std::string dir;
+		std::string output;
+		std::set<std::string> only;
+	};
+
+	class Stopwatch
+	{
+	public:
+		void start() { begin = std::chrono::steady_clock::now(); }
+		void stop() { samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count()); }
+
+		const std::vector<double>& getSamples() const noexcept { return samples; }
+
+	private:
+		std::chrono::steady_clock::time_point begin;
+		std::vector<double> samples;
+	};
+
+	json summarize(const std::string& name, const Stopwatch& watch, uint64_t work)
+	{
+		std::vector<double> samples = watch.getSamples();
+		std::sort(samples.begin(), samples.end());
+
+		double total = 0;
+		for(double sample : samples) {
+			total += sample;
+		}
+
+		json result;
+		result["name"] = name;
+		result["iterations"] = samples.size();
+		result["work"] = work;
+		if(!samples.empty()) {
+			const double median = samples.size() % 2 ? samples[samples.size() / 2] : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+			result["min_ms"] = samples.front();
+			result["median_ms"] = median;
+			result["mean_ms"] = total / samples.size();
+			result["max_ms"] = samples.back();
+			result["samples_ms"] = samples;
+		}
+		return result;
+	}
+
+	bool parseArguments(int argc, char** argv, BenchOptions& options)
+	{
+		for(int i = 1; i < argc; ++i) {
+			const std::string argument = argv[i];
+			const size_t separator = argument.find('=');
+			if(argument.compare(0, 2, "--") != 0 || separator == std::string::npos) {
+				std::cerr << "Unexpected argument " << argument << std::endl;
+				return false;
+			}
+
+			const std::string key = argument.substr(2, separator - 2);
+			const std::string value = argument.substr(separator + 1);
+			try {
+				if(key == "width") options.map.width = std::stoi(value);
+				else if(key == "height") options.map.height = std::stoi(value);
+				else if(key == "floors") options.map.floors = std::stoi(value);
+				else if(key == "density") options.map.density = std::stod(value);
+				else if(key == "items") options.map.items = std::stod(value);
+				else if(key == "containers") options.map.containers = std::stod(value);
+				else if(key == "container-items") options.map.container_items = std::stoi(value);
+				else if(key == "houses") options.map.houses = std::stoi(value);
+				else if(key == "spawns") options.map.spawns = std::stoi(value);
+				else if(key == "zones") options.map.zones = std::stoi(value);
+				else if(key == "seed") options.map.seed = static_cast<uint32_t>(std::stoul(value));
+				else if(key == "iterations") options.iterations = std::stoi(value);
+				else if(key == "actions") options.actions = std::stoi(value);
+				else if(key == "dir") options.dir = value;
+				else if(key == "output") options.output = value;
+				else if(key == "only") {
+					std::istringstream names(value);
+					std::string name;
+					while(std::getline(names, name, ',')) {
+						options.only.insert(name);
+					}
+				} else {
+					std::cerr << "Unknown option --" << key << std::endl;
+					return false;
+				}
+			} catch(const std::exception&) {
+				std::cerr << "Invalid value for --" << key << ": " << value << std::endl;
+				return false;
+			}
+		}
+
+		if(options.map.width <= 0 || options.map.height <= 0 || options.map.width + 2 * bench::BASE_POSITION > rme::MapMaxWidth
+			|| options.map.height + 2 * bench::BASE_POSITION > rme::MapMaxHeight) {
+			std::cerr << "The map size is out of range" << std::endl;
+			return false;
+		}
+		if(options.map.floors < 1 || options.map.floors > rme::MapGroundLayer + 1) {
+			std::cerr << "--floors must be between 1 and " << rme::MapGroundLayer + 1 << std::endl;
+			return false;
+		}
+		options.iterations = std::max(options.iterations, 1);
+		options.actions = std::max(options.actions, 1);
+		return true;
+	}
+
+	// Counts items the way foreach_ItemOnMap callers do
+	struct CountItems
+	{
+		void operator()(Map& map, Tile* tile, Item* item, long long done)
+		{
+			++count;
+		}
+		uint64_t count = 0;
+	};
+
+	// The same for parallel_foreach_ItemOnMap
+	struct ParallelCountItems
+	{
+		void operator()(Map& map, Tile* tile, Item* item)
+		{
+			++count;
+		}
+		void merge(const ParallelCountItems& other)
+		{
+			count += other.count;
+		}
+		uint64_t count = 0;
+	};
+
+	// IOMapOTBM::loadMap always reads through MappedNodeFileReadHandle, this
+	// loads the tile data through any node reader so that they can be compared
+	class NodeReaderLoader : public IOMapOTBM
+	{
+	public:
+		NodeReaderLoader(MapVersion version) : IOMapOTBM(version) {}
+
+		bool loadNodes(Map& map, NodeFileReadHandle& handle) { return loadMap(map, handle); }
+	};
+
+	// Kilobytes
+	uint64_t getPeakResidentSize()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return 0;
+		return counters.PeakWorkingSetSize / 1024;
+#else
+		struct rusage usage;
+		if(getrusage(RUSAGE_SELF, &usage) != 0)
+			return 0;
+#	ifdef __APPLE__
+		return usage.ru_maxrss / 1024;
+#	else
+		return usage.ru_maxrss;
+#	endif
+#endif
+	}
+
+	std::string readFile(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	void removeSavedFiles(const std::string& dir, const std::string& name)
+	{
+		const wxString path = wxstr(dir) + wxFileName::GetPathSeparator();
+		wxRemoveFile(path + wxstr(name) + ".otbm");
+		wxRemoveFile(path + wxstr(name) + ".otgz");
+		wxRemoveFile(path + "bench-house.xml");
+		wxRemoveFile(path + "bench-spawn.xml");
+		wxFileName::Rmdir(path + wxstr(name) + "-zones", wxPATH_RMDIR_RECURSIVE);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	if(!parseArguments(argc, argv, options)) {
+		return 1;
+	}
+
+	// Only the base library, no display is needed
+	wxInitializer initializer(argc, argv);
+	if(!initializer.IsOk()) {
+		std::cerr << "Could not initialize wxWidgets" << std::endl;
+		return 1;
+	}
+
+	if(options.dir.empty()) {
+		options.dir = nstr(wxFileName::GetTempDir());
+	}
+
+	// The built-in defaults are used instead of the user's configuration so
+	// that runs are comparable. Every action is kept so that all of them can be undone.
+	g_settings.setInteger(Config::UNDO_SIZE, options.actions + 16);
+	g_settings.setInteger(Config::UNDO_MEM_SIZE, 1 << 20);
+	g_settings.setInteger(Config::GROUP_ACTIONS, 0);
+
+	bench::setupItemsAndBrushes();
+
+	auto enabled = [&](const std::string& name) {
+		return options.only.empty() || options.only.count(name) != 0;
+	};
+
+	json results = json::array();
+
+	CopyBuffer copybuffer;
+	Editor editor(copybuffer, bench::getMapVersion());
+	Map& map = editor.getMap();
+
+	std::cerr << "Generating map..." << std::endl;
+	Stopwatch generate_watch;
+	generate_watch.start();
+	const GeneratedMapInfo info = bench::generateMap(map, options.map);
+	generate_watch.stop();
+	results.push_back(summarize("generate", generate_watch, info.tiles));
+
+	if(enabled("iterate")) {
+		std::cerr << "Iterating..." << std::endl;
+		Stopwatch watch;
+		uint64_t items = 0;
+		for(int i = 0; i < options.iterations; ++i) {
+			items = 0;
+			watch.start();
+			for(TileLocation* location : map) {
+				items += location->get()->size();
+			}
+			watch.stop();
+		}
+		results.push_back(summarize("iterate", watch, items));
+	}
+
+	if(enabled("tile_update")) {
+		// Reads the unique id of every item through its attributes, the generator
+		// gives some items action ids so not every attribute list is empty
+		std::cerr << "Updating tiles..." << std::endl;
+		Stopwatch watch;
+		for(int i = 0; i < options.iterations; ++i) {
+			watch.start();
+			for(TileLocation* location : map) {
+				location->get()->update();
+			}
+			watch.stop();
+		}
+		results.push_back(summarize("tile_update", watch, info.tiles));
+	}
+
+	if(enabled("foreach_item")) {
+		std::cerr << "Visiting items..." << std::endl;
+		Stopwatch watch;
+		uint64_t items = 0;
+		for(int i = 0; i < options.iterations; ++i) {
+			CountItems counter;
+			watch.start();
+			foreach_ItemOnMap(map, counter, false);
+			watch.stop();
+			items = counter.count;
+		}
+		results.push_back(summarize("foreach_item", watch, items));
+	}
+
+	if(enabled("parallel_foreach_item")) {
+		std::cerr << "Visiting items on all threads..." << std::endl;
+		Stopwatch watch;
+		uint64_t items = 0;
+		for(int i = 0; i < options.iterations; ++i) {
+			ParallelCountItems counter;
+			watch.start();
+			parallel_foreach_ItemOnMap(map, counter, false, [](uint64_t, uint64_t) {});
+			watch.stop();
+			items = counter.count;
+		}
+		results.push_back(summarize("parallel_foreach_item", watch, items));
+	}
+
+	if(enabled("reachability")) {
+		std::cerr << "Finding reachable tiles..." << std::endl;
+		Stopwatch watch;
+		uint64_t reachable = 0;
+		for(int i = 0; i < options.iterations; ++i) {
+			watch.start();
+			ReachabilityMap reachability(map);
+			watch.stop();
+
+			reachable = 0;
+			for(TileLocation* location : map) {
+				if(reachability.isReachable(location->getPosition()))
+					++reachable;
+			}
+		}
+		results.push_back(summarize("reachability", watch, reachable));
+	}
+
+	if(enabled("spawn_lookup")) {
+		std::cerr << "Looking up spawns..." << std::endl;
+		Stopwatch watch;
+		uint64_t covered = 0;
+		for(int i = 0; i < options.iterations; ++i) {
+			covered = 0;
+			watch.start();
+			for(TileLocation* location : map) {
+				covered += map.spawns.getSpawnCount(location->getPosition());
+			}
+			watch.stop();
+		}
+		results.push_back(summarize("spawn_lookup", watch, covered));
+	}
+
+	if(enabled("sprite_batch")) {
+		// What MapDrawer records for the ground floor, with the item ids standing
+		// in for the sprites and packed into atlas pages in order. Nothing is
+		// drawn, only the commands are built.
+		std::cerr << "Batching sprites..." << std::endl;
+		const auto getRegion = [](uint16_t id) {
+			TextureRegion region;
+			region.texture = 1 + id / TextureAtlas::SLOTS_PER_PAGE;
+			return region;
+		};
+		Stopwatch watch;
+		SpriteBatch batch;
+		size_t commands = 0;
+		uint64_t quads = 0;
+		for(int i = 0; i < options.iterations; ++i) {
+			watch.start();
+			for(TileLocation* location : map) {
+				const Position& position = location->getPosition();
+				const Tile* tile = location->get();
+				if(!tile || position.z != rme::MapGroundLayer)
+					continue;
+
+				const float x = (position.x - bench::BASE_POSITION) * rme::TileSize;
+				const float y = (position.y - bench::BASE_POSITION) * rme::TileSize;
+				if(tile->ground)
+					batch.add(x, y, rme::TileSize, getRegion(tile->ground->getID()), 255, 255, 255, 255);
+				for(const Item* item : tile->items)
+					batch.add(x, y, rme::TileSize, getRegion(item->getID()), 255, 255, 255, 255);
+			}
+			batch.prepare();
+			watch.stop();
+
+			commands = batch.getCommands().size();
+			quads = batch.getQuadCount();
+			batch.clear();
+		}
+		std::cerr << quads << " quads in " << commands << " draw calls" << std::endl;
+		results.push_back(summarize("sprite_batch", watch, quads));
+	}
+
+	if(enabled("zone_labels")) {
+		// One tile of every zone is taken out and put back, so that all the
+		// labels are found again, as after an edit of each zone
+		std::cerr << "Labelling zones..." << std::endl;
+		std::vector<std::pair<uint16_t, Position>> edits;
+		for(uint16_t zone_id : map.zones.getZoneIds()) {
+			bool found = false;
+			map.zones.forEachSpan(zone_id, [&](int start_x, int, int y, int z) {
+				if(!found)
+					edits.emplace_back(zone_id, Position(start_x, y, z));
+				found = true;
+			});
+		}
+
+		Stopwatch watch;
+		uint64_t labels = 0;
+		for(int i = 0; i < options.iterations; ++i) {
+			for(const auto& edit : edits) {
+				map.zones.remove(edit.first, edit.second);
+				map.zones.add(edit.first, edit.second);
+			}
+
+			labels = 0;
+			watch.start();
+			for(int z = rme::MapMinLayer; z <= rme::MapMaxLayer; ++z) {
+				map.zones.forEachLabel(z, 0, 0, 0xFFFF, 0xFFFF, [&labels](uint16_t, int, int) { ++labels; });
+			}
+			watch.stop();
+		}
+		std::cerr << labels << " zone labels" << std::endl;
+		results.push_back(summarize("zone_labels", watch, info.zone_tiles));
+	}
+
+	const std::string otbm_path = options.dir + "/rme-bench.otbm";
+	const std::string otgz_path = options.dir + "/rme-bench.otgz";
+
+	for(const std::string& format : { std::string("otbm"), std::string("otgz") }) {
+		const std::string& path = format == "otbm" ? otbm_path : otgz_path;
+		if(!enabled("save_" + format) && !enabled("load_" + format)) {
+			continue;
+		}
+
+		std::cerr << "Saving " << format << "..." << std::endl;
+		Stopwatch save_watch;
+		for(int i = 0; i < options.iterations; ++i) {
+			IOMapOTBM saver(map.getVersion());
+			save_watch.start();
+			const bool saved = saver.saveMap(map, wxstr(path));
+			save_watch.stop();
+			if(!saved) {
+				std::cerr << "Could not save " << path << ": " << saver.getError() << std::endl;
+				return 1;
+			}
+		}
+		if(enabled("save_" + format)) {
+			results.push_back(summarize("save_" + format, save_watch, map.getTileCount()));
+		}
+
+		if(enabled("load_" + format)) {
+			std::cerr << "Loading " << format << "..." << std::endl;
+			Stopwatch load_watch;
+			uint64_t tiles = 0;
+			for(int i = 0; i < options.iterations; ++i) {
+				std::unique_ptr<Map> loaded = std::make_unique<Map>();
+				loaded->convert(map.getVersion());
+				// Map::open is only for the editor, the loader is used directly
+				IOMapOTBM loader(map.getVersion());
+				load_watch.start();
+				const bool ok = loader.loadMap(*loaded, wxstr(path));
+				load_watch.stop();
+				if(!ok) {
+					std::cerr << "Could not load " << path << ": " << loader.getError() << std::endl;
+					return 1;
+				}
+				tiles = loaded->getTileCount();
+			}
+			results.push_back(summarize("load_" + format, load_watch, tiles));
+		}
+	}
+
+	if(enabled("read_disk") || enabled("read_mapped")) {
+		// The tile data of one file through the old stream reader and through the mapping
+		IOMapOTBM saver(map.getVersion());
+		if(!saver.saveMap(map, wxstr(otbm_path))) {
+			std::cerr << "Could not save " << otbm_path << ": " << saver.getError() << std::endl;
+			return 1;
+		}
+
+		for(const std::string& reader : { std::string("disk"), std::string("mapped") }) {
+			if(!enabled("read_" + reader)) {
+				continue;
+			}
+
+			std::cerr << "Loading otbm through the " << reader << " reader..." << std::endl;
+			Stopwatch watch;
+			uint64_t tiles = 0;
+			for(int i = 0; i < options.iterations; ++i) {
+				std::unique_ptr<Map> loaded = std::make_unique<Map>();
+				loaded->convert(map.getVersion());
+				NodeReaderLoader loader(map.getVersion());
+				watch.start();
+				std::unique_ptr<NodeFileReadHandle> handle;
+				if(reader == "disk") {
+					handle = std::make_unique<DiskNodeFileReadHandle>(otbm_path, StringVector(1, "OTBM"));
+				} else {
+					handle = std::make_unique<MappedNodeFileReadHandle>(otbm_path, StringVector(1, "OTBM"));
+				}
+				const bool ok = handle->isOk() && loader.loadNodes(*loaded, *handle);
+				handle.reset();
+				watch.stop();
+				if(!ok) {
+					std::cerr << "Could not load " << otbm_path << " through the " << reader << " reader: " << loader.getError() << std::endl;
+					return 1;
+				}
+				tiles = loaded->getTileCount();
+			}
+			results.push_back(summarize("read_" + reader, watch, tiles));
+		}
+	}
+
+	if(enabled("save_threads")) {
+		// The tile areas are serialized on the worker threads, the file must come
+		// out byte for byte the same as the one saved on a single thread
+		std::cerr << "Saving otbm on 1, 4 and 16 threads..." << std::endl;
+		const int worker_threads = g_settings.getInteger(Config::WORKER_THREADS);
+		std::string reference;
+		for(int threads : { 1, 4, 16 }) {
+			g_settings.setInteger(Config::WORKER_THREADS, threads);
+			Stopwatch watch;
+			for(int i = 0; i < options.iterations; ++i) {
+				IOMapOTBM saver(map.getVersion());
+				watch.start();
+				const bool saved = saver.saveMap(map, wxstr(otbm_path));
+				watch.stop();
+				if(!saved) {
+					std::cerr << "Could not save " << otbm_path << ": " << saver.getError() << std::endl;
+					return 1;
+				}
+			}
+
+			const std::string data = readFile(otbm_path);
+			if(threads == 1) {
+				reference = data;
+			} else if(data != reference) {
+				std::cerr << "The map saved on " << threads << " threads differs from the one saved on 1 thread" << std::endl;
+				return 1;
+			}
+			results.push_back(summarize("save_otbm_" + std::to_string(threads) + "_threads", watch, map.getTileCount()));
+		}
+		g_settings.setInteger(Config::WORKER_THREADS, worker_threads);
+	}
+	removeSavedFiles(options.dir, "rme-bench");
+
+	if(enabled("borderize")) {
+		std::cerr << "Borderizing..." << std::endl;
+		Stopwatch watch;
+		for(int i = 0; i < options.iterations; ++i) {
+			watch.start();
+			editor.borderizeMap(false);
+			watch.stop();
+		}
+		results.push_back(summarize("borderize", watch, map.getTileCount()));
+	}
+
+	if(enabled("commit") || enabled("undo") || enabled("redo")) {
+		std::cerr << "Committing, undoing and redoing..." << std::endl;
+
+		// Every action puts an item on each tile of a row of the map
+		std::vector<std::vector<Position>> rows(options.actions);
+		for(int i = 0; i < options.actions; ++i) {
+			const int y = bench::BASE_POSITION + i % options.map.height;
+			for(int x = bench::BASE_POSITION; x < bench::BASE_POSITION + options.map.width; ++x) {
+				if(map.getTile(x, y, rme::MapGroundLayer)) {
+					rows[i].emplace_back(x, y, rme::MapGroundLayer);
+				}
+			}
+		}
+
+		Stopwatch commit_watch;
+		Stopwatch undo_watch;
+		Stopwatch redo_watch;
+		uint64_t changes = 0;
+		for(int i = 0; i < options.iterations; ++i) {
+			changes = 0;
+			commit_watch.start();
+			for(const std::vector<Position>& row : rows) {
+				Action* action = editor.createAction(ACTION_DRAW);
+				for(const Position& position : row) {
+					Tile* new_tile = map.getTile(position)->deepCopy(map);
+					new_tile->addItem(Item::Create(200));
+					action->addChange(newd Change(new_tile));
+					++changes;
+				}
+				editor.addAction(action);
+			}
+			commit_watch.stop();
+
+			undo_watch.start();
+			editor.undo(options.actions);
+			undo_watch.stop();
+
+			redo_watch.start();
+			editor.redo(options.actions);
+			redo_watch.stop();
+
+			// Back to the generated map for the next iteration
+			editor.undo(options.actions);
+			editor.clearActions();
+		}
+		results.push_back(summarize("commit", commit_watch, changes));
+		results.push_back(summarize("undo", undo_watch, changes));
+		results.push_back(summarize("redo", redo_watch, changes));
+	}
+
+	if(enabled("copy") || enabled("paste")) {
+		std::cerr << "Copying and pasting..." << std::endl;
+
+		const int size = std::min(256, std::min(options.map.width, options.map.height) / 2);
+		Selection& selection = editor.getSelection();
+		selection.start();
+		for(int y = bench::BASE_POSITION; y < bench::BASE_POSITION + size; ++y) {
+			for(int x = bench::BASE_POSITION; x < bench::BASE_POSITION + size; ++x) {
+				if(Tile* tile = map.getTile(x, y, rme::MapGroundLayer)) {
+					selection.add(tile);
+				}
+			}
+		}
+		selection.finish();
+		editor.clearActions();
+		const uint64_t selected = selection.size();
+
+		Stopwatch copy_watch;
+		Stopwatch paste_watch;
+		const Position destination(bench::BASE_POSITION + size, bench::BASE_POSITION + size, rme::MapGroundLayer);
+		for(int i = 0; i < options.iterations; ++i) {
+			copy_watch.start();
+			copybuffer.copy(editor, rme::MapGroundLayer);
+			copy_watch.stop();
+
+			paste_watch.start();
+			copybuffer.paste(editor, destination);
+			paste_watch.stop();
+
+			editor.undo(1);
+			editor.clearActions();
+		}
+
+		selection.start();
+		selection.clear();
+		selection.finish();
+		editor.clearActions();
+
+		results.push_back(summarize("copy", copy_watch, selected));
+		results.push_back(summarize("paste", paste_watch, selected));
+	}
+
+	json report;
+	report["editor"] = __RME_VERSION__;
+	report["threads"] = std::thread::hardware_concurrency();
+	report["peak_rss_kb"] = getPeakResidentSize();
+	report["options"] = {
+		{ "seed", options.map.seed },
+		{ "width", options.map.width },
+		{ "height", options.map.height },
+		{ "floors", options.map.floors },
+		{ "density", options.map.density },
+		{ "items", options.map.items },
+		{ "containers", options.map.containers },
+		{ "container_items", options.map.container_items },
+		{ "houses", options.map.houses },
+		{ "spawns", options.map.spawns },
+		{ "zones", options.map.zones },
+		{ "iterations", options.iterations },
+		{ "actions", options.actions },
+	};
+	report["map"] = {
+		{ "tiles", info.tiles },
+		{ "items", info.items },
+		{ "containers", info.containers },
+		{ "house_tiles", info.house_tiles },
+		{ "spawns", info.spawns },
+		{ "creatures", info.creatures },
+		{ "zone_tiles", info.zone_tiles },
+	};
+	report["results"] = results;
+
+	if(options.output.empty()) {
+		std::cout << report.dump(2) << std::endl;
+	} else {
+		std::ofstream file(options.output);
+		file << report.dump(2) << std::endl;
+		if(!file) {
+			std::cerr << "Could not write " << options.output << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
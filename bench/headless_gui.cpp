@@ -0,0 +1,229 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+// rme-bench links the map code without gui.cpp and the windows behind it.
+// This is the part of GUI that the map code calls: progress, status and
+// refresh calls do nothing, dialogs are printed to stderr and questions are
+// answered with no, and no client version is ever loaded.
+
+#include "main.h"
+
+#include "gui.h"
+#include "basemap.h"
+#include "client_version.h"
+
+GUI g_gui;
+
+GUI::GUI() :
+	aui_manager(nullptr),
+	root(nullptr),
+	minimap(nullptr),
+	gem(nullptr),
+	search_result_window(nullptr),
+	duplicated_items_window(nullptr),
+	actions_history_window(nullptr),
+	secondary_map(nullptr),
+	doodad_buffer_map(nullptr),
+
+	house_brush(nullptr),
+	house_exit_brush(nullptr),
+	waypoint_brush(nullptr),
+	optional_brush(nullptr),
+	eraser(nullptr),
+	normal_door_brush(nullptr),
+	locked_door_brush(nullptr),
+	magic_door_brush(nullptr),
+	quest_door_brush(nullptr),
+	hatch_door_brush(nullptr),
+	window_door_brush(nullptr),
+
+	OGLContext(nullptr),
+	loaded_version(CLIENT_VERSION_NONE),
+	mode(SELECTION_MODE),
+	pasting(false),
+	hotkeys_enabled(true),
+
+	current_brush(nullptr),
+	previous_brush(nullptr),
+	brush_shape(BRUSHSHAPE_SQUARE),
+	brush_size(0),
+	brush_variation(0),
+
+	creature_spawntime(0),
+	use_custom_thickness(false),
+	custom_thickness_mod(0.0),
+	progressBar(nullptr),
+	disabled_counter(0)
+{
+	doodad_buffer_map = newd BaseMap();
+}
+
+GUI::~GUI()
+{
+	delete doodad_buffer_map;
+}
+
+wxString GUI::GetExecDirectory()
+{
+	const FileName exec_path = wxStandardPaths::Get().GetExecutablePath();
+	return exec_path.GetPath(wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR);
+}
+
+wxString GUI::GetDataDirectory()
+{
+	FileName exec_path = wxStandardPaths::Get().GetExecutablePath();
+	exec_path.AppendDir("data");
+	return exec_path.GetPath(wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR);
+}
+
+wxString GUI::GetLocalDataDirectory()
+{
+	// Nothing of the user's configuration is read or written
+	return wxFileName::GetTempDir() + wxFileName::GetPathSeparator();
+}
+
+bool GUI::LoadVersion(ClientVersionID version, wxString& error, wxArrayString& warnings, bool force)
+{
+	error = "Client versions are not loaded without the editor window";
+	return false;
+}
+
+ClientVersionID GUI::GetCurrentVersionID() const
+{
+	if(loaded_version != CLIENT_VERSION_NONE) {
+		return getLoadedVersion()->getID();
+	}
+	return CLIENT_VERSION_NONE;
+}
+
+const ClientVersion& GUI::GetCurrentVersion() const
+{
+	assert(loaded_version);
+	return *getLoadedVersion();
+}
+
+bool GUI::CloseAllEditors()
+{
+	return true;
+}
+
+void GUI::CreateLoadBar(wxString message, bool canCancel /* = false */ )
+{
+	////
+}
+
+void GUI::SetLoadScale(int32_t from, int32_t to)
+{
+	////
+}
+
+bool GUI::SetLoadDone(int32_t done, const wxString& newMessage)
+{
+	return true;
+}
+
+void GUI::DestroyLoadBar()
+{
+	////
+}
+
+void GUI::SetStatusText(wxString text)
+{
+	////
+}
+
+void GUI::UpdateTitle()
+{
+	////
+}
+
+void GUI::UpdateMenus()
+{
+	////
+}
+
+void GUI::UpdateActions()
+{
+	////
+}
+
+void GUI::UpdateMinimap(bool immediate)
+{
+	////
+}
+
+void GUI::RefreshView()
+{
+	////
+}
+
+void GUI::FitViewToMap()
+{
+	////
+}
+
+void GUI::RefreshPalettes(Map* m, bool usedefault)
+{
+	////
+}
+
+Brush* GUI::GetCurrentBrush() const
+{
+	return current_brush;
+}
+
+int GUI::GetBrushSize() const
+{
+	return brush_size;
+}
+
+int GUI::GetSpawnTime() const
+{
+	return creature_spawntime;
+}
+
+long GUI::PopupDialog(wxWindow* parent, wxString title, wxString text, long style, wxString configsavename, uint32_t configsavevalue)
+{
+	if(text.empty())
+		return wxID_ANY;
+
+	std::cerr << title << ": " << text << std::endl;
+	return (style & wxYES) ? wxID_NO : wxID_OK;
+}
+
+long GUI::PopupDialog(wxString title, wxString text, long style, wxString configsavename, uint32_t configsavevalue)
+{
+	return PopupDialog(nullptr, title, text, style, configsavename, configsavevalue);
+}
+
+void GUI::ListDialog(wxWindow* parent, wxString title, const wxArrayString& param_items)
+{
+	for(const wxString& item : param_items) {
+		std::cerr << title << ": " << item << std::endl;
+	}
+}
+
+Hotkey::Hotkey() :
+	type(NONE)
+{
+	////
+}
+
+Hotkey::~Hotkey()
+{
+	////
+}
@@ -0,0 +1,332 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "items.h"
+#include "item.h"
+#include "complexitem.h"
+#include "tile.h"
+#include "brush.h"
+#include "creature.h"
+#include "creatures.h"
+#include "spawn.h"
+#include "house.h"
+#include "town.h"
+
+#include "map_generator.h"
+
+#include <random>
+
+namespace {
+	// Item ids of the synthetic item types
+	constexpr uint16_t GRASS_FIRST = 100;
+	constexpr uint16_t DIRT_FIRST = 104;
+	constexpr uint16_t GROUND_VARIANTS = 4;
+	constexpr uint16_t BORDER_FIRST = 110; // 12 edges
+	constexpr uint16_t ITEM_FIRST = 200;
+	constexpr uint16_t ITEM_COUNT = 64;
+	constexpr uint16_t STACKABLE_COUNT = 8; // The first few items
+	constexpr uint16_t CONTAINER_FIRST = 300;
+	constexpr uint16_t CONTAINER_COUNT = 4;
+	constexpr uint16_t LAST_ITEM = CONTAINER_FIRST + CONTAINER_COUNT - 1;
+
+	// Ground is laid out in cells of this size so that there are borders to compute
+	constexpr int GROUND_CELL_SIZE = 16;
+
+	const char* CREATURE_NAMES[] = { "Rat", "Wolf", "Troll", "Orc", "Dragon" };
+
+	const char* MATERIALS_XML = R"(
+		<materials>
+			<border id="1" group="1">
+				<borderitem edge="n"   item="110"/>
+				<borderitem edge="e"   item="111"/>
+				<borderitem edge="s"   item="112"/>
+				<borderitem edge="w"   item="113"/>
+				<borderitem edge="cnw" item="114"/>
+				<borderitem edge="cne" item="115"/>
+				<borderitem edge="csw" item="116"/>
+				<borderitem edge="cse" item="117"/>
+				<borderitem edge="dnw" item="118"/>
+				<borderitem edge="dne" item="119"/>
+				<borderitem edge="dsw" item="120"/>
+				<borderitem edge="dse" item="121"/>
+			</border>
+			<brush name="bench grass" type="ground" server_lookid="100" z-order="3500">
+				<item id="100" chance="2500"/>
+				<item id="101" chance="25"/>
+				<item id="102" chance="25"/>
+				<item id="103" chance="25"/>
+				<border align="outer" id="1"/>
+			</brush>
+			<brush name="bench dirt" type="ground" server_lookid="104" z-order="1000">
+				<item id="104" chance="100"/>
+				<item id="105" chance="10"/>
+				<item id="106" chance="10"/>
+				<item id="107" chance="10"/>
+			</brush>
+		</materials>
+	)";
+
+	ItemType* addItemType(uint16_t id, const std::string& name)
+	{
+		ItemType* type = newd ItemType();
+		type->id = id;
+		type->clientID = id;
+		type->name = name;
+		g_items.getItemMap().set(id, type);
+		return type;
+	}
+
+	class Random
+	{
+	public:
+		explicit Random(uint32_t seed) : engine(seed) {}
+
+		// [low, high]
+		int range(int low, int high) { return std::uniform_int_distribution<int>(low, high)(engine); }
+		bool chance(double probability) { return std::uniform_real_distribution<double>(0.0, 1.0)(engine) < probability; }
+
+	private:
+		std::mt19937 engine;
+	};
+
+	Item* createItem(Random& random, GeneratedMapInfo& info)
+	{
+		const uint16_t id = ITEM_FIRST + random.range(0, ITEM_COUNT - 1);
+		Item* item = Item::Create(id);
+		if(id < ITEM_FIRST + STACKABLE_COUNT) {
+			item->setSubtype(random.range(1, 100));
+		}
+		if(random.chance(0.01)) {
+			item->setActionID(random.range(1000, 9999));
+		}
+		++info.items;
+		return item;
+	}
+
+	Container* createContainer(Random& random, const MapGeneratorOptions& options, GeneratedMapInfo& info, int depth)
+	{
+		Container* container = static_cast<Container*>(Item::Create(CONTAINER_FIRST + random.range(0, CONTAINER_COUNT - 1)));
+		++info.items;
+		++info.containers;
+
+		ItemVector& contents = container->getVector();
+		for(int i = 0; i < options.container_items; ++i) {
+			if(depth < 2 && random.chance(0.25)) {
+				contents.push_back(createContainer(random, options, info, depth + 1));
+			} else {
+				contents.push_back(createItem(random, info));
+			}
+		}
+		return container;
+	}
+
+	bool isDirt(int x, int y, int z, uint32_t seed)
+	{
+		// Decided per cell, with a hash so that it does not depend on the generation order
+		uint32_t hash = seed ^ (uint32_t(x / GROUND_CELL_SIZE) * 0x9E3779B1u) ^ (uint32_t(y / GROUND_CELL_SIZE) * 0x85EBCA77u) ^ (uint32_t(z) * 0xC2B2AE3Du);
+		hash ^= hash >> 15;
+		hash *= 0x2C1B3C6Du;
+		hash ^= hash >> 12;
+		return hash % 10 < 3;
+	}
+}
+
+const MapVersion& bench::getMapVersion()
+{
+	static const MapVersion version(MAP_OTBM_3, CLIENT_VERSION_1021);
+	return version;
+}
+
+void bench::setupItemsAndBrushes()
+{
+	g_items.clear();
+	g_items.MajorVersion = 3;
+	g_items.MinorVersion = CLIENT_VERSION_1021;
+	g_items.BuildNumber = 1;
+
+	for(uint16_t i = 0; i < GROUND_VARIANTS; ++i) {
+		ItemType* grass = addItemType(GRASS_FIRST + i, "grass");
+		grass->group = ITEM_GROUP_GROUND;
+		ItemType* dirt = addItemType(DIRT_FIRST + i, "dirt");
+		dirt->group = ITEM_GROUP_GROUND;
+	}
+	for(uint16_t i = 0; i < 12; ++i) {
+		addItemType(BORDER_FIRST + i, "grass border");
+	}
+	for(uint16_t i = 0; i < ITEM_COUNT; ++i) {
+		ItemType* type = addItemType(ITEM_FIRST + i, "item " + i2s(i));
+		type->moveable = true;
+		type->pickupable = true;
+		type->stackable = i < STACKABLE_COUNT;
+		type->weight = 1.0f;
+	}
+	for(uint16_t i = 0; i < CONTAINER_COUNT; ++i) {
+		ItemType* type = addItemType(CONTAINER_FIRST + i, "container");
+		type->group = ITEM_GROUP_CONTAINER;
+		type->type = ITEM_TYPE_CONTAINER;
+		type->volume = 8;
+		type->moveable = true;
+		type->pickupable = true;
+	}
+	g_items.setMaxID(LAST_ITEM);
+
+	g_brushes.clear();
+	g_brushes.init();
+
+	pugi::xml_document doc;
+	doc.load_string(MATERIALS_XML);
+
+	wxArrayString warnings;
+	pugi::xml_node materials = doc.child("materials");
+	for(pugi::xml_node node = materials.child("border"); node; node = node.next_sibling("border")) {
+		g_brushes.unserializeBorder(node, warnings);
+	}
+	for(pugi::xml_node node = materials.child("brush"); node; node = node.next_sibling("brush")) {
+		g_brushes.unserializeBrush(node, warnings);
+	}
+	for(const wxString& warning : warnings) {
+		std::cerr << "Synthetic brushes: " << warning << std::endl;
+	}
+
+	for(const char* name : CREATURE_NAMES) {
+		if(!g_creatures[name]) {
+			g_creatures.addMissingCreatureType(name, false);
+		}
+	}
+}
+
+GeneratedMapInfo bench::generateMap(Map& map, const MapGeneratorOptions& options)
+{
+	Random random(options.seed);
+	GeneratedMapInfo info;
+
+	const int x_end = BASE_POSITION + options.width;
+	const int y_end = BASE_POSITION + options.height;
+	const int z_begin = std::max<int>(rme::MapGroundLayer - options.floors + 1, rme::MapMinLayer);
+
+	map.setWidth(std::min<int>(x_end + BASE_POSITION, rme::MapMaxWidth));
+	map.setHeight(std::min<int>(y_end + BASE_POSITION, rme::MapMaxHeight));
+	map.setSpawnFilename("bench-spawn.xml");
+	map.setHouseFilename("bench-house.xml");
+	map.setMapDescription("Synthetic map generated by rme-bench");
+
+	for(int z = z_begin; z <= rme::MapGroundLayer; ++z) {
+		for(int y = BASE_POSITION; y < y_end; ++y) {
+			for(int x = BASE_POSITION; x < x_end; ++x) {
+				if(!random.chance(options.density)) {
+					continue;
+				}
+
+				Tile* tile = map.allocator(map.createTileL(x, y, z));
+				const uint16_t ground = (isDirt(x, y, z, options.seed) ? DIRT_FIRST : GRASS_FIRST) + random.range(0, GROUND_VARIANTS - 1);
+				tile->addItem(Item::Create(ground));
+				++info.items;
+
+				int count = static_cast<int>(options.items);
+				if(random.chance(options.items - count)) {
+					++count;
+				}
+				for(int i = 0; i < count; ++i) {
+					tile->addItem(createItem(random, info));
+				}
+				if(random.chance(options.containers)) {
+					tile->addItem(createContainer(random, options, info, 0));
+				}
+
+				tile->update();
+				map.setTile(x, y, z, tile);
+				++info.tiles;
+			}
+		}
+	}
+
+	Town* town = newd Town(1);
+	town->setName("Bench Town");
+	town->setTemplePosition(Position(BASE_POSITION + options.width / 2, BASE_POSITION + options.height / 2, rme::MapGroundLayer));
+	map.towns.addTown(town);
+
+	// Houses are rectangles on the ground floor, they may touch but never share tiles
+	for(int id = 1; id <= options.houses; ++id) {
+		const int house_width = random.range(4, 10);
+		const int house_height = random.range(4, 10);
+		const int start_x = BASE_POSITION + random.range(0, std::max(options.width - house_width, 0));
+		const int start_y = BASE_POSITION + random.range(0, std::max(options.height - house_height, 0));
+
+		House* house = newd House(map);
+		house->id = id;
+		house->name = "House " + i2s(id);
+		house->townid = town->getID();
+		map.houses.addHouse(house);
+
+		for(int y = start_y; y < start_y + house_height; ++y) {
+			for(int x = start_x; x < start_x + house_width; ++x) {
+				Tile* tile = map.getTile(x, y, rme::MapGroundLayer);
+				if(tile && !tile->isHouseTile()) {
+					house->addTile(tile);
+					++info.house_tiles;
+				}
+			}
+		}
+	}
+
+	for(int i = 0; i < options.spawns; ++i) {
+		const int x = BASE_POSITION + random.range(0, options.width - 1);
+		const int y = BASE_POSITION + random.range(0, options.height - 1);
+		Tile* tile = map.getTile(x, y, rme::MapGroundLayer);
+		if(!tile || tile->spawn || tile->isHouseTile()) {
+			continue;
+		}
+
+		const int radius = random.range(2, 5);
+		tile->spawn = newd Spawn(radius);
+		map.addSpawn(tile);
+		++info.spawns;
+
+		const char* name = CREATURE_NAMES[random.range(0, static_cast<int>(std::size(CREATURE_NAMES)) - 1)];
+		const int creatures = random.range(1, 4);
+		for(int c = 0; c < creatures; ++c) {
+			Tile* creature_tile = map.getTile(x + random.range(-radius, radius), y + random.range(-radius, radius), rme::MapGroundLayer);
+			if(creature_tile && !creature_tile->creature && !creature_tile->isHouseTile()) {
+				creature_tile->creature = newd Creature(name);
+				creature_tile->creature->setSpawnTime(60);
+				++info.creatures;
+			}
+		}
+	}
+
+	for(int id = 1; id <= options.zones; ++id) {
+		const int zone_width = random.range(8, 64);
+		const int zone_height = random.range(8, 64);
+		const int start_x = BASE_POSITION + random.range(0, std::max(options.width - zone_width, 0));
+		const int start_y = BASE_POSITION + random.range(0, std::max(options.height - zone_height, 0));
+		for(int y = start_y; y < start_y + zone_height; ++y) {
+			for(int x = start_x; x < start_x + zone_width; ++x) {
+				Tile* tile = map.getTile(x, y, rme::MapGroundLayer);
+				if(tile) {
+					tile->addZoneId(id);
+					map.zones.add(id, tile->getPosition());
+					++info.zone_tiles;
+				}
+			}
+		}
+	}
+
+	map.doChange();
+	return info;
+}
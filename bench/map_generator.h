@@ -0,0 +1,69 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_BENCH_MAP_GENERATOR_H_
+#define RME_BENCH_MAP_GENERATOR_H_
+
+#include "map.h"
+
+// Synthetic maps for rme-bench. Everything is derived from the seed, the
+// same options always produce the same map.
+
+struct MapGeneratorOptions
+{
+	uint32_t seed = 1;
+	// The map starts at BASE_POSITION, floors go down from the ground floor
+	int width = 512;
+	int height = 512;
+	int floors = 1;
+	// Chance that a position holds a tile at all
+	double density = 0.9;
+	// Average number of items on top of the ground
+	double items = 1.5;
+	// Chance that a tile holds a container, and how much goes into one
+	double containers = 0.02;
+	int container_items = 4;
+	int houses = 64;
+	int spawns = 128;
+	int zones = 16;
+};
+
+struct GeneratedMapInfo
+{
+	uint64_t tiles = 0;
+	uint64_t items = 0; // Grounds and contained items included
+	uint64_t containers = 0;
+	uint64_t house_tiles = 0;
+	uint64_t spawns = 0;
+	uint64_t creatures = 0;
+	uint64_t zone_tiles = 0;
+};
+
+namespace bench {
+	constexpr int BASE_POSITION = 1024;
+
+	const MapVersion& getMapVersion();
+
+	// Registers the item types, borders and ground brushes the generated maps
+	// are made of, instead of loading a client version. Call it once, up front.
+	void setupItemsAndBrushes();
+
+	// Fills an empty map
+	GeneratedMapInfo generateMap(Map& map, const MapGeneratorOptions& options);
+}
+
+#endif
@@ -65,3 +65,183 @@ workspace "Black-Tek-Mapeditor"
       filter {}
 
       intrinsics "On"
+
+   -- The map, io and brush code that rme-bench links. No window is created:
+   -- gui.cpp is replaced by bench/headless_gui.cpp and the live editing code
+   -- (editor_live.cpp, live_*.cpp) is left out.
+   local core_sources = {
+      "source/action.cpp",
+      "source/basemap.cpp",
+      "source/brush.cpp",
+      "source/brush_tables.cpp",
+      "source/carpet_brush.cpp",
+      "source/client_version.cpp",
+      "source/common.cpp",
+      "source/complexitem.cpp",
+      "source/copybuffer.cpp",
+      "source/creature.cpp",
+      "source/creature_brush.cpp",
+      "source/creatures.cpp",
+      "source/doodad_brush.cpp",
+      "source/editor.cpp",
+      "source/eraser_brush.cpp",
+      "source/extension.cpp",
+      "source/filehandle.cpp",
+      "source/graphics.cpp",
+      "source/ground_brush.cpp",
+      "source/house.cpp",
+      "source/house_brush.cpp",
+      "source/house_exit_brush.cpp",
+      "source/iomap.cpp",
+      "source/iomap_otbm.cpp",
+      "source/item.cpp",
+      "source/item_attribute_index.cpp",
+      "source/item_attributes.cpp",
+      "source/item_id_index.cpp",
+      "source/items.cpp",
+      "source/map.cpp",
+      "source/map_allocator.cpp",
+      "source/map_occupancy.cpp",
+      "source/map_reachability.cpp",
+      "source/map_region.cpp",
+      "source/map_statistics.cpp",
+      "source/materials.cpp",
+      "source/mt_rand.cpp",
+      "source/net_connection.cpp",
+      "source/otbm_area_index.cpp",
+      "source/otgz.cpp",
+      "source/pngfiles.cpp",
+      "source/raw_brush.cpp",
+      "source/selection.cpp",
+      "source/settings.cpp",
+      "source/spawn.cpp",
+      "source/spawn_brush.cpp",
+      "source/sprite_batch.cpp",
+      "source/table_brush.cpp",
+      "source/templatemap76-74.cpp",
+      "source/templatemap81.cpp",
+      "source/templatemap854.cpp",
+      "source/templatemapclassic.cpp",
+      "source/texture_atlas.cpp",
+      "source/tile.cpp",
+      "source/tileset.cpp",
+      "source/town.cpp",
+      "source/unique_id_registry.cpp",
+      "source/wall_brush.cpp",
+      "source/waypoint_brush.cpp",
+      "source/waypoints.cpp",
+      "source/worker_pool.cpp",
+      "source/zones.cpp",
+      "source/ext/pugixml.cpp"
+   }
+
+   -- Times the map code (load, save, iteration, borderize, undo/redo, copy/paste) on
+   -- synthetic maps without opening a window, see bench/bench.cpp
+   project "rme-bench"
+      kind "ConsoleApp"
+      language "C++"
+      cppdialect "C++20"
+      targetdir "%{wks.location}"
+      objdir "build/%{cfg.buildcfg}/bench"
+      location ""
+      files(core_sources)
+      files { "source/**.h", "bench/**.cpp", "bench/**.h" }
+      includedirs { "source" }
+      flags { "MultiProcessorCompile" }
+      vectorextensions "AVX"
+
+      filter "system:linux"
+         includedirs { "/usr/include/wx-3.2" }
+         buildoptions { "`wx-config --cxxflags`" }
+         linkoptions { "`wx-config --libs base,core`", "-lz", "-lfmt", "-lGL" }
+      filter {}
+
+      filter "configurations:Debug"
+         defines { "DEBUG" }
+         symbols "On"
+         optimize "Debug"
+      filter {}
+
+      filter "configurations:Release"
+         defines { "NDEBUG" }
+         symbols "On"
+         optimize "Speed"
+      filter {}
+
+      filter "platforms:64"
+         architecture "amd64"
+      filter {}
+
+      filter "system:not windows"
+         buildoptions { "-Wall", "-Wextra", "-pedantic", "-pipe", "-Wno-unused-local-typedefs" }
+      filter {}
+
+      filter "system:windows"
+         openmp "On"
+         characterset "MBCS"
+         debugformat "c7"
+         vsprops { VcpkgEnableManifest = "true" }
+         buildoptions { "/bigobj", "/utf-8" }
+         linkoptions { "/IGNORE:4099" }
+      filter {}
+
+      filter "toolset:gcc"
+         buildoptions { "-fno-strict-aliasing" }
+      filter {}
+
+      intrinsics "On"
+
+   -- The tests of the map code, run from the root of the repository so that
+   -- the files in tests/data are found, see tests/main.cpp
+   project "rme-tests"
+      kind "ConsoleApp"
+      language "C++"
+      cppdialect "C++20"
+      targetdir "%{wks.location}"
+      objdir "build/%{cfg.buildcfg}/tests"
+      location ""
+      files(core_sources)
+      files { "source/**.h", "bench/headless_gui.cpp", "bench/map_generator.cpp", "bench/map_generator.h", "tests/**.cpp", "tests/**.h" }
+      includedirs { "source", "bench" }
+      flags { "MultiProcessorCompile" }
+
+      filter "system:linux"
+         includedirs { "/usr/include/wx-3.2" }
+         buildoptions { "`wx-config --cxxflags`" }
+         linkoptions { "`wx-config --libs base,core`", "-lz", "-lfmt", "-lGL" }
+      filter {}
+
+      filter "configurations:Debug"
+         defines { "DEBUG" }
+         symbols "On"
+         optimize "Debug"
+      filter {}
+
+      filter "configurations:Release"
+         defines { "NDEBUG" }
+         symbols "On"
+         optimize "Speed"
+      filter {}
+
+      filter "platforms:64"
+         architecture "amd64"
+      filter {}
+
+      filter "system:not windows"
+         buildoptions { "-Wall", "-Wextra", "-pedantic", "-pipe", "-Wno-unused-local-typedefs" }
+      filter {}
+
+      filter "system:windows"
+         openmp "On"
+         characterset "MBCS"
+         debugformat "c7"
+         vsprops { VcpkgEnableManifest = "true" }
+         buildoptions { "/bigobj", "/utf-8" }
+         linkoptions { "/IGNORE:4099" }
+      filter {}
+
+      filter "toolset:gcc"
+         buildoptions { "-fno-strict-aliasing" }
+      filter {}
+
+      intrinsics "On"
@@ -152,6 +152,8 @@ void Action::commit(DirtyList* dirty_list)
 					}
 				}
 
+				// Before the swap, the map reads the flags of the tiles it gets
+				new_tile->update();
 				Tile* old_tile = map.swapTile(pos, new_tile);
 				TileLocation* location = new_tile->getLocation();
 
@@ -159,8 +161,6 @@ void Action::commit(DirtyList* dirty_list)
 				if(editor.IsLiveServer() && dirty_list)
 					dirty_list->AddPosition(pos.x, pos.y, pos.z);
 
-				new_tile->update();
-
 				//std::cout << "\tSwitched tile at " << pos.x << ";" << pos.y << ";" << pos.z << " from " << (void*)oldtile << " to " << *data <<  std::endl;
 				if(new_tile->isSelected())
 					selection.addInternal(new_tile);
@@ -236,16 +236,8 @@ void Action::commit(DirtyList* dirty_list)
 
 				Waypoint* waypoint = map.waypoints.getWaypoint(data->id);
 				if(waypoint) {
-					TileLocation* old_tile = map.getTileL(waypoint->pos);
-					TileLocation* new_tile = map.getTileL(data->position);
-
-					if(data->position.isValid() && old_tile && old_tile->getWaypointCount() > 0)
-						old_tile->decreaseWaypointCount();
-
-					new_tile->increaseWaypointCount();
-
 					Position old_pos = waypoint->pos;
-					waypoint->pos = data->position;
+					map.waypoints.moveWaypoint(waypoint, data->position);
 					data->position = old_pos;
 				}
 				break;
@@ -352,16 +344,8 @@ void Action::undo(DirtyList* dirty_list)
 
 				Waypoint* waypoint = map.waypoints.getWaypoint(data->id);
 				if(waypoint) {
-					TileLocation* old_tile = map.getTileL(waypoint->pos);
-					TileLocation* new_tile = map.getTileL(data->position);
-
-					if(data->position.isValid() && old_tile && old_tile->getWaypointCount() > 0)
-						old_tile->decreaseWaypointCount();
-
-					new_tile->increaseWaypointCount();
-
 					Position old_pos = waypoint->pos;
-					waypoint->pos = data->position;
+					map.waypoints.moveWaypoint(waypoint, data->position);
 					data->position = old_pos;
 				}
 				break;
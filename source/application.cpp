@@ -434,6 +434,7 @@ void MainFrame::OnUpdateReceived(wxCommandEvent& event)
 void MainFrame::OnUpdateMenus(wxCommandEvent&)
 {
 	UpdateMenubar();
+	UpdateStatistics();
 	g_gui.UpdateMinimap(true);
 	g_gui.UpdateTitle();
 }
@@ -441,6 +442,7 @@ void MainFrame::OnUpdateMenus(wxCommandEvent&)
 void MainFrame::OnUpdateActions(wxCommandEvent&)
 {
 	tool_bar->UpdateButtons();
+	UpdateStatistics();
 	g_gui.RefreshActions();
 }
 
@@ -464,6 +466,16 @@ void MainFrame::UpdateMenubar()
 	tool_bar->UpdateButtons();
 }
 
+void MainFrame::UpdateStatistics()
+{
+	wxString text;
+	if(g_gui.IsEditorOpen()) {
+		const MapStatistics& statistics = g_gui.GetCurrentMap().getStatistics();
+		text << "Tiles: " << statistics.tile_count << " Items: " << statistics.item_count;
+	}
+	SetStatusText(text, 2);
+}
+
 bool MainFrame::DoQueryClose() {
 	Editor* editor = g_gui.GetCurrentEditor();
 	if(editor) {
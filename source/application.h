@@ -70,6 +70,8 @@ public:
 	~MainFrame();
 
 	void UpdateMenubar();
+	// Tile and item counts of the current map, in the status bar
+	void UpdateStatistics();
 	bool DoQueryClose();
 	bool DoQuerySave(bool doclose = true);
 	bool DoQueryImportCreatures();
@@ -43,6 +43,9 @@ void BaseMap::clear(bool del)
 	for(PositionVector::iterator pos_iter = pos_vec.begin(); pos_iter != pos_vec.end(); ++pos_iter) {
 		setTile(*pos_iter, nullptr, del);
 	}
+	occupancy.clear();
+	// Slabs emptied above are cached for reuse, hand them back now
+	MapAllocator::trim();
 }
 
 void BaseMap::clearVisible(uint32_t mask)
@@ -59,6 +62,7 @@ Tile* BaseMap::createTile(int x, int y, int z)
 		return loc->get();
 	Tile* t = allocator(loc);
 	leaf->setTile(x, y, z, t);
+	occupancy.update(x, y, z, t);
 	return t;
 }
 
@@ -116,9 +120,7 @@ void BaseMap::setTile(int x, int y, int z, Tile* new_tile, bool remove)
 
 	QTreeNode* leaf = root.getLeafForce(x, y);
 	Tile* old_tile = leaf->setTile(x, y, z, new_tile);
-
-	if ((remove && old_tile) || new_tile)
-		updateUniqueIds(remove ? old_tile : nullptr, new_tile);
+	markTileReplaced(x, y, z, old_tile, new_tile);
 
 	if (remove) {
 		delete old_tile;
@@ -147,9 +149,7 @@ Tile* BaseMap::swapTile(int x, int y, int z, Tile* new_tile)
 
 	QTreeNode* leaf = root.getLeafForce(x, y);
 	Tile* old_tile = leaf->setTile(x, y, z, new_tile);
-
-	if (old_tile || new_tile)
-		updateUniqueIds(old_tile, new_tile);
+	markTileReplaced(x, y, z, old_tile, new_tile);
 
 	return old_tile;
 }
@@ -159,6 +159,33 @@ Tile* BaseMap::swapTile(const Position& position, Tile* new_tile)
 	return swapTile(position.x, position.y, position.z, new_tile);
 }
 
+void BaseMap::markTileChanged(int x, int y, int z)
+{
+	occupancy.update(x, y, z, getTile(x, y, z));
+	markLeafChanged(x, y);
+}
+
+void BaseMap::markTileReplaced(int x, int y, int z, Tile* old_tile, Tile* new_tile)
+{
+	occupancy.update(x, y, z, new_tile);
+}
+
+void BaseMap::updateOccupancy(const Tile* tile)
+{
+	ASSERT(tile);
+	const Position& position = tile->getPosition();
+	if(getTile(position) == tile) {
+		occupancy.update(position.x, position.y, position.z, tile);
+		markLeafChanged(position.x, position.y);
+	}
+}
+
+void BaseMap::markLeafChanged(int x, int y)
+{
+	if(QTreeNode* leaf = root.getLeaf(x, y))
+		leaf->markChanged();
+}
+
 // Iterators
 
 MapIterator::MapIterator(BaseMap* _map) :
@@ -186,6 +213,28 @@ MapIterator::MapIterator(const MapIterator& other)
 	current_tile = other.current_tile;
 }
 
+void BaseMap::getLeaves(std::vector<QTreeNode*>& leaves)
+{
+	// Same depth first order as MapIterator
+	std::vector<MapIterator::NodeIndex> nodestack;
+	nodestack.push_back(MapIterator::NodeIndex(&root));
+	while(!nodestack.empty()) {
+		MapIterator::NodeIndex& current = nodestack.back();
+		if(current.index >= 16) {
+			nodestack.pop_back();
+			continue;
+		}
+
+		QTreeNode* child = current.node->child[current.index++];
+		if(!child)
+			continue;
+		if(child->isLeaf)
+			leaves.push_back(child);
+		else
+			nodestack.push_back(MapIterator::NodeIndex(child));
+	}
+}
+
 MapIterator BaseMap::begin()
 {
 	MapIterator it(this);
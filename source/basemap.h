@@ -22,6 +22,7 @@
 #include "position.h"
 #include "filehandle.h"
 #include "map_allocator.h"
+#include "map_occupancy.h"
 #include "tile.h"
 
 // Class declarations
@@ -101,6 +102,9 @@ public:
 	// Get a Quad Tree Leaf from the map
 	QTreeNode* getLeaf(int x, int y) { return root.getLeaf(x, y); }
 	QTreeNode* createLeaf(int x, int y) { return root.getLeafForce(x, y); }
+	// Appends every leaf in the order MapIterator visits them, the leaves
+	// share no tiles so they can be handed to different threads
+	void getLeaves(std::vector<QTreeNode*>& leaves);
 
 	// Assigns a tile, it might seem pointless to provide position, but it is not, as the passed tile may be nullptr
 	void setTile(int x, int y, int z, Tile* new_tile, bool remove = false);
@@ -109,6 +113,16 @@ public:
 	// Replaces a tile and returns the old one
 	Tile* swapTile(int x, int y, int z, Tile* new_tile);
 	Tile* swapTile(const Position& position, Tile* new_tile);
+	// Code that changes a tile in place (without replacing it) has to call
+	// this, setTile and swapTile report their tiles with markTileReplaced
+	virtual void markTileChanged(int x, int y, int z);
+
+	// Which positions hold tiles, blocking tiles and selected tiles
+	const OccupancyMap& getOccupancy() const noexcept { return occupancy; }
+	// For tiles that were only selected, deselected or updated in place
+	void updateOccupancy(const Tile* tile);
+	// Gives the leaf holding the position a new revision
+	void markLeafChanged(int x, int y);
 
 	// Clears the visiblity according to the mask passed
 	void clearVisible(uint32_t mask);
@@ -118,11 +132,16 @@ public:
 	MapAllocator allocator;
 
 protected:
-	virtual void updateUniqueIds(Tile* old_tile, Tile* new_tile) { }
+	// Called by setTile and swapTile with the tile that left the map and the
+	// one that took its place, either may be nullptr
+	virtual void markTileReplaced(int x, int y, int z, Tile* old_tile, Tile* new_tile);
 
 	uint64_t tilecount;
+	// Of the last leaf revision handed out, has to come before root
+	uint64_t last_revision = 0;
 
 	QTreeNode root; // The Quad Tree root
+	OccupancyMap occupancy;
 
 	friend class QTreeNode;
 };
@@ -22,9 +22,18 @@
 #include "settings.h"
 #include "tile.h"
 #include "creature.h"
-#include "basemap.h"
+#include "map.h"
 #include "spawn.h"
 
+namespace {
+	// Only a Map knows its spawns
+	bool isInSpawn(BaseMap* map, const Position& position)
+	{
+		Map* real_map = dynamic_cast<Map*>(map);
+		return real_map && real_map->spawns.getSpawnCount(position) != 0;
+	}
+}
+
 //=============================================================================
 // Creature brush
 
@@ -57,7 +66,7 @@ bool CreatureBrush::canDraw(BaseMap* map, const Position& position) const
 {
 	Tile* tile = map->getTile(position);
 	if(creature_type && tile && !tile->isBlocking()) {
-		if(tile->getLocation()->getSpawnCount() != 0 || g_settings.getInteger(Config::AUTO_CREATE_SPAWN)) {
+		if(isInSpawn(map, position) || g_settings.getInteger(Config::AUTO_CREATE_SPAWN)) {
  		   if(tile->isPZ()) {
 				if(creature_type->isNpc) {
 					return true;
@@ -88,7 +97,7 @@ void CreatureBrush::draw_creature(BaseMap* map, Tile* tile)
 	if(canDraw(map, tile->getPosition())) {
 		undraw(map, tile);
 		if(creature_type) {
-			if(tile->spawn == nullptr && tile->getLocation()->getSpawnCount() == 0) {
+			if(tile->spawn == nullptr && !isInSpawn(map, tile->getPosition())) {
 				// manually place spawn on location
 				tile->spawn = newd Spawn(1);
 			}
@@ -50,7 +50,7 @@
 #endif
 // OS
 
-#define OTGZ_SUPPORT 0
+#define OTGZ_SUPPORT 1
 #define ASSETS_NAME "Tibia"
 
 #ifdef __VISUALC__
@@ -37,7 +37,6 @@
 
 #include "live_server.h"
 #include "live_client.h"
-#include "live_action.h"
 
 Editor::Editor(CopyBuffer& copybuffer) :
 	live_server(nullptr),
@@ -84,6 +83,7 @@ Editor::Editor(CopyBuffer& copybuffer) :
 	map.housefile = sname + "-house.xml";
 	map.description = "No map description available.";
 	map.unnamed = true;
+	map.setItemIndexEnabled(g_settings.getInteger(Config::ITEM_INDEX) == 1);
 
 	map.doChange();
 }
@@ -129,6 +129,7 @@ Editor::Editor(CopyBuffer& copybuffer, const FileName& fn) :
 
 	if(success) {
 		ScopedLoadingBar LoadingBar("Loading OTBM map...");
+		map.setItemIndexEnabled(g_settings.getInteger(Config::ITEM_INDEX) == 1);
 		success = map.open(nstr(fn.GetFullPath()));
 		/* TODO
 		if(success && ver.client == CLIENT_VERSION_854_BAD) {
@@ -143,15 +144,18 @@ Editor::Editor(CopyBuffer& copybuffer, const FileName& fn) :
 	}
 }
 
-Editor::Editor(CopyBuffer& copybuffer, LiveClient* client) :
+Editor::Editor(CopyBuffer& copybuffer, const MapVersion& version) :
 	live_server(nullptr),
-	live_client(client),
-	actionQueue(newd NetworkedActionQueue(*this)),
+	live_client(nullptr),
+	actionQueue(newd ActionQueue(*this)),
 	selection(*this),
 	copybuffer(copybuffer),
 	replace_brush(nullptr)
 {
-	;
+	map.convert(version);
+	map.height = 2048;
+	map.width = 2048;
+	map.setItemIndexEnabled(g_settings.getInteger(Config::ITEM_INDEX) == 1);
 }
 
 Editor::~Editor()
@@ -349,6 +353,10 @@ void Editor::saveMap(FileName filename, bool showdialog)
 
 		// Perform the actual save
 		IOMapOTBM mapsaver(map.getVersion());
+		// The previous file has just been moved to the temporary backup
+		if(!save_otgz && !backup_otbm.empty() && g_settings.getInteger(Config::INCREMENTAL_SAVE)) {
+			mapsaver.setIncrementalSource(backup_otbm);
+		}
 		bool success = mapsaver.saveMap(map, fn);
 
 		if(showdialog)
@@ -658,11 +666,16 @@ bool Editor::importMap(FileName filename, int import_x_offset, int import_y_offs
 	}
 
 	// Plain merge of waypoints, very simple! :)
+	// Waypoints with names the map already has are not imported
 	for(WaypointMap::iterator iter = imported_map.waypoints.begin(); iter != imported_map.waypoints.end(); ++iter) {
-		iter->second->pos += offset;
+		Waypoint* waypoint = iter->second;
+		if(map.waypoints.getWaypoint(waypoint->name)) {
+			delete waypoint;
+			continue;
+		}
+		waypoint->pos += offset;
+		map.waypoints.addWaypoint(waypoint);
 	}
-
-	map.waypoints.waypoints.insert(imported_map.waypoints.begin(), imported_map.waypoints.end());
 	imported_map.waypoints.waypoints.clear();
 
 
@@ -748,10 +761,11 @@ bool Editor::importMap(FileName filename, int import_x_offset, int import_y_offs
 			tile = map.allocator(location);
 			map.setTile(pos, tile);
 		} else if(tile->spawn) {
-			map.removeSpawnInternal(tile);
+			map.removeSpawn(tile);
 			delete tile->spawn;
 		}
 		tile->spawn = spawn_iter->second;
+		map.markTileChanged(pos.x, pos.y, pos.z);
 
 		map.addSpawn(tile);
 	}
@@ -802,6 +816,8 @@ void Editor::borderizeMap(bool showdialog)
 		ASSERT(tile);
 
 		tile->borderize(&map);
+		tile->update();
+		map.markTileChanged(tile->getX(), tile->getY(), tile->getZ());
 		++tiles_done;
 	}
 
@@ -874,6 +890,7 @@ void Editor::randomizeMap(bool showdialog)
 				newGround->setUniqueID(uniqueId);
 			}
 			tile->update();
+			map.markTileChanged(tile->getX(), tile->getY(), tile->getZ());
 		}
 		++tiles_done;
 	}
@@ -927,6 +944,7 @@ void Editor::clearInvalidHouseTiles(bool showdialog)
 		if(tile->isHouseTile()) {
 			if(houses.getHouse(tile->getHouseID()) == nullptr) {
 				tile->setHouse(nullptr);
+				map.markTileHouseChanged(tile->getX(), tile->getY(), tile->getZ());
 			}
 		}
 		++tiles_done;
@@ -960,6 +978,55 @@ void Editor::clearModifiedTileState(bool showdialog)
 	}
 }
 
+namespace {
+	struct ItemIdFinder
+	{
+		ItemIdFinder(uint16_t id, size_t limit) :
+			id(id), limit(limit) {}
+
+		uint16_t id;
+		size_t limit;
+		std::vector<std::pair<Tile*, Item*>> result;
+
+		void operator()(Map& map, Tile* tile, Item* item)
+		{
+			if(item->getID() == id && (limit == 0 || result.size() < limit))
+				result.push_back(std::make_pair(tile, item));
+		}
+
+		void merge(const ItemIdFinder& other)
+		{
+			for(const auto& found : other.result) {
+				if(limit != 0 && result.size() >= limit)
+					break;
+				result.push_back(found);
+			}
+		}
+	};
+}
+
+void Editor::findItems(uint16_t id, bool selectedOnly, size_t limit, std::vector<std::pair<Tile*, Item*>>& result)
+{
+	if(!map.hasItemIndex()) {
+		ItemIdFinder finder(id, limit);
+		parallel_foreach_ItemOnMap(map, finder, selectedOnly, [](uint64_t done, uint64_t total) {
+			if(total != 0)
+				g_gui.SetLoadDone((uint32_t)(100 * done / total));
+		});
+		result.insert(result.end(), finder.result.begin(), finder.result.end());
+		return;
+	}
+
+	if(g_settings.getInteger(Config::ITEM_INDEX_SELF_CHECK)) {
+		const Map::ItemIndexCheck check = map.checkItemIndex();
+		if(check.missing != 0) {
+			wxLogWarning("The item index was missing %llu entries (and had %llu stale ones), it has been corrected.",
+				(unsigned long long)check.missing, (unsigned long long)check.stale);
+		}
+	}
+	map.findItems(id, selectedOnly, limit, result);
+}
+
 void Editor::moveSelection(const Position& offset)
 {
 	if(!CanEdit() || !hasSelection()) {
@@ -1206,7 +1273,7 @@ void Editor::destroySelection()
 				} else {
 					Tile* new_tile = map.allocator(location);
 					new_tile->borderize(&map);
-					if(new_tile->size()) {
+					if(map.getTileSize(new_tile)) {
 						action->addChange(newd Change(new_tile));
 					} else {
 						delete new_tile;
@@ -1476,7 +1543,7 @@ void Editor::drawInternal(const PositionVector& tilestodraw, bool alt, bool dodr
 				Tile* new_tile = map.allocator(location);
 				brush->draw(&map, new_tile);
 				new_tile->borderize(&map);
-				if(new_tile->size() == 0) {
+				if(map.getTileSize(new_tile) == 0) {
 					delete new_tile;
 					continue;
 				}
@@ -1595,7 +1662,7 @@ void Editor::drawInternal(const PositionVector& tilestodraw, PositionVector& til
 						//new_tile->carpetize(map);
 					}
 					new_tile->borderize(&map);
-					if(new_tile->size() > 0) {
+					if(map.getTileSize(new_tile) > 0) {
 						action->addChange(newd Change(new_tile));
 					} else {
 						delete new_tile;
@@ -1832,26 +1899,6 @@ LiveSocket& Editor::GetLive() const
 	return *live_client;
 }
 
-LiveServer* Editor::StartLiveServer()
-{
-	ASSERT(IsLocal());
-	live_server = newd LiveServer(*this);
-
-	delete actionQueue;
-	actionQueue = newd NetworkedActionQueue(*this);
-
-	return live_server;
-}
-
-void Editor::BroadcastNodes(DirtyList& dirtyList)
-{
-	if(IsLiveClient()) {
-		live_client->sendChanges(dirtyList);
-	} else {
-		live_server->broadcastNodes(dirtyList);
-	}
-}
-
 void Editor::CloseLiveServer()
 {
 	ASSERT(IsLive());
@@ -1876,16 +1923,3 @@ void Editor::CloseLiveServer()
 	connection.stop();
 }
 
-void Editor::QueryNode(int ndx, int ndy, bool underground)
-{
-	ASSERT(live_client);
-	live_client->queryNode(ndx, ndy, underground);
-}
-
-void Editor::SendNodeRequests()
-{
-	if(live_client) {
-		live_client->sendNodeRequests();
-	}
-}
-
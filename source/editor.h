@@ -38,6 +38,9 @@ public:
 	Editor(CopyBuffer& copybuffer, LiveClient* client);
 	Editor(CopyBuffer& copybuffer, const FileName& fn);
 	Editor(CopyBuffer& copybuffer);
+	// An empty map of the given version, no client version is loaded for it
+	// (the item types and brushes have to be set up already). Used by rme-bench.
+	Editor(CopyBuffer& copybuffer, const MapVersion& version);
 	~Editor();
 
 protected:
@@ -121,6 +124,11 @@ public: // Functions
 	void clearInvalidHouseTiles(bool showdialog);
 	void clearModifiedTileState(bool showdialog);
 
+	// Items with the id (contents of containers included) in map order, at most
+	// 'limit' of them (0 for all). Answered from the item index of the map if it
+	// has one, otherwise the map is scanned and an open load bar is updated.
+	void findItems(uint16_t id, bool selectedOnly, size_t limit, std::vector<std::pair<Tile*, Item*>>& result);
+
 	// Draw using the current brush to the target position
 	// alt is whether the ALT key is pressed
 	void draw(const Position& offset, bool alt);
@@ -0,0 +1,73 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+// The parts of Editor that start or drive a live session. They are kept out
+// of editor.cpp so that the map code links without the live editing code
+// (rme-bench), closing a session goes through LiveSocket::close.
+
+#include "main.h"
+
+#include "editor.h"
+#include "settings.h"
+
+#include "live_server.h"
+#include "live_client.h"
+#include "live_action.h"
+
+Editor::Editor(CopyBuffer& copybuffer, LiveClient* client) :
+	live_server(nullptr),
+	live_client(client),
+	actionQueue(newd NetworkedActionQueue(*this)),
+	selection(*this),
+	copybuffer(copybuffer),
+	replace_brush(nullptr)
+{
+	map.setItemIndexEnabled(g_settings.getInteger(Config::ITEM_INDEX) == 1);
+}
+
+LiveServer* Editor::StartLiveServer()
+{
+	ASSERT(IsLocal());
+	live_server = newd LiveServer(*this);
+
+	delete actionQueue;
+	actionQueue = newd NetworkedActionQueue(*this);
+
+	return live_server;
+}
+
+void Editor::BroadcastNodes(DirtyList& dirtyList)
+{
+	if(IsLiveClient()) {
+		live_client->sendChanges(dirtyList);
+	} else {
+		live_server->broadcastNodes(dirtyList);
+	}
+}
+
+void Editor::QueryNode(int ndx, int ndy, bool underground)
+{
+	ASSERT(live_client);
+	live_client->queryNode(ndx, ndy, underground);
+}
+
+void Editor::SendNodeRequests()
+{
+	if(live_client) {
+		live_client->sendNodeRequests();
+	}
+}
@@ -22,6 +22,15 @@
 #include <stdio.h>
 #include <assert.h>
 
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
 uint8_t NodeFileWriteHandle::NODE_START = ::NODE_START;
 uint8_t NodeFileWriteHandle::NODE_END = ::NODE_END;
 uint8_t NodeFileWriteHandle::ESCAPE_CHAR = ::ESCAPE_CHAR;
@@ -147,6 +156,7 @@ bool FileReadHandle::getLongString(std::string& str)
 
 NodeFileReadHandle::NodeFileReadHandle() :
 	last_was_start(false),
+	contiguous(false),
 	cache(nullptr),
 	cache_size(32768),
 	cache_length(0),
@@ -189,6 +199,7 @@ void NodeFileReadHandle::freeNode(BinaryNode* node)
 
 MemoryNodeFileReadHandle::MemoryNodeFileReadHandle(const uint8_t* data, size_t size)
 {
+	contiguous = true;
 	assign(data, size);
 }
 
@@ -228,6 +239,148 @@ BinaryNode* MemoryNodeFileReadHandle::getRootNode()
 	return root_node;
 }
 
+//=============================================================================
+// Memory mapped node file read handle
+
+MappedNodeFileReadHandle::MappedNodeFileReadHandle(const std::string& name, const std::vector<std::string>& acceptable_identifiers) :
+	mapping(nullptr),
+	mapping_size(0)
+#ifdef _WIN32
+	, file_handle(INVALID_HANDLE_VALUE),
+	mapping_handle(nullptr)
+#endif
+{
+	contiguous = true;
+
+#ifdef _WIN32
+	HANDLE fh = CreateFileW(string2wstring(name).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(fh == INVALID_HANDLE_VALUE) {
+		error_code = FILE_COULD_NOT_OPEN;
+		return;
+	}
+	file_handle = fh;
+
+	LARGE_INTEGER li;
+	if(!GetFileSizeEx(fh, &li) || li.QuadPart < 4) {
+		error_code = FILE_SYNTAX_ERROR;
+		return;
+	}
+	mapping_size = static_cast<size_t>(li.QuadPart);
+
+	mapping_handle = CreateFileMappingW(fh, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(!mapping_handle) {
+		error_code = FILE_COULD_NOT_OPEN;
+		return;
+	}
+	mapping = static_cast<uint8_t*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+#else
+	int fd = ::open(name.c_str(), O_RDONLY);
+	if(fd < 0) {
+		error_code = FILE_COULD_NOT_OPEN;
+		return;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size < 4) {
+		::close(fd);
+		error_code = FILE_SYNTAX_ERROR;
+		return;
+	}
+	mapping_size = static_cast<size_t>(st.st_size);
+
+	void* ptr = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps its own reference to the file
+	::close(fd);
+	if(ptr != MAP_FAILED) {
+		mapping = static_cast<uint8_t*>(ptr);
+		madvise(ptr, mapping_size, MADV_SEQUENTIAL);
+	}
+#endif
+
+	if(!mapping) {
+		mapping_size = 0;
+		error_code = FILE_COULD_NOT_OPEN;
+		return;
+	}
+
+	// 0x00 00 00 00 is accepted as a wildcard version
+	if(mapping[0] != 0 || mapping[1] != 0 || mapping[2] != 0 || mapping[3] != 0) {
+		bool accepted = false;
+		for(const std::string& identifier : acceptable_identifiers) {
+			if(memcmp(mapping, identifier.c_str(), 4) == 0) {
+				accepted = true;
+				break;
+			}
+		}
+
+		if(!accepted) {
+			close();
+			error_code = FILE_SYNTAX_ERROR;
+			return;
+		}
+	}
+
+	cache = mapping + 4;
+	cache_size = cache_length = mapping_size - 4;
+	local_read_index = 0;
+}
+
+MappedNodeFileReadHandle::~MappedNodeFileReadHandle()
+{
+	close();
+}
+
+void MappedNodeFileReadHandle::close()
+{
+	freeNode(root_node);
+	root_node = nullptr;
+
+#ifdef _WIN32
+	if(mapping) {
+		UnmapViewOfFile(mapping);
+	}
+	if(mapping_handle) {
+		CloseHandle(mapping_handle);
+		mapping_handle = nullptr;
+	}
+	if(file_handle != INVALID_HANDLE_VALUE) {
+		CloseHandle(file_handle);
+		file_handle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if(mapping) {
+		munmap(mapping, mapping_size);
+	}
+#endif
+
+	mapping = nullptr;
+	mapping_size = 0;
+	cache = nullptr;
+	cache_size = cache_length = 0;
+	local_read_index = 0;
+}
+
+bool MappedNodeFileReadHandle::renewCache()
+{
+	// Everything is mapped already
+	return false;
+}
+
+BinaryNode* MappedNodeFileReadHandle::getRootNode()
+{
+	assert(root_node == nullptr); // You should never do this twice
+	if(local_read_index >= cache_length || cache[local_read_index] != NODE_START) {
+		error_code = FILE_SYNTAX_ERROR;
+		return nullptr;
+	}
+
+	local_read_index++;
+	last_was_start = true;
+	root_node = getNode(nullptr);
+	root_node->load();
+	return root_node;
+}
+
 //=============================================================================
 // File based node file read handle
 
@@ -319,7 +472,10 @@ BinaryNode* DiskNodeFileReadHandle::getRootNode()
 // Binary file node
 
 BinaryNode::BinaryNode(NodeFileReadHandle* file, BinaryNode* parent) :
+	payload(nullptr),
+	payload_size(0),
 	read_offset(0),
+	start_offset(0),
 	file(file),
 	parent(parent),
 	child(nullptr)
@@ -347,22 +503,22 @@ BinaryNode* BinaryNode::getChild()
 
 bool BinaryNode::getRAW(uint8_t* ptr, size_t sz)
 {
-	if(read_offset + sz > data.size()) {
-		read_offset = data.size();
+	if(read_offset + sz > payload_size) {
+		read_offset = payload_size;
 		return false;
 	}
-	memcpy(ptr, data.data() + read_offset, sz);
+	memcpy(ptr, payload + read_offset, sz);
 	read_offset += sz;
 	return true;
 }
 
 bool BinaryNode::getRAW(std::string& str, size_t sz)
 {
-	if(read_offset + sz > data.size()) {
-		read_offset = data.size();
+	if(read_offset + sz > payload_size) {
+		read_offset = payload_size;
 		return false;
 	}
-	str.assign(data.data() + read_offset, sz);
+	str.assign(reinterpret_cast<const char*>(payload) + read_offset, sz);
 	read_offset += sz;
 	return true;
 }
@@ -430,6 +586,8 @@ BinaryNode* BinaryNode::advance()
 			// Load this node as the next one
 			read_offset = 0;
 			data.clear();
+			payload = nullptr;
+			payload_size = 0;
 			load();
 			return this;
 		} else if(op == NODE_END) {
@@ -445,9 +603,51 @@ BinaryNode* BinaryNode::advance()
 	}
 }
 
+bool BinaryNode::skipRaw(const uint8_t*& begin, size_t& length)
+{
+	ASSERT(file);
+	if(!file->contiguous || child != nullptr)
+		return false;
+
+	const uint8_t* cache = file->cache;
+	const size_t cache_length = file->cache_length;
+	size_t& local_read_index = file->local_read_index;
+
+	if(file->last_was_start) {
+		// We're inside our first child, walk until our own NODE_END has been passed
+		int depth = 2;
+		while(local_read_index < cache_length) {
+			uint8_t op = cache[local_read_index++];
+			if(op == ESCAPE_CHAR) {
+				++local_read_index;
+			} else if(op == NODE_START) {
+				++depth;
+			} else if(op == NODE_END && --depth == 0) {
+				break;
+			}
+		}
+
+		if(depth != 0) {
+			file->error_code = FILE_PREMATURE_END;
+			local_read_index = cache_length;
+			return false;
+		}
+		file->last_was_start = false;
+	}
+
+	begin = cache + start_offset;
+	length = local_read_index - start_offset;
+	return true;
+}
+
 void BinaryNode::load()
 {
 	ASSERT(file);
+	if(file->contiguous) {
+		loadView();
+		return;
+	}
+
 	// Read until next node starts
 	uint8_t*& cache = file->cache;
 	size_t& cache_length = file->cache_length;
@@ -457,44 +657,100 @@ void BinaryNode::load()
 			if(!file->renewCache()) {
 				// Failed to renew, exit
 				file->error_code = FILE_PREMATURE_END;
-				return;
+				break;
 			}
 		}
 
+		// Copy the plain run in one go
+		size_t run_end = local_read_index;
+		while(run_end < cache_length) {
+			uint8_t c = cache[run_end];
+			if(c == NODE_START || c == NODE_END || c == ESCAPE_CHAR)
+				break;
+			++run_end;
+		}
+		data.append(reinterpret_cast<const char*>(cache) + local_read_index, run_end - local_read_index);
+		local_read_index = run_end;
+		if(local_read_index >= cache_length)
+			continue;
+
 		uint8_t op = cache[local_read_index];
 		++local_read_index;
 
-		switch(op) {
-			case NODE_START: {
-				file->last_was_start = true;
-				return;
-			}
+		if(op == NODE_START) {
+			file->last_was_start = true;
+			break;
+		} else if(op == NODE_END) {
+			file->last_was_start = false;
+			break;
+		}
 
-			case NODE_END: {
-				file->last_was_start = false;
-				return;
+		// ESCAPE_CHAR
+		if(local_read_index >= cache_length) {
+			if(!file->renewCache()) {
+				// Failed to renew, exit
+				file->error_code = FILE_PREMATURE_END;
+				break;
 			}
+		}
 
-			case ESCAPE_CHAR: {
-				if(local_read_index >= cache_length) {
-					if(!file->renewCache()) {
-						// Failed to renew, exit
-						file->error_code = FILE_PREMATURE_END;
-						return;
-					}
-				}
+		op = cache[local_read_index];
+		++local_read_index;
+		data.append(1, op);
+	}
 
-				op = cache[local_read_index];
-				++local_read_index;
-				break;
-			}
+	payload = reinterpret_cast<const uint8_t*>(data.data());
+	payload_size = data.size();
+}
 
-			default:
-				break;
+void BinaryNode::loadView()
+{
+	// The whole file is in memory, so unless the payload contains escaped bytes
+	// the node can simply point into it.
+	const uint8_t* cache = file->cache;
+	const size_t cache_length = file->cache_length;
+	size_t& local_read_index = file->local_read_index;
+
+	const size_t start = local_read_index;
+	start_offset = start - 1;
+	size_t end = start;
+	bool escaped = false;
+	while(end < cache_length) {
+		uint8_t c = cache[end];
+		if(c == NODE_START || c == NODE_END)
+			break;
+		if(c == ESCAPE_CHAR) {
+			escaped = true;
+			++end;
 		}
-		//std::cout << "Appending..." << std::endl;
-		data.append(1, op);
+		++end;
+	}
+
+	if(end >= cache_length) {
+		file->error_code = FILE_PREMATURE_END;
+		local_read_index = cache_length;
+		payload = nullptr;
+		payload_size = 0;
+		return;
+	}
+
+	if(escaped) {
+		data.clear();
+		data.reserve(end - start);
+		for(size_t i = start; i < end; ++i) {
+			if(cache[i] == ESCAPE_CHAR)
+				++i;
+			data.append(1, static_cast<char>(cache[i]));
+		}
+		payload = reinterpret_cast<const uint8_t*>(data.data());
+		payload_size = data.size();
+	} else {
+		payload = cache + start;
+		payload_size = end - start;
 	}
+
+	file->last_was_start = cache[end] == NODE_START;
+	local_read_index = end + 1;
 }
 
 //=============================================================================
@@ -614,6 +870,7 @@ void DiskNodeFileWriteHandle::renewCache()
 		if(ferror(file) != 0) {
 			error_code = FILE_WRITE_ERROR;
 		}
+		flushed_size += local_write_index;
 	} else {
 		cache = (uint8_t*)malloc(cache_size+1);
 	}
@@ -677,7 +934,8 @@ void MemoryNodeFileWriteHandle::renewCache()
 NodeFileWriteHandle::NodeFileWriteHandle() :
 	cache(nullptr),
 	cache_size(0x7FFF),
-	local_write_index(0)
+	local_write_index(0),
+	flushed_size(0)
 {
 	////
 }
@@ -771,3 +1029,18 @@ bool NodeFileWriteHandle::addRAW(const uint8_t* ptr, size_t sz)
 	writeBytes(ptr, sz);
 	return error_code == FILE_NO_ERROR;
 }
+
+bool NodeFileWriteHandle::addEncoded(const uint8_t* ptr, size_t sz)
+{
+	while(sz != 0) {
+		const size_t chunk = std::min(sz, cache_size - local_write_index);
+		memcpy(cache + local_write_index, ptr, chunk);
+		local_write_index += chunk;
+		if(local_write_index >= cache_size) {
+			renewCache();
+		}
+		ptr += chunk;
+		sz -= chunk;
+	}
+	return error_code == FILE_NO_ERROR;
+}
@@ -107,6 +107,8 @@ protected:
 class NodeFileReadHandle;
 class DiskNodeFileReadHandle;
 class MemoryNodeFileReadHandle;
+class MappedNodeFileReadHandle;
+class OTGZNodeFileReadHandle;
 
 class BinaryNode
 {
@@ -120,8 +122,8 @@ public:
 	FORCEINLINE bool getU32(uint32_t& u32) { return getType(u32); }
 	FORCEINLINE bool getU64(uint64_t& u64) { return getType(u64); }
 	FORCEINLINE bool skip(size_t sz) {
-		if(read_offset + sz > data.size()) {
-			read_offset = data.size();
+		if(read_offset + sz > payload_size) {
+			read_offset = payload_size;
 			return false;
 		}
 		read_offset += sz;
@@ -135,28 +137,40 @@ public:
 	BinaryNode* getChild();
 	// Returns this on success, nullptr on failure
 	BinaryNode* advance();
+	// Skips the children of this node without loading them and returns the raw (still escaped)
+	// bytes of the entire node, delimiters included. Only works on contiguous handles.
+	bool skipRaw(const uint8_t*& begin, size_t& length);
 protected:
 	template<class T>
 	bool getType(T& ref) {
-		if(read_offset + sizeof(ref) > data.size()) {
-			read_offset = data.size();
+		if(read_offset + sizeof(ref) > payload_size) {
+			read_offset = payload_size;
 			return false;
 		}
-		ref = *(T*)(data.data()+read_offset);
+		memcpy(&ref, payload + read_offset, sizeof(ref));
 
 		read_offset += sizeof(ref);
 		return true;
 	}
 
 	void load();
+	void loadView();
+	// Only used when the payload has to be unescaped or the handle can't keep the bytes around
 	std::string data;
+	// Points either into 'data' or straight into the handle's memory
+	const uint8_t* payload;
+	size_t payload_size;
 	size_t read_offset;
+	// Offset of the NODE_START byte of this node, only valid on contiguous handles
+	size_t start_offset;
 	NodeFileReadHandle* file;
 	BinaryNode* parent;
 	BinaryNode* child;
 
 	friend class DiskNodeFileReadHandle;
 	friend class MemoryNodeFileReadHandle;
+	friend class MappedNodeFileReadHandle;
+	friend class OTGZNodeFileReadHandle;
 };
 
 class NodeFileReadHandle : public FileHandle
@@ -169,6 +183,10 @@ public:
 
 	virtual size_t size() = 0;
 	virtual size_t tell() = 0;
+
+	bool isContiguous() const noexcept { return contiguous; }
+	// The node data of contiguous handles, offsets from tell() and skipRaw count from here
+	const uint8_t* getData() const noexcept { return cache; }
 protected:
 	BinaryNode* getNode(BinaryNode* parent);
 	void freeNode(BinaryNode* node);
@@ -176,6 +194,8 @@ protected:
 	virtual bool renewCache() = 0;
 
 	bool last_was_start;
+	// True if 'cache' holds the entire file, nodes can then reference it directly
+	bool contiguous;
 	uint8_t* cache;
 	size_t cache_size;
 	size_t cache_length;
@@ -226,6 +246,33 @@ protected:
 	uint8_t* index;
 };
 
+// Maps the whole file into memory, nodes are views into the mapping
+// and only unescaped payloads are ever copied.
+class MappedNodeFileReadHandle : public NodeFileReadHandle
+{
+public:
+	MappedNodeFileReadHandle(const std::string& name, const std::vector<std::string>& acceptable_identifiers);
+	virtual ~MappedNodeFileReadHandle();
+
+	virtual void close();
+	virtual BinaryNode* getRootNode();
+
+	virtual bool isOpen() { return mapping != nullptr; }
+	virtual bool isOk() { return isOpen() && error_code == FILE_NO_ERROR; }
+
+	virtual size_t size() { return cache_length; }
+	virtual size_t tell() { return local_read_index; }
+protected:
+	virtual bool renewCache();
+
+	uint8_t* mapping;
+	size_t mapping_size;
+#ifdef _WIN32
+	void* file_handle;
+	void* mapping_handle;
+#endif
+};
+
 class FileWriteHandle : public FileHandle
 {
 public:
@@ -272,6 +319,11 @@ public:
 	bool addRAW(std::string& str);
 	bool addRAW(const uint8_t* ptr, size_t sz);
 	bool addRAW(const char* c) { return addRAW(reinterpret_cast<const uint8_t*>(c), strlen(c)); }
+	// Appends the output of another write handle as-is, it is already escaped and holds whole nodes
+	bool addEncoded(const uint8_t* ptr, size_t sz);
+
+	// Bytes written so far, the file identifier not included
+	size_t tell() const noexcept { return flushed_size + local_write_index; }
 
 protected:
 	virtual void renewCache() = 0;
@@ -283,6 +335,8 @@ protected:
 	uint8_t* cache;
 	size_t cache_size;
 	size_t local_write_index;
+	// Bytes handed on by renewCache
+	size_t flushed_size;
 
 	FORCEINLINE void writeBytes(const uint8_t* ptr, size_t sz) {
 		if(sz) {
@@ -68,8 +68,8 @@ GraphicManager::GraphicManager() :
 	has_transparency(false),
 	has_frame_durations(false),
 	has_frame_groups(false),
-	loaded_textures(0),
-	lastclean(0)
+	lastclean(0),
+	revision(0)
 {
 	animation_timer = newd wxStopWatch();
 	animation_timer->Start();
@@ -101,12 +101,6 @@ bool GraphicManager::isUnloaded() const
 	return unloaded;
 }
 
-GLuint GraphicManager::getFreeTextureID()
-{
-	static GLuint id_counter = 0x10000000;
-	return id_counter++; // This should (hopefully) never run out
-}
-
 void GraphicManager::clear()
 {
 	SpriteMap new_sprite_space;
@@ -128,8 +122,8 @@ void GraphicManager::clear()
 
 	item_count = 0;
 	creature_count = 0;
-	loaded_textures = 0;
 	lastclean = time(nullptr);
+	++revision;
 	spritefile = "";
 
 	unloaded = true;
@@ -948,9 +942,15 @@ void GraphicManager::addSpriteToCleanup(GameSprite* spr)
 
 void GraphicManager::garbageCollection()
 {
+	// Called once per frame, pages drawn from until now may be emptied again
+	atlas.nextFrame();
+
 	if(g_settings.getInteger(Config::TEXTURE_MANAGEMENT)) {
+		// Once the threshold is reached, pages are reused instead of adding more
+		atlas.setPageLimit(g_settings.getInteger(Config::TEXTURE_CLEAN_THRESHOLD) / TextureAtlas::SLOTS_PER_PAGE + 1);
+
 		int t = time(nullptr);
-		if(loaded_textures > g_settings.getInteger(Config::TEXTURE_CLEAN_THRESHOLD) &&
+		if(atlas.getSpriteCount() > static_cast<size_t>(g_settings.getInteger(Config::TEXTURE_CLEAN_THRESHOLD)) &&
 			t - lastclean > g_settings.getInteger(Config::TEXTURE_CLEAN_PULSE)) {
 			ImageMap::iterator iit = image_space.begin();
 			while(iit != image_space.end()) {
@@ -965,6 +965,8 @@ void GraphicManager::garbageCollection()
 			}
 			lastclean = t;
 		}
+	} else {
+		atlas.setPageLimit(0);
 	}
 }
 
@@ -1051,7 +1053,7 @@ int GameSprite::getIndex(int width, int height, int layer, int pattern_x, int pa
 		this->width + width;
 }
 
-GLuint GameSprite::getHardwareID(int _x, int _y, int _layer, int _count, int _pattern_x, int _pattern_y, int _pattern_z, int _frame)
+GameSprite::Image* GameSprite::getImage(int _x, int _y, int _layer, int _count, int _pattern_x, int _pattern_y, int _pattern_z, int _frame)
 {
 	uint32_t v;
 	if(_count >= 0 && height <= 1 && width <= 1) {
@@ -1066,7 +1068,7 @@ GLuint GameSprite::getHardwareID(int _x, int _y, int _layer, int _count, int _pa
 			v %= numsprites;
 		}
 	}
-	return spriteList[v]->getHardwareID();
+	return spriteList[v];
 }
 
 GameSprite::TemplateImage* GameSprite::getTemplateImage(int sprite_index, const Outfit& outfit)
@@ -1091,7 +1093,7 @@ GameSprite::TemplateImage* GameSprite::getTemplateImage(int sprite_index, const
 	return img;
 }
 
-GLuint GameSprite::getHardwareID(int _x, int _y, int _dir, int _addon, int _pattern_z, const Outfit& _outfit, int _frame)
+GameSprite::Image* GameSprite::getImage(int _x, int _y, int _dir, int _addon, int _pattern_z, const Outfit& _outfit, int _frame)
 {
 	uint32_t v = getIndex(_x, _y, 0, _dir, _addon, _pattern_z, _frame);
 	if(v >= numsprites) {
@@ -1102,10 +1104,9 @@ GLuint GameSprite::getHardwareID(int _x, int _y, int _dir, int _addon, int _patt
 		}
 	}
 	if(layers > 1) { // Template
-		TemplateImage* img = getTemplateImage(v, _outfit);
-		return img->getHardwareID();
+		return getTemplateImage(v, _outfit);
 	}
-	return spriteList[v]->getHardwareID();
+	return spriteList[v];
 }
 
 wxMemoryDC* GameSprite::getDC(SpriteSize size)
@@ -1225,7 +1226,6 @@ void GameSprite::DrawTo(wxDC* context, const wxRect& rect, const Outfit& outfit)
 }
 
 GameSprite::Image::Image() :
-	isGLLoaded(false),
 	lastaccess(0)
 {
 	////
@@ -1233,36 +1233,36 @@ GameSprite::Image::Image() :
 
 GameSprite::Image::~Image()
 {
-	unloadGLTexture(0);
+	unloadGLTexture();
 }
 
-void GameSprite::Image::createGLTexture(GLuint textureId)
+TextureRegion GameSprite::Image::getTextureRegion()
 {
-	ASSERT(!isGLLoaded);
+	if(!g_gui.gfx.atlas.contains(texture)) {
+		createGLTexture();
+		if(!g_gui.gfx.atlas.contains(texture)) {
+			return TextureRegion();
+		}
+	}
+	visit();
+	return g_gui.gfx.atlas.getRegion(texture);
+}
 
+void GameSprite::Image::createGLTexture()
+{
 	uint8_t* rgba = getRGBAData();
 	if(!rgba) {
 		return;
 	}
 
-	isGLLoaded = true;
-	g_gui.gfx.loaded_textures += 1;
-
-	glBindTexture(GL_TEXTURE_2D, textureId);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // Linear Filtering
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Linear Filtering
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, 0x812F); // GL_CLAMP_TO_EDGE
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, 0x812F); // GL_CLAMP_TO_EDGE
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, rme::SpritePixels, rme::SpritePixels, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+	g_gui.gfx.atlas.add(rgba, texture);
 
 	delete[] rgba;
 }
 
-void GameSprite::Image::unloadGLTexture(GLuint textureId)
+void GameSprite::Image::unloadGLTexture()
 {
-	isGLLoaded = false;
-	g_gui.gfx.loaded_textures -= 1;
-	glDeleteTextures(1, &textureId);
+	g_gui.gfx.atlas.remove(texture);
 }
 
 void GameSprite::Image::visit()
@@ -1272,8 +1272,8 @@ void GameSprite::Image::visit()
 
 void GameSprite::Image::clean(int time)
 {
-	if(isGLLoaded && time - lastaccess > g_settings.getInteger(Config::TEXTURE_LONGEVITY)) {
-		unloadGLTexture(0);
+	if(g_gui.gfx.atlas.contains(texture) && time - lastaccess > g_settings.getInteger(Config::TEXTURE_LONGEVITY)) {
+		unloadGLTexture();
 	}
 }
 
@@ -1405,34 +1405,13 @@ uint8_t* GameSprite::NormalImage::getRGBAData()
 	return data;
 }
 
-GLuint GameSprite::NormalImage::getHardwareID()
-{
-	if(!isGLLoaded) {
-		createGLTexture(id);
-	}
-	visit();
-	return id;
-}
-
-void GameSprite::NormalImage::createGLTexture(GLuint textureId)
-{
-	Image::createGLTexture(id);
-}
-
-void GameSprite::NormalImage::unloadGLTexture(GLuint textureId)
-{
-	Image::unloadGLTexture(id);
-}
-
 GameSprite::EditorImage::EditorImage(const wxArtID& bitmapId) :
 	NormalImage(),
 	bitmapId(bitmapId)
 { }
 
-void GameSprite::EditorImage::createGLTexture(GLuint textureId)
+void GameSprite::EditorImage::createGLTexture()
 {
-	ASSERT(!isGLLoaded);
-
 	wxSize size(rme::SpritePixels, rme::SpritePixels);
 	wxBitmap bitmap = wxArtProvider::GetBitmap(bitmapId, wxART_OTHER, size);
 
@@ -1468,27 +1447,12 @@ void GameSprite::EditorImage::createGLTexture(GLuint textureId)
 		it.OffsetY(data, 1);
 	}
 
-	isGLLoaded = true;
-	id = g_gui.gfx.getFreeTextureID();
-	g_gui.gfx.loaded_textures += 1;
-
-	glBindTexture(GL_TEXTURE_2D, id);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // Linear Filtering
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Linear Filtering
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, 0x812F); // GL_CLAMP_TO_EDGE
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, 0x812F); // GL_CLAMP_TO_EDGE
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, rme::SpritePixels, rme::SpritePixels, 0, GL_RGBA, GL_UNSIGNED_BYTE, imageData);
+	g_gui.gfx.atlas.add(imageData, texture);
 
 	delete[] imageData;
 }
 
-void GameSprite::EditorImage::unloadGLTexture(GLuint textureId)
-{
-	Image::unloadGLTexture(id);
-}
-
 GameSprite::TemplateImage::TemplateImage(GameSprite* parent, int v, const Outfit& outfit) :
-	gl_tid(0),
 	parent(parent),
 	sprite_index(v),
 	lookHead(outfit.lookHead),
@@ -1619,31 +1583,6 @@ uint8_t* GameSprite::TemplateImage::getRGBAData()
 	return rgbadata;
 }
 
-GLuint GameSprite::TemplateImage::getHardwareID()
-{
-	if(!isGLLoaded) {
-		if(gl_tid == 0) {
-			gl_tid = g_gui.gfx.getFreeTextureID();
-		}
-		createGLTexture(gl_tid);
-		if(!isGLLoaded) {
-			return 0;
-		}
-	}
-	visit();
-	return gl_tid;
-}
-
-void GameSprite::TemplateImage::createGLTexture(GLuint unused)
-{
-	Image::createGLTexture(gl_tid);
-}
-
-void GameSprite::TemplateImage::unloadGLTexture(GLuint unused)
-{
-	Image::unloadGLTexture(gl_tid);
-}
-
 GameSprite* GameSprite::createFromBitmap(const wxArtID& bitmapId)
 {
 	GameSprite::EditorImage* image = new GameSprite::EditorImage(bitmapId);
@@ -23,6 +23,7 @@
 #include <deque>
 
 #include "client_version.h"
+#include "texture_atlas.h"
 
 #include <wx/artprov.h>
 
@@ -80,12 +81,16 @@ protected:
 class GameSprite : public Sprite
 {
 public:
+	class Image;
+	class NormalImage;
+	class TemplateImage;
+
 	GameSprite();
 	virtual ~GameSprite();
 
 	int getIndex(int width, int height, int layer, int pattern_x, int pattern_y, int pattern_z, int frame) const;
-	GLuint getHardwareID(int _x, int _y, int _layer, int _subtype, int _pattern_x, int _pattern_y, int _pattern_z, int _frame);
-	GLuint getHardwareID(int _x, int _y, int _dir, int _addon, int _pattern_z, const Outfit& _outfit, int _frame); // CreatureDatabase
+	Image* getImage(int _x, int _y, int _layer, int _subtype, int _pattern_x, int _pattern_y, int _pattern_z, int _frame);
+	Image* getImage(int _x, int _y, int _dir, int _addon, int _pattern_z, const Outfit& _outfit, int _frame); // CreatureDatabase
 	virtual void DrawTo(wxDC* dc, SpriteSize sz, int start_x, int start_y, int width = -1, int height = -1);
 	void DrawTo(wxDC* context, const wxRect& rect, const Outfit& outfit);
 
@@ -102,33 +107,27 @@ public:
 
 	static GameSprite* createFromBitmap(const wxArtID& bitmapId);
 
-protected:
-	class Image;
-	class NormalImage;
-	class TemplateImage;
-
-	wxMemoryDC* getDC(SpriteSize size);
-	wxMemoryDC* getDC(const Outfit& outfit);
-	TemplateImage* getTemplateImage(int sprite_index, const Outfit& outfit);
-
+	// Images live as long as the GraphicManager doesn't clear the sprites
 	class Image {
 	public:
 		Image();
 		virtual ~Image();
 
-		bool isGLLoaded;
+		// The slot in the texture atlas
+		TextureAtlas::Handle texture;
 		int lastaccess;
 
 		void visit();
 		virtual void clean(int time);
 
-		virtual GLuint getHardwareID() = 0;
+		// Puts the image into the atlas first if needed
+		TextureRegion getTextureRegion();
 		virtual uint8_t* getRGBData() = 0;
 		virtual uint8_t* getRGBAData() = 0;
 
 	protected:
-		virtual void createGLTexture(GLuint textureId);
-		virtual void unloadGLTexture(GLuint textureId);
+		virtual void createGLTexture();
+		void unloadGLTexture();
 	};
 
 	class NormalImage : public Image {
@@ -136,7 +135,6 @@ protected:
 		NormalImage();
 		virtual ~NormalImage();
 
-		// We use the sprite id as GL texture id
 		uint32_t id;
 
 		// This contains the pixel data
@@ -145,21 +143,15 @@ protected:
 
 		virtual void clean(int time);
 
-		virtual GLuint getHardwareID();
 		virtual uint8_t* getRGBData();
 		virtual uint8_t* getRGBAData();
-
-	protected:
-		virtual void createGLTexture(GLuint textureId = 0);
-		virtual void unloadGLTexture(GLuint textureId = 0);
 	};
 
 	class EditorImage : public NormalImage {
 	public:
 		EditorImage(const wxArtID& bitmapId);
 	protected:
-		void createGLTexture(GLuint textureId) override;
-		void unloadGLTexture(GLuint textureId) override;
+		void createGLTexture() override;
 	private:
 		wxArtID bitmapId;
 	};
@@ -169,11 +161,9 @@ protected:
 		TemplateImage(GameSprite* parent, int v, const Outfit& outfit);
 		virtual ~TemplateImage();
 
-		virtual GLuint getHardwareID();
 		virtual uint8_t* getRGBData();
 		virtual uint8_t* getRGBAData();
 
-		GLuint gl_tid;
 		GameSprite* parent;
 		int sprite_index;
 		uint8_t lookHead;
@@ -182,11 +172,13 @@ protected:
 		uint8_t lookFeet;
 	protected:
 		void colorizePixel(uint8_t color, uint8_t &r, uint8_t &b, uint8_t &g);
-
-		virtual void createGLTexture(GLuint ignored = 0);
-		virtual void unloadGLTexture(GLuint ignored = 0);
 	};
 
+protected:
+	wxMemoryDC* getDC(SpriteSize size);
+	wxMemoryDC* getDC(const Outfit& outfit);
+	TemplateImage* getTemplateImage(int sprite_index, const Outfit& outfit);
+
 	uint32_t id;
 	wxMemoryDC* dc[SPRITE_SIZE_COUNT];
 
@@ -299,14 +291,13 @@ public:
 	GameSprite* getEditorSprite(int id);
 
 	long getElapsedTime() const { return (animation_timer->TimeInMicro() / 1000).ToLong(); }
+	// Changes whenever the sprites (and their images) are thrown away
+	uint32_t getRevision() const noexcept { return revision; }
 
 	uint16_t getItemSpriteMinID() const noexcept { return 100; }
 	uint16_t getItemSpriteMaxID() const noexcept { return item_count; }
 	uint16_t getCreatureSpriteMaxID() const noexcept { return creature_count; }
 
-	// Get an unused texture id (this is acquired by simply increasing a value starting from 0x10000000)
-	GLuint getFreeTextureID();
-
 	// This is part of the binary
 	bool loadEditorSprites();
 	// Metadata should be loaded first
@@ -369,8 +360,10 @@ private:;
 	wxFileName metadata_file;
 	wxFileName sprites_file;
 
-	int loaded_textures;
+	// Every game and editor sprite drawn on the map is kept here
+	TextureAtlas atlas;
 	int lastclean;
+	uint32_t revision;
 
 	wxStopWatch* animation_timer;
 
@@ -86,17 +86,21 @@ House::House(Map& map) :
 	townid(0),
 	guildhall(false),
 	map(&map),
-	exit(0,0,0)
+	exit(0,0,0),
+	doors_stale(false),
+	bounds_stale(false)
 {
 	////
 }
 
 void House::clean()
 {
-	for(PositionList::const_iterator pos_iter = tiles.begin(); pos_iter != tiles.end(); ++pos_iter) {
-		Tile* tile = map->getTile(*pos_iter);
-		if(tile)
+	for(const Position& position : tiles) {
+		Tile* tile = map->getTile(position);
+		if(tile) {
 			tile->setHouse(nullptr);
+			map->markTileHouseChanged(position.x, position.y, position.z);
+		}
 	}
 
 	Tile* tile = map->getTile(exit);
@@ -107,8 +111,8 @@ void House::clean()
 size_t House::size() const
 {
 	size_t count = 0;
-	for(PositionList::const_iterator pos_iter = tiles.begin(); pos_iter != tiles.end(); ++pos_iter) {
-		Tile* tile = map->getTile(*pos_iter);
+	for(const Position& position : tiles) {
+		Tile* tile = map->getTile(position);
 		if(tile && !tile->isBlocking())
 			++count;
 	}
@@ -119,56 +123,115 @@ void House::addTile(Tile* tile)
 {
 	ASSERT(tile);
 	tile->setHouse(this);
-	tiles.push_back(tile->getPosition());
+
+	const Position& position = tile->getPosition();
+	PositionVector::iterator it = std::lower_bound(tiles.begin(), tiles.end(), position);
+	if(it != tiles.end() && *it == position)
+		return;
+
+	if(!bounds_stale) {
+		if(tiles.empty()) {
+			min_bound = max_bound = position;
+		} else {
+			min_bound = Position(std::min(min_bound.x, position.x), std::min(min_bound.y, position.y), std::min(min_bound.z, position.z));
+			max_bound = Position(std::max(max_bound.x, position.x), std::max(max_bound.y, position.y), std::max(max_bound.z, position.z));
+		}
+	}
+	tiles.insert(it, position);
+	doors_stale = true;
 }
 
 void House::removeTile(Tile* tile)
 {
 	ASSERT(tile);
-	for(PositionList::iterator tile_iter = tiles.begin(); tile_iter != tiles.end(); ++tile_iter) {
-		if(*tile_iter == tile->getPosition()) {
-			tiles.erase(tile_iter);
-			tile->setHouse(nullptr);
-			return;
-		}
+	const Position& position = tile->getPosition();
+	PositionVector::iterator it = std::lower_bound(tiles.begin(), tiles.end(), position);
+	if(it == tiles.end() || *it != position)
+		return;
+
+	tiles.erase(it);
+	tile->setHouse(nullptr);
+	map->markTileHouseChanged(position.x, position.y, position.z);
+
+	// Only a tile on the edge of the box can make it smaller
+	if(position.x == min_bound.x || position.y == min_bound.y || position.z == min_bound.z ||
+		position.x == max_bound.x || position.y == max_bound.y || position.z == max_bound.z)
+		bounds_stale = true;
+	doors_stale = true;
+}
+
+bool House::hasTile(const Position& position) const
+{
+	return std::binary_search(tiles.begin(), tiles.end(), position);
+}
+
+bool House::getBounds(Position& min_pos, Position& max_pos) const
+{
+	if(tiles.empty())
+		return false;
+
+	if(bounds_stale)
+		updateBounds();
+
+	min_pos = min_bound;
+	max_pos = max_bound;
+	return true;
+}
+
+void House::updateBounds() const
+{
+	bounds_stale = false;
+	if(tiles.empty())
+		return;
+
+	min_bound = max_bound = tiles.front();
+	for(const Position& position : tiles) {
+		min_bound = Position(std::min(min_bound.x, position.x), std::min(min_bound.y, position.y), std::min(min_bound.z, position.z));
+		max_bound = Position(std::max(max_bound.x, position.x), std::max(max_bound.y, position.y), std::max(max_bound.z, position.z));
 	}
 }
 
-uint8_t House::getEmptyDoorID() const
+void House::updateDoors() const
 {
-	std::set<uint8_t> taken;
-	for(PositionList::const_iterator tile_iter = tiles.begin(); tile_iter != tiles.end(); ++tile_iter) {
-		if(const Tile* tile = map->getTile(*tile_iter)) {
-			for(ItemVector::const_iterator item_iter = tile->items.begin(); item_iter != tile->items.end(); ++item_iter) {
-				if(Door* door = dynamic_cast<Door*>(*item_iter))
-					taken.insert(door->getDoorID());
+	doors_stale = false;
+	doors.clear();
+	for(const Position& position : tiles) {
+		if(const Tile* tile = map->getTile(position)) {
+			for(const Item* item : tile->items) {
+				if(const Door* door = dynamic_cast<const Door*>(item))
+					doors.emplace_back(door->getDoorID(), position);
 			}
 		}
 	}
+	std::sort(doors.begin(), doors.end());
+}
 
-	for(int i = 1; i < 256; ++i) {
-		std::set<uint8_t>::iterator it = taken.find(uint8_t(i));
-		if(it == taken.end()) {
-			// Free ID!
-			return i;
+uint8_t House::getEmptyDoorID() const
+{
+	if(doors_stale)
+		updateDoors();
+
+	// The ids are sorted, the first gap is the first free id
+	int free_id = 1;
+	for(const auto& door : doors) {
+		if(door.first == free_id) {
+			++free_id;
+		} else if(door.first > free_id) {
+			break;
 		}
 	}
-	return 255;
+	return free_id < 256 ? free_id : 255;
 }
 
 Position House::getDoorPositionByID(uint8_t id) const
 {
-	for(PositionList::const_iterator tile_iter = tiles.begin(); tile_iter != tiles.end(); ++tile_iter) {
-		if(const Tile* tile = map->getTile(*tile_iter)) {
-			for(ItemVector::const_iterator item_iter = tile->items.begin(); item_iter != tile->items.end(); ++item_iter) {
-				if(Door* door = dynamic_cast<Door*>(*item_iter)) {
-					if(door->getDoorID() == id) {
-						return *tile_iter;
-					}
-				}
-			}
-		}
-	}
+	if(doors_stale)
+		updateDoors();
+
+	auto it = std::lower_bound(doors.begin(), doors.end(), id,
+		[](const std::pair<uint8_t, Position>& door, uint8_t id) { return door.first < id; });
+	if(it != doors.end() && it->first == id)
+		return it->second;
 	return Position();
 }
 
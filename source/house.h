@@ -34,6 +34,7 @@ public:
 	void clean();
 	void addTile(Tile* tile);
 	void removeTile(Tile* tile);
+	bool hasTile(const Position& position) const;
 	size_t size() const;
 	std::string getDescription();
 
@@ -49,14 +50,29 @@ public:
 	const Position& getExit() const noexcept { return exit; }
 	uint8_t getEmptyDoorID() const;
 	Position getDoorPositionByID(uint8_t id) const;
+	// The door table is read from the tiles again the next time it is needed
+	void markDoorsChanged() noexcept { doors_stale = true; }
 
-	const PositionList& getTiles() const { return tiles; }
+	// Sorted
+	const PositionVector& getTiles() const noexcept { return tiles; }
+	// Smallest box around all tiles of the house, false if it has none
+	bool getBounds(Position& min_pos, Position& max_pos) const;
 
 protected:
+	void updateDoors() const;
+	void updateBounds() const;
+
 	Map* map;
-	PositionList tiles;
+	PositionVector tiles;
 	Position exit;
 
+	// Door ids and the positions of their doors, by id and then by position
+	mutable std::vector<std::pair<uint8_t, Position>> doors;
+	mutable bool doors_stale;
+	mutable Position min_bound;
+	mutable Position max_bound;
+	mutable bool bounds_stale;
+
 	friend class Houses;
 };
 
@@ -24,6 +24,9 @@
 #include <wx/datstrm.h>
 #include <wx/dir.h>
 
+#include <atomic>
+#include <charconv>
+
 #include "settings.h"
 #include "gui.h" // Loadbar
 
@@ -34,15 +37,14 @@
 #include "item.h"
 #include "complexitem.h"
 #include "town.h"
+#include "worker_pool.h"
+#include "otgz.h"
 
 #include "iomap_otbm.h"
 
 typedef uint8_t attribute_t;
 typedef uint32_t flags_t;
 
-
-std::map<uint16_t, std::vector<Position>> zoneMap;
-
 // H4X
 void reform(Map* map, Tile* tile, Item* item)
 {
@@ -75,32 +77,260 @@ std::string removeOTBMExtension(const std::string& filename) {
 	return filename;
 }
 
-toml::table serializeZoneToToml(uint16_t zoneId, const std::vector<Position>& positions) {
-	std::ostringstream tomlStream;
-	tomlStream << "[[zone]]\n";
-	tomlStream << "id = " << zoneId << "\n";
-	tomlStream << "positions = [";
-	for (size_t i = 0; i < positions.size(); ++i) {
-		const auto& pos = positions[i];
-		tomlStream << "{x = " << pos.x << ", y = " << pos.y << ", z = " << pos.z << "}";
-		if (i < positions.size() - 1) {
-			tomlStream << ", ";
-		}
+// Zone files hold a [[zone]] table with the id and the positions of one zone:
+//   [[zone]]
+//   id = 1
+//   positions = [
+//   	{ x = 1000, y = 1000, z = 7 },
+//   ]
+// They are written and read here directly, toml++ only reads files that are
+// laid out in any other way.
+namespace {
+	typedef std::vector<std::pair<uint16_t, std::vector<Position>>> ZoneList;
+
+	constexpr size_t ZONE_FILE_BUFFER = 1 << 16;
+
+	bool writeZoneFile(const Zones& zones, uint16_t zone_id, const wxString& path)
+	{
+		wxFile file(path, wxFile::write);
+		if(!file.IsOpened())
+			return false;
+
+		bool ok = true;
+		std::string buffer;
+		buffer.reserve(ZONE_FILE_BUFFER + 64);
+		auto flush = [&]() {
+			ok = ok && file.Write(buffer.data(), buffer.size()) == buffer.size();
+			buffer.clear();
+		};
+		auto append = [&buffer](int value) {
+			char digits[16];
+			char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+			buffer.append(digits, end);
+		};
+
+		buffer += "[[zone]]\nid = ";
+		append(zone_id);
+		buffer += "\npositions = [\n";
+		zones.forEachSpan(zone_id, [&](int start_x, int end_x, int y, int z) {
+			for(int x = start_x; x <= end_x; ++x) {
+				buffer += "\t{ x = ";
+				append(x);
+				buffer += ", y = ";
+				append(y);
+				buffer += ", z = ";
+				append(z);
+				buffer += " },\n";
+				if(buffer.size() >= ZONE_FILE_BUFFER)
+					flush();
+			}
+		});
+		buffer += "]\n";
+		flush();
+		return file.Close() && ok;
 	}
-	tomlStream << "]\n\n";
-	std::string tomlString = tomlStream.str();
-	try {
-		return toml::parse(tomlString);
+
+	// Reads the files written by writeZoneFile (and by older versions, which
+	// put all positions on one line) in a single pass
+	class ZoneFileParser
+	{
+	public:
+		ZoneFileParser(const char* data, size_t size) : current(data), end(data + size) {}
+
+		// False as soon as anything does not look like a zone file
+		bool parse(ZoneList& zones)
+		{
+			while(skipSpace()) {
+				if(!expect("[[") || !skipSpace() || !expect("zone") || !skipSpace() || !expect("]]"))
+					return false;
+
+				int64_t id = -1;
+				std::vector<Position> positions;
+				while(skipSpace() && *current != '[') {
+					if(expect("id")) {
+						if(!skipSpace() || !expect("=") || !skipSpace() || !parseInteger(id))
+							return false;
+					} else if(expect("positions")) {
+						if(!skipSpace() || !expect("=") || !parsePositions(positions))
+							return false;
+					} else {
+						return false;
+					}
+				}
+				if(id < 0)
+					return false;
+				zones.emplace_back(static_cast<uint16_t>(id), std::move(positions));
+			}
+			return true;
+		}
+
+	private:
+		// Skips blanks, line ends and comments, false at the end of the data
+		bool skipSpace()
+		{
+			while(current != end) {
+				if(*current == '#') {
+					while(current != end && *current != '\n')
+						++current;
+				} else if(*current == ' ' || *current == '\t' || *current == '\r' || *current == '\n') {
+					++current;
+				} else {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool expect(const char* text)
+		{
+			const size_t length = strlen(text);
+			if(static_cast<size_t>(end - current) < length || memcmp(current, text, length) != 0)
+				return false;
+			current += length;
+			return true;
+		}
+
+		bool parseInteger(int64_t& value)
+		{
+			auto result = std::from_chars(current, end, value);
+			if(result.ec != std::errc())
+				return false;
+			current = result.ptr;
+			return true;
+		}
+
+		bool parsePositions(std::vector<Position>& positions)
+		{
+			if(!skipSpace() || !expect("["))
+				return false;
+
+			while(skipSpace()) {
+				if(expect("]"))
+					return true;
+				if(!expect("{"))
+					return false;
+
+				int64_t coordinates[3] = { 0, 0, 0 };
+				while(skipSpace() && !expect("}")) {
+					int axis;
+					if(expect("x")) axis = 0;
+					else if(expect("y")) axis = 1;
+					else if(expect("z")) axis = 2;
+					else return false;
+
+					if(!skipSpace() || !expect("=") || !skipSpace() || !parseInteger(coordinates[axis]))
+						return false;
+					if(skipSpace())
+						expect(",");
+				}
+				positions.emplace_back(static_cast<uint16_t>(coordinates[0]), static_cast<uint16_t>(coordinates[1]), static_cast<uint8_t>(coordinates[2]));
+
+				if(skipSpace())
+					expect(",");
+			}
+			return false;
+		}
+
+		const char* current;
+		const char* end;
+	};
+
+	bool parseZoneFileToml(const std::string& content, ZoneList& zones, const wxString& filepath)
+	{
+		try {
+			toml::table tbl = toml::parse(content);
+			auto zonesArray = tbl["zone"];
+			if (!zonesArray || !zonesArray.is_array()) {
+				wxLogWarning("Invalid zone file: %s", filepath);
+				return false;
+			}
+			for (const auto& zoneEntry : *zonesArray.as_array()) {
+				if (zoneEntry.is_table()) {
+					const toml::table& zoneTable = *zoneEntry.as_table();
+					auto idVal = zoneTable["id"];
+					auto posArray = zoneTable["positions"];
+					if (idVal && idVal.is_integer() && posArray && posArray.is_array()) {
+						uint16_t zoneId = static_cast<uint16_t>(idVal.value_or(0));
+						std::vector<Position> positions;
+						for (const auto& pos : *posArray.as_array()) {
+							if (pos.is_table()) {
+								const toml::table& posTable = *pos.as_table();
+								uint16_t x = static_cast<uint16_t>(posTable["x"].value_or(0));
+								uint16_t y = static_cast<uint16_t>(posTable["y"].value_or(0));
+								uint8_t z = static_cast<uint8_t>(posTable["z"].value_or(0));
+								positions.emplace_back(Position{ x, y, z });
+							}
+						}
+						zones.emplace_back(zoneId, std::move(positions));
+					}
+				}
+			}
+			return true;
+		}
+		catch (const toml::parse_error& err) {
+			wxLogError("TOML parse error in file %s: %s", filepath, err.what());
+			return false;
+		}
 	}
-	catch (const toml::parse_error& err) {
-		throw std::runtime_error("Failed to parse generated TOML: " + std::string(err.what()));
+
+	void loadZonesFromToml(const wxString& folderPath, Map& map)
+	{
+		if (not wxDirExists(folderPath)) {
+			return;
+		}
+		auto zoneDir = wxDir(folderPath);
+		if (not zoneDir.IsOpened()) {
+			return;
+		}
+
+		ZoneList zones;
+		wxString filename;
+		bool open_file = zoneDir.GetFirst(&filename, "*.toml", wxDIR_FILES);
+		while (open_file) {
+			wxString filepath = folderPath + "/" + filename;
+			auto file = wxFile(filepath, wxFile::read);
+			if (file.IsOpened()) {
+				auto fileLength = file.Length();
+				if (fileLength > 0) {
+					std::string fileContent;
+					fileContent.resize(static_cast<size_t>(fileLength));
+					file.Read(&fileContent[0], fileLength);
+
+					ZoneList file_zones;
+					ZoneFileParser parser(fileContent.data(), fileContent.size());
+					if (!parser.parse(file_zones)) {
+						file_zones.clear();
+						parseZoneFileToml(fileContent, file_zones, filepath);
+					}
+					std::move(file_zones.begin(), file_zones.end(), std::back_inserter(zones));
+				}
+				file.Close();
+			}
+			open_file = zoneDir.GetNext(&filename);
+		}
+
+		// Loading is the one place where zone ids are put on tiles in place
+		for (const auto& [zoneId, positions] : zones) {
+			for (const Position& pos : positions) {
+				Tile* tile = map.getTile(pos);
+				if (tile) {
+					tile->addZoneId(zoneId);
+					map.zones.add(zoneId, pos);
+				}
+			}
+		}
 	}
 }
 
-void IOMapOTBM::saveZonesToToml(const std::map<uint16_t, std::vector<Position>>& zoneMap, const wxFileName& dir, Map& map) {
+void IOMapOTBM::saveZonesToToml(const wxFileName& dir, Map& map) {
 	auto mapName = removeOTBMExtension(map.getName());
 	auto folderPath = dir.GetPath(wxPATH_GET_SEPARATOR | wxPATH_GET_VOLUME) + mapName + "-zones";
 
+	const std::vector<uint16_t> zoneIds = map.zones.getZoneIds();
+	if (zoneIds.empty() && not wxDirExists(folderPath)) {
+		return;
+	}
+
 	if (not wxDirExists(folderPath)) {
 		wxMkDir(folderPath);
 	}
@@ -108,18 +338,13 @@ void IOMapOTBM::saveZonesToToml(const std::map<uint16_t, std::vector<Position>>&
 	wxArrayString existingFiles;
 	wxDir::GetAllFiles(folderPath, &existingFiles, "*.toml", wxDIR_FILES);
 
-	std::set<uint16_t> zoneIdsToSave;
-	for (const auto& [zoneId, _] : zoneMap) {
-		zoneIdsToSave.insert(zoneId);
-	}
-
 	for (const auto& filePath : existingFiles) {
 		auto fileName = wxFileName(filePath);
 		auto baseName = fileName.GetName();
 
 		unsigned long zoneId;
 		if (baseName.ToULong(&zoneId)) {
-			if (zoneIdsToSave.find(static_cast<uint16_t>(zoneId)) == zoneIdsToSave.end()) {
+			if (!std::binary_search(zoneIds.begin(), zoneIds.end(), static_cast<uint16_t>(zoneId))) {
 				if (!wxRemoveFile(filePath)) {
 					wxLogError("Failed to delete zone file: %s", filePath);
 				}
@@ -127,98 +352,21 @@ void IOMapOTBM::saveZonesToToml(const std::map<uint16_t, std::vector<Position>>&
 		}
 	}
 
-	for (const auto& [zoneId, positions] : zoneMap) {
-		auto zoneTable = serializeZoneToToml(zoneId, positions);
-		auto filepath = folderPath + wxString::Format("/%u.toml", zoneId);
-		std::stringstream ss;
-		ss << zoneTable;
-		auto file = wxFile(filepath, wxFile::write);
-		if (file.IsOpened()) {
-			auto zoneData = ss.str();
-			file.Write(zoneData.c_str(), zoneData.length());
-			file.Close();
-		}
-		else {
-			wxLogError("Failed to open file for writing: %s", filepath);
-		}
+	// Every zone has its own file, they are written side by side
+	std::vector<wxString> paths;
+	for (uint16_t zoneId : zoneIds) {
+		paths.push_back(folderPath + wxString::Format("/%u.toml", zoneId));
 	}
-}
+	std::vector<uint8_t> written(zoneIds.size(), 0);
 
-std::map<uint16_t, std::vector<Position>> loadZonesFromToml(wxString folderPath) {
-	std::map<uint16_t, std::vector<Position>> zoneMap;
+	WorkerPool pool;
+	pool.run(zoneIds.size(), [&](size_t index) {
+		written[index] = writeZoneFile(map.zones, zoneIds[index], paths[index]);
+	});
 
-	if (not wxDirExists(folderPath)) {
-		return zoneMap;
-	}
-	auto zoneDir = wxDir(folderPath);
-	if (not zoneDir.IsOpened()) {
-		return zoneMap;
-	}
-	wxString filename;
-	bool open_file = zoneDir.GetFirst(&filename, "*.toml", wxDIR_FILES);
-	while (open_file) {
-		wxString filepath = folderPath + "/" + filename;
-		auto file = wxFile(filepath, wxFile::read);
-		if (file.IsOpened()) {
-			auto fileLength = file.Length();
-			if (fileLength > 0) {
-				std::string fileContent;
-				fileContent.resize(static_cast<size_t>(fileLength));
-				file.Read(&fileContent[0], fileLength);
-				try {
-					toml::table tbl = toml::parse(fileContent);
-					auto zonesArray = tbl["zone"];
-					if (zonesArray && zonesArray.is_array()) {
-						for (const auto& zoneEntry : *zonesArray.as_array()) {
-							if (zoneEntry.is_table()) {
-								const toml::table& zoneTable = *zoneEntry.as_table();
-								auto idVal = zoneTable["id"];
-								auto posArray = zoneTable["positions"];
-								if (idVal && idVal.is_integer() && posArray && posArray.is_array()) {
-									uint16_t zoneId = static_cast<uint16_t>(idVal.value_or(0));
-									std::vector<Position> positions;
-									for (const auto& pos : *posArray.as_array()) {
-										if (pos.is_table()) {
-											const toml::table& posTable = *pos.as_table();
-											uint16_t x = static_cast<uint16_t>(posTable["x"].value_or(0));
-											uint16_t y = static_cast<uint16_t>(posTable["y"].value_or(0));
-											uint8_t z = static_cast<uint8_t>(posTable["z"].value_or(0));
-											positions.emplace_back(Position{ x, y, z });
-										}
-									}
-									zoneMap[zoneId] = std::move(positions);
-								}
-							}
-						}
-					}
-					else {
-						wxLogWarning("Invalid zone file: %s", filepath);
-					}
-				}
-				catch (const toml::parse_error& err) {
-					wxLogError("TOML parse error in file %s: %s", filepath, err.what());
-				}
-			}
-			file.Close();
-		}
-		open_file = zoneDir.GetNext(&filename);
-	}
-	return zoneMap;
-}
-
-void applyZonesToTiles(const std::map<uint16_t, std::vector<Position>>& zoneMap, BaseMap& map) {
-	if (not zoneMap.empty())
-	{
-		for (const auto& [zoneId, positions] : zoneMap)
-		{
-			for (const auto& pos : positions)
-			{
-				Tile* tile = map.getTile(pos);
-				if (tile)
-				{
-					tile->addZoneId(zoneId);
-				}
-			}
+	for (size_t i = 0; i < zoneIds.size(); ++i) {
+		if (!written[i]) {
+			wxLogError("Failed to write zone file: %s", paths[i]);
 		}
 	}
 }
@@ -567,6 +715,22 @@ bool Container::serializeItemNode_OTBM(const IOMap& maphandle, NodeFileWriteHand
 
 bool IOMapOTBM::getVersionInfo(const FileName& filename, MapVersion& out_ver)
 {
+#if OTGZ_SUPPORT > 0
+	if(filename.GetExt() == "otgz") {
+		// Only the start of the archive, up to the root node, is decompressed
+		OTGZReader archive(nstr(filename.GetFullPath()));
+		std::string name;
+		uint64_t size;
+		while(archive.nextFile(name, size)) {
+			if(name == "world/map.otbm") {
+				OTGZNodeFileReadHandle f(archive, size, StringVector(1, "OTBM"));
+				return f.isOk() && getVersionInfo(&f, out_ver);
+			}
+		}
+		return false;
+	}
+#endif
+
 	// Just open a disk-based read handle
 	DiskNodeFileReadHandle f(nstr(filename.GetFullPath()), StringVector(1, "OTBM"));
 	if(!f.isOk())
@@ -603,15 +767,85 @@ bool IOMapOTBM::getVersionInfo(NodeFileReadHandle* f,  MapVersion& out_ver)
 
 bool IOMapOTBM::loadMap(Map& map, const FileName& filename)
 {
-	DiskNodeFileReadHandle f(nstr(filename.GetFullPath()), StringVector(1, "OTBM"));
+#if OTGZ_SUPPORT > 0
+	if(filename.GetExt() == "otgz") {
+		OTGZReader archive(nstr(filename.GetFullPath()));
+		if(!archive.isOk()) {
+			error("Couldn't open file for reading");
+			return false;
+		}
+
+		// The map is decoded while the archive is being decompressed, the xml
+		// files are kept until the map has been read as they refer to its towns
+		pugi::xml_document spawnDoc;
+		pugi::xml_document houseDoc;
+		bool has_map = false;
+		bool has_spawns = false;
+		bool has_houses = false;
+
+		std::string name;
+		uint64_t size;
+		while(archive.nextFile(name, size)) {
+			if(name == "world/map.otbm" && !has_map) {
+				OTGZNodeFileReadHandle f(archive, size, StringVector(1, "OTBM"));
+				if(!f.isOk()) {
+					error(("Couldn't read the map from the archive\nThe error reported was: " + wxstr(f.getErrorMessage())).wc_str());
+					return false;
+				}
+				if(!loadMap(map, f))
+					return false;
+				has_map = true;
+			} else if(name == "world/spawns.xml" || name == "world/houses.xml") {
+				std::string data;
+				if(!archive.readAll(data))
+					break;
+
+				if(name == "world/spawns.xml") {
+					has_spawns = bool(spawnDoc.load_buffer(data.data(), data.size()));
+				} else {
+					has_houses = bool(houseDoc.load_buffer(data.data(), data.size()));
+				}
+			}
+		}
+
+		if(!has_map) {
+			error("The archive does not contain a map (world/map.otbm)");
+			return false;
+		}
+		if(!archive.isOk()) {
+			warning("The archive is damaged, the map may be incomplete.");
+		}
+
+		// Archives are always saved from scratch
+		map.saved_areas.clear();
+
+		if(!has_houses || !loadHouses(map, houseDoc)) {
+			warning("Failed to load houses.");
+			map.housefile = nstr(filename.GetName()) + "-house.xml";
+		}
+		if(!has_spawns || !loadSpawns(map, spawnDoc)) {
+			warning("Failed to load spawns.");
+			map.spawnfile = nstr(filename.GetName()) + "-spawn.xml";
+		}
+		return true;
+	}
+#endif
+
+	// Tile data is read straight out of the mapping instead of being copied per node
+	MappedNodeFileReadHandle f(nstr(filename.GetFullPath()), StringVector(1, "OTBM"));
 	if(!f.isOk()) {
 		error(("Couldn't open file for reading\nThe error reported was: " + wxstr(f.getErrorMessage())).wc_str());
 		return false;
 	}
 
+	file_areas.clear();
 	if(!loadMap(map, f))
 		return false;
 
+	// Changes made from here on (houses without a town...) mark their areas dirty
+	file_areas.setSource(nstr(filename.GetFullPath()), version);
+	map.saved_areas = std::move(file_areas);
+
 	// Read auxilliary files
 	if(!loadHouses(map, filename)) {
 		warning("Failed to load houses.");
@@ -626,12 +860,123 @@ bool IOMapOTBM::loadMap(Map& map, const FileName& filename)
 
 	auto zoneDir = filename.GetPath(wxPATH_GET_SEPARATOR | wxPATH_GET_VOLUME) + mapName + "-zones";
 
-	auto zoneMap = loadZonesFromToml(zoneDir);
-	applyZonesToTiles(zoneMap, map);
+	loadZonesFromToml(zoneDir, map);
 
 	return true;
 }
 
+// Tiles of one OTBM_TILE_AREA node, decoded without touching the map so
+// that several areas can be decoded at the same time.
+struct DecodedTile
+{
+	Position position;
+	Tile* tile;
+	uint32_t house_id;
+};
+
+struct TileAreaBatch
+{
+	std::vector<DecodedTile> tiles;
+	wxArrayString warnings;
+	// The raw node, if it was located in a contiguous handle
+	const uint8_t* data = nullptr;
+	size_t length = 0;
+	uint64_t key = OTBMAreaIndex::HASH_SEED;
+};
+
+static void decodeTileArea(const IOMap& maphandle, MapAllocator& allocator, BinaryNode* mapNode, TileAreaBatch& batch)
+{
+	uint16_t base_x, base_y;
+	uint8_t base_z;
+	if(!mapNode->getU16(base_x) || !mapNode->getU16(base_y) || !mapNode->getU8(base_z)) {
+		batch.warnings.push_back("Invalid map node, no base coordinate");
+		return;
+	}
+
+	for(BinaryNode* tileNode = mapNode->getChild(); tileNode != nullptr; tileNode = tileNode->advance()) {
+		uint8_t tile_type;
+		if(!tileNode->getByte(tile_type)) {
+			batch.warnings.push_back("Invalid tile type");
+			continue;
+		}
+		if(tile_type != OTBM_TILE && tile_type != OTBM_HOUSETILE) {
+			batch.warnings.push_back("Unknown type of tile node");
+			continue;
+		}
+
+		uint8_t x_offset, y_offset;
+		if(!tileNode->getU8(x_offset) || !tileNode->getU8(y_offset)) {
+			batch.warnings.push_back("Could not read position of tile");
+			continue;
+		}
+		const Position pos(base_x + x_offset, base_y + y_offset, base_z);
+
+		uint32_t house_id = 0;
+		if(tile_type == OTBM_HOUSETILE) {
+			if(!tileNode->getU32(house_id)) {
+				batch.warnings.push_back("House tile without house data, discarding tile");
+				continue;
+			}
+			if(!house_id) {
+				batch.warnings.push_back(wxString::Format("Invalid house id from tile %d:%d:%d", pos.x, pos.y, pos.z));
+			}
+		}
+
+		// The location is assigned once the tile is merged into the map
+		Tile* tile = allocator.allocateTile(pos.x, pos.y, pos.z);
+
+		uint8_t attribute;
+		while(tileNode->getU8(attribute)) {
+			switch(attribute) {
+				case OTBM_ATTR_TILE_FLAGS: {
+					uint32_t flags = 0;
+					if(!tileNode->getU32(flags)) {
+						batch.warnings.push_back(wxString::Format("Invalid tile flags of tile on %d:%d:%d", pos.x, pos.y, pos.z));
+					}
+
+					tile->setMapFlags(flags);
+					break;
+				}
+				case OTBM_ATTR_ITEM: {
+					Item* item = Item::Create_OTBM(maphandle, tileNode);
+					if(item == nullptr) {
+						batch.warnings.push_back(wxString::Format("Invalid item at tile %d:%d:%d", pos.x, pos.y, pos.z));
+					}
+					tile->addItem(item);
+					break;
+				}
+				default: {
+					batch.warnings.push_back(wxString::Format("Unknown tile attribute at %d:%d:%d", pos.x, pos.y, pos.z));
+					break;
+				}
+			}
+		}
+
+		for(BinaryNode* itemNode = tileNode->getChild(); itemNode != nullptr; itemNode = itemNode->advance()) {
+			uint8_t item_type;
+			if(!itemNode->getByte(item_type)) {
+				batch.warnings.push_back(wxString::Format("Unknown item type %d:%d:%d", pos.x, pos.y, pos.z));
+				continue;
+			}
+			if(item_type == OTBM_ITEM) {
+				Item* item = Item::Create_OTBM(maphandle, itemNode);
+				if(item) {
+					if(!item->unserializeItemNode_OTBM(maphandle, itemNode)) {
+						batch.warnings.push_back(wxString::Format("Couldn't unserialize item attributes at %d:%d:%d", pos.x, pos.y, pos.z));
+					}
+					tile->addItem(item);
+				}
+			} else {
+				batch.warnings.push_back("Unknown type of tile child node");
+			}
+		}
+
+		tile->update();
+		batch.tiles.push_back({pos, tile, house_id});
+		batch.key = OTBMAreaIndex::hashPosition(batch.key, pos.x, pos.y, pos.z);
+	}
+}
+
 bool IOMapOTBM::loadMap(Map& map, NodeFileReadHandle& f)
 {
 	BinaryNode* root = f.getRootNode();
@@ -724,11 +1069,84 @@ bool IOMapOTBM::loadMap(Map& map, NodeFileReadHandle& f)
 		}
 	}
 
+	// Tile areas are independent of each other, so on contiguous handles they are only
+	// located while walking the file and decoded on the worker threads afterwards.
+	const bool parallel = f.isContiguous();
+	std::vector<std::pair<const uint8_t*, size_t>> pending_areas;
+
+	auto mergeTileArea = [&](TileAreaBatch& batch) {
+		for(const wxString& message : batch.warnings) {
+			warnings.push_back(message);
+		}
+
+		// Only areas that load exactly as they are stored may be copied when saving
+		bool exact = batch.data && batch.warnings.empty() && !batch.tiles.empty();
+
+		for(DecodedTile& decoded : batch.tiles) {
+			const Position& pos = decoded.position;
+			Tile* tile = decoded.tile;
+			if(map.getTile(pos)) {
+				warning("Duplicate tile at %d:%d:%d, discarding duplicate", pos.x, pos.y, pos.z);
+				delete tile;
+				exact = false;
+				continue;
+			}
+
+			tile->setLocation(map.createTileL(pos));
+			if(decoded.house_id) {
+				House* house = map.houses.getHouse(decoded.house_id);
+				if(!house) {
+					house = newd House(map);
+					house->id = decoded.house_id;
+					map.houses.addHouse(house);
+				}
+				house->addTile(tile);
+			}
+
+			map.setTile(pos.x, pos.y, pos.z, tile);
+		}
+
+		if(exact) {
+			file_areas.addArea(batch.key, batch.data - f.getData(), batch.length, static_cast<uint32_t>(batch.tiles.size()));
+		}
+		batch.tiles.clear();
+	};
+
+	auto flushTileAreas = [&]() {
+		if(pending_areas.empty())
+			return;
+
+		std::vector<TileAreaBatch> batches(pending_areas.size());
+		// Not the "worker threads" preference, which is 1 unless the user raised it
+		WorkerPool pool(WorkerPool::getHardwareThreadCount());
+		pool.runOrdered(pending_areas.size(),
+			[&](size_t index) {
+				batches[index].data = pending_areas[index].first;
+				batches[index].length = pending_areas[index].second;
+
+				MemoryNodeFileReadHandle area(pending_areas[index].first, pending_areas[index].second);
+				BinaryNode* areaNode = area.getRootNode();
+				if(!areaNode || !areaNode->skip(1)) { // Skip the type byte
+					batches[index].warnings.push_back("Invalid map node");
+					return;
+				}
+				decodeTileArea(*this, map.allocator, areaNode, batches[index]);
+			},
+			[&](size_t index) {
+				mergeTileArea(batches[index]);
+				if(index % 15 == 0) {
+					g_gui.SetLoadDone(static_cast<int32_t>(100.0 * (index + 1) / pending_areas.size()));
+				}
+			}
+		);
+		pending_areas.clear();
+	};
+
 	int nodes_loaded = 0;
 
 	for(BinaryNode* mapNode = mapHeaderNode->getChild(); mapNode != nullptr; mapNode = mapNode->advance()) {
 		++nodes_loaded;
-		if(nodes_loaded % 15 == 0) {
+		if(!parallel && nodes_loaded % 15 == 0) {
 			g_gui.SetLoadDone(static_cast<int32_t>(100.0 * f.tell() / f.size()));
 		}
 
@@ -738,113 +1156,23 @@ bool IOMapOTBM::loadMap(Map& map, NodeFileReadHandle& f)
 			continue;
 		}
 		if(node_type == OTBM_TILE_AREA) {
-			uint16_t base_x, base_y;
-			uint8_t base_z;
-			if(!mapNode->getU16(base_x) || !mapNode->getU16(base_y) || !mapNode->getU8(base_z)) {
-				warning("Invalid map node, no base coordinate");
+			const uint8_t* area_data;
+			size_t area_size;
+			if(parallel && mapNode->skipRaw(area_data, area_size)) {
+				pending_areas.emplace_back(area_data, area_size);
 				continue;
 			}
 
-			for(BinaryNode* tileNode = mapNode->getChild(); tileNode != nullptr; tileNode = tileNode->advance()) {
-				Tile* tile = nullptr;
-				uint8_t tile_type;
-				if(!tileNode->getByte(tile_type)) {
-					warning("Invalid tile type");
-					continue;
-				}
-				if(tile_type == OTBM_TILE || tile_type == OTBM_HOUSETILE) {
-					//printf("Start\n");
-					uint8_t x_offset, y_offset;
-					if(!tileNode->getU8(x_offset) || !tileNode->getU8(y_offset)) {
-						warning("Could not read position of tile");
-						continue;
-					}
-					const Position pos(base_x + x_offset, base_y + y_offset, base_z);
-
-					if(map.getTile(pos)) {
-						warning("Duplicate tile at %d:%d:%d, discarding duplicate", pos.x, pos.y, pos.z);
-						continue;
-					}
-
-					tile = map.allocator(map.createTileL(pos));
-					House* house = nullptr;
-					if(tile_type == OTBM_HOUSETILE) {
-						uint32_t house_id;
-						if(!tileNode->getU32(house_id)) {
-							warning("House tile without house data, discarding tile");
-							continue;
-						}
-						if(house_id) {
-							house = map.houses.getHouse(house_id);
-							if(!house) {
-								house = newd House(map);
-								house->id = house_id;
-								map.houses.addHouse(house);
-							}
-						} else {
-							warning("Invalid house id from tile %d:%d:%d", pos.x, pos.y, pos.z);
-						}
-					}
-
-					uint8_t attribute;
-					while(tileNode->getU8(attribute)) {
-						switch(attribute) {
-							case OTBM_ATTR_TILE_FLAGS: {
-								uint32_t flags = 0;
-								if(!tileNode->getU32(flags)) {
-									warning("Invalid tile flags of tile on %d:%d:%d", pos.x, pos.y, pos.z);
-								}
-
-								tile->setMapFlags(flags);
-								break;
-							}
-							case OTBM_ATTR_ITEM: {
-								Item* item = Item::Create_OTBM(*this, tileNode);
-								if(item == nullptr)
-								{
-									warning("Invalid item at tile %d:%d:%d", pos.x, pos.y, pos.z);
-								}
-								tile->addItem(item);
-								break;
-							}
-							default: {
-								warning("Unknown tile attribute at %d:%d:%d", pos.x, pos.y, pos.z);
-								break;
-							}
-						}
-					}
-
-					for(BinaryNode* itemNode = tileNode->getChild(); itemNode != nullptr; itemNode = itemNode->advance()) {
-						Item* item = nullptr;
-						uint8_t item_type;
-						if(!itemNode->getByte(item_type)) {
-							warning("Unknown item type %d:%d:%d", pos.x, pos.y, pos.z);
-							continue;
-						}
-						if(item_type == OTBM_ITEM) {
-							item = Item::Create_OTBM(*this, itemNode);
-							if(item) {
-								if(!item->unserializeItemNode_OTBM(*this, itemNode)) {
-									warning("Couldn't unserialize item attributes at %d:%d:%d", pos.x, pos.y, pos.z);
-								}
-								//reform(&map, tile, item);
-								tile->addItem(item);
-							}
-						} else {
-							warning("Unknown type of tile child node");
-						}
-					}
+			TileAreaBatch batch;
+			decodeTileArea(*this, map.allocator, mapNode, batch);
+			mergeTileArea(batch);
+			continue;
+		}
 
-					tile->update();
-					if(house)
-						house->addTile(tile);
+		// Anything else may depend on the tiles read so far (waypoints create tiles)
+		flushTileAreas();
 
-					map.setTile(pos.x, pos.y, pos.z, tile);
-				} else {
-					warning("Unknown type of tile node");
-				}
-			}
-		} else if(node_type == OTBM_TOWNS) {
+		if(node_type == OTBM_TOWNS) {
 			for(BinaryNode* townNode = mapNode->getChild(); townNode != nullptr; townNode = townNode->advance()) {
 				Town* town = nullptr;
 				uint8_t town_type;
@@ -925,6 +1253,7 @@ bool IOMapOTBM::loadMap(Map& map, NodeFileReadHandle& f)
 			}
 		}
 	}
+	flushTileAreas();
 
 	if(!f.isOk())
 		warning(wxstr(f.getErrorMessage()).wc_str());
@@ -1067,7 +1396,7 @@ bool IOMapOTBM::loadSpawns(Map& map, pugi::xml_document& doc)
 			creature->setSpawnTime(spawntime);
 			creatureTile->creature = creature;
 
-			if(creatureTile->getLocation()->getSpawnCount() == 0) {
+			if(map.spawns.getSpawnCount(creatureTile->getPosition()) == 0) {
 				// No spawn, create a newd one
 				ASSERT(creatureTile->spawn == nullptr);
 				Spawn* spawn = newd Spawn(5);
@@ -1154,36 +1483,19 @@ bool IOMapOTBM::saveMap(Map& map, const FileName& identifier)
 {
 #if OTGZ_SUPPORT > 0
 	if(identifier.GetExt() == "otgz") {
-		// Create the archive
-		struct archive* a = archive_write_new();
-		struct archive_entry* entry = nullptr;
-		std::ostringstream streamData;
-
-		archive_write_set_compression_gzip(a);
-		archive_write_set_format_pax_restricted(a);
-		archive_write_open_filename(a, nstr(identifier.GetFullPath()).c_str());
+		OTGZWriter archive(nstr(identifier.GetFullPath()));
+		if(!archive.isOk()) {
+			error("Can not open file %s for writing", nstr(identifier.GetFullPath()).c_str());
+			return false;
+		}
 
 		g_gui.SetLoadDone(0, "Saving spawns...");
 
+		std::ostringstream streamData;
 		pugi::xml_document spawnDoc;
 		if(saveSpawns(map, spawnDoc)) {
-			// Write the data
 			spawnDoc.save(streamData, "", pugi::format_raw, pugi::encoding_utf8);
-			std::string xmlData = streamData.str();
-
-			// Write to the arhive
-			entry = archive_entry_new();
-			archive_entry_set_pathname(entry, "world/spawns.xml");
-			archive_entry_set_size(entry, xmlData.size());
-			archive_entry_set_filetype(entry, AE_IFREG);
-			archive_entry_set_perm(entry, 0644);
-
-			// Write to the archive
-			archive_write_header(a, entry);
-			archive_write_data(a, xmlData.data(), xmlData.size());
-
-			// Free the entry
-			archive_entry_free(entry);
+			archive.addFile("world/spawns.xml", streamData.str());
 			streamData.str("");
 		}
 
@@ -1191,82 +1503,167 @@ bool IOMapOTBM::saveMap(Map& map, const FileName& identifier)
 
 		pugi::xml_document houseDoc;
 		if(saveHouses(map, houseDoc)) {
-			// Write the data
 			houseDoc.save(streamData, "", pugi::format_raw, pugi::encoding_utf8);
-			std::string xmlData = streamData.str();
-
-			// Write to the arhive
-			entry = archive_entry_new();
-			archive_entry_set_pathname(entry, "world/houses.xml");
-			archive_entry_set_size(entry, xmlData.size());
-			archive_entry_set_filetype(entry, AE_IFREG);
-			archive_entry_set_perm(entry, 0644);
-
-			// Write to the archive
-			archive_write_header(a, entry);
-			archive_write_data(a, xmlData.data(), xmlData.size());
-
-			// Free the entry
-			archive_entry_free(entry);
+			archive.addFile("world/houses.xml", streamData.str());
 			streamData.str("");
 		}
 
 		g_gui.SetLoadDone(0, "Saving OTBM map...");
 
-		MemoryNodeFileWriteHandle otbmWriter;
-		saveMap(map, otbmWriter);
-
-		g_gui.SetLoadDone(75, "Compressing...");
-
-		// Create an archive entry for the otbm file
-		entry = archive_entry_new();
-		archive_entry_set_pathname(entry, "world/map.otbm");
-		archive_entry_set_size(entry, otbmWriter.getSize() + 4); // 4 bytes extra for header
-		archive_entry_set_filetype(entry, AE_IFREG);
-		archive_entry_set_perm(entry, 0644);
-		archive_write_header(a, entry);
-
-		// Write the version header
-		char otbm_identifier[] = "OTBM";
-		archive_write_data(a, otbm_identifier, 4);
-
-		// Write the OTBM data
-		archive_write_data(a, otbmWriter.getMemory(), otbmWriter.getSize());
-		archive_entry_free(entry);
+		// The nodes are compressed as they are serialized
+		archive.beginFile("world/map.otbm");
+		{
+			OTGZNodeFileWriteHandle f(archive, "OTBM");
+			saveMap(map, f);
+			f.close();
+		}
+		// Archives are always written from scratch
+		map.saved_areas.clear();
 
-		// Free / close the archive
-		archive_write_close(a);
-		archive_write_free(a);
+		const bool ok = archive.endFile() && archive.finish();
 
 		g_gui.DestroyLoadBar();
-		return true;
+		if(!ok) {
+			error("Could not write file %s", nstr(identifier.GetFullPath()).c_str());
+		}
+		return ok;
 	}
 #endif
 
+	const std::string filename = nstr(identifier.GetFullPath());
+
+	// The previous file has to be mapped before the target is opened, they must not be the same file
+	if(!incremental_source.empty() && FileName(wxstr(incremental_source)) != identifier
+		&& map.saved_areas.isSource(filename, incremental_source, map.getVersion()))
+	{
+		previous_file = std::make_unique<MappedNodeFileReadHandle>(incremental_source, StringVector(1, "OTBM"));
+		if(!previous_file->isOk()) {
+			previous_file.reset();
+		}
+	}
+
 	DiskNodeFileWriteHandle f(
-		nstr(identifier.GetFullPath()),
+		filename,
 		(g_settings.getInteger(Config::SAVE_WITH_OTB_MAGIC_NUMBER) ? "OTBM" : std::string(4, '\0'))
 		);
 
 	if(!f.isOk()) {
-		error("Can not open file %s for writing", (const char*)identifier.GetFullPath().mb_str(wxConvUTF8));
+		previous_file.reset();
+		error("Can not open file %s for writing", filename.c_str());
 		return false;
 	}
 
-	if(!saveMap(map, f))
+	file_areas.clear();
+	const bool saved = saveMap(map, f);
+	previous_file.reset();
+	if(!saved)
 		return false;
 
+	// The areas just written are what the next save can copy from
+	const bool written = f.isOk();
+	f.close();
+	if(written) {
+		file_areas.setSource(filename, map.getVersion());
+		map.saved_areas = std::move(file_areas);
+	} else {
+		map.saved_areas.clear();
+	}
+
 	g_gui.SetLoadDone(99, "Saving spawns...");
 	saveSpawns(map, identifier);
 
 	g_gui.SetLoadDone(99, "Saving houses...");
 	saveHouses(map, identifier);
 
-	saveZonesToToml(zoneMap, identifier, map);
+	saveZonesToToml(identifier, map);
 
 	return true;
 }
 
+// A run of tiles that goes into one OTBM_TILE_AREA node, 'steps' counts the
+// iterator steps it covers including the empty tile locations in between.
+struct SaveTileArea
+{
+	MapIterator begin;
+	size_t steps;
+	uint64_t key; // See OTBMAreaIndex
+	uint32_t tiles;
+	bool dirty;
+	// Node in the previous file that holds exactly these tiles, unchanged
+	const OTBMAreaIndex::Area* previous;
+};
+
+static void serializeTile(const IOMapOTBM& self, const Tile* save_tile, NodeFileWriteHandle& f)
+{
+	f.addNode(save_tile->isHouseTile()? OTBM_HOUSETILE : OTBM_TILE);
+
+	f.addU8(save_tile->getX() & 0xFF);
+	f.addU8(save_tile->getY() & 0xFF);
+
+	if(save_tile->isHouseTile()) {
+		f.addU32(save_tile->getHouseID());
+	}
+
+	if(save_tile->getMapFlags()) {
+		f.addByte(OTBM_ATTR_TILE_FLAGS);
+		f.addU32(save_tile->getMapFlags());
+	}
+
+	if(save_tile->ground) {
+		Item* ground = save_tile->ground;
+		if(ground->isMetaItem()) {
+			// Do nothing, we don't save metaitems...
+		} else if(ground->hasBorderEquivalent()) {
+			bool found = false;
+			for(Item* item : save_tile->items) {
+				if(item->getGroundEquivalent() == ground->getID()) {
+					// Do nothing
+					// Found equivalent
+					found = true;
+					break;
+				}
+			}
+
+			if(!found) {
+				ground->serializeItemNode_OTBM(self, f);
+			}
+		} else if(ground->isComplex()) {
+			ground->serializeItemNode_OTBM(self, f);
+		} else {
+			f.addByte(OTBM_ATTR_ITEM);
+			ground->serializeItemCompact_OTBM(self, f);
+		}
+	}
+
+	for(Item* item : save_tile->items) {
+		if(!item->isMetaItem()) {
+			item->serializeItemNode_OTBM(self, f);
+		}
+	}
+
+	f.endNode();
+}
+
+static void serializeTileArea(const IOMapOTBM& self, const Map& map, const SaveTileArea& area, NodeFileWriteHandle& f)
+{
+	MapIterator map_iterator = area.begin;
+	const Position& base = (*map_iterator)->getPosition();
+
+	f.addNode(OTBM_TILE_AREA);
+	f.addU16(base.x & 0xFF00);
+	f.addU16(base.y & 0xFF00);
+	f.addU8(base.z);
+
+	for(size_t step = 0; step < area.steps; ++step, ++map_iterator) {
+		const Tile* save_tile = (*map_iterator)->get();
+		if(save_tile && map.getTileSize(save_tile) != 0) {
+			serializeTile(self, save_tile, f);
+		}
+	}
+
+	f.endNode();
+}
+
 bool IOMapOTBM::saveMap(Map& map, NodeFileWriteHandle& f)
 {
 	/* STOP!
@@ -1312,25 +1709,20 @@ bool IOMapOTBM::saveMap(Map& map, NodeFileWriteHandle& f)
 			f.addU8(OTBM_ATTR_EXT_HOUSE_FILE);
 			f.addString(nstr(tmpName.GetFullName()));
 
-			// Start writing tiles
-			uint32_t tiles_saved = 0;
-			bool first = true;
-
+			// Tile areas are cut exactly where the single-threaded writer used to cut them,
+			// serialized into their own buffers on the worker threads and written out in order,
+			// so the file is the same no matter how many threads were used.
+			std::vector<SaveTileArea> areas;
 			int local_x = -1, local_y = -1, local_z = -1;
 
-			MapIterator map_iterator = map.begin();
-			while(map_iterator != map.end()) {
-				// Update progressbar
-				++tiles_saved;
-				if(tiles_saved % 8192 == 0)
-					g_gui.SetLoadDone(int(tiles_saved / double(map.getTileCount()) * 100.0));
-
-				// Get tile
+			for(MapIterator map_iterator = map.begin(); map_iterator != map.end(); ++map_iterator) {
 				Tile* save_tile = (*map_iterator)->get();
 
 				// Is it an empty tile that we can skip? (Leftovers...)
-				if(!save_tile || save_tile->size() == 0) {
-					++map_iterator;
+				if(!save_tile || map.getTileSize(save_tile) == 0) {
+					if(!areas.empty()) {
+						++areas.back().steps;
+					}
 					continue;
 				}
 
@@ -1338,78 +1730,86 @@ bool IOMapOTBM::saveMap(Map& map, NodeFileWriteHandle& f)
 
 				// Decide if newd node should be created
 				if(pos.x < local_x || pos.x >= local_x + 256 || pos.y < local_y || pos.y >= local_y + 256 || pos.z != local_z) {
-					// End last node
-					if(!first) {
-						f.endNode();
-					}
-					first = false;
-
-					// Start newd node
-					f.addNode(OTBM_TILE_AREA);
-					f.addU16(local_x = pos.x & 0xFF00);
-					f.addU16(local_y = pos.y & 0xFF00);
-					f.addU8( local_z = pos.z);
+					local_x = pos.x & 0xFF00;
+					local_y = pos.y & 0xFF00;
+					local_z = pos.z;
+					areas.push_back({map_iterator, 0, OTBMAreaIndex::HASH_SEED, 0, false, nullptr});
 				}
-				f.addNode(save_tile->isHouseTile()? OTBM_HOUSETILE : OTBM_TILE);
 
-				f.addU8(save_tile->getX() & 0xFF);
-				f.addU8(save_tile->getY() & 0xFF);
+				SaveTileArea& area = areas.back();
+				++area.steps;
+				area.key = OTBMAreaIndex::hashPosition(area.key, pos.x, pos.y, pos.z);
+				++area.tiles;
+				area.dirty = area.dirty || map.saved_areas.isDirty(pos.x, pos.y, pos.z);
+			}
 
-				if(save_tile->isHouseTile()) {
-					f.addU32(save_tile->getHouseID());
-				}
+			// Areas without changes since the last load or save are copied from that file as they are
+			if(previous_file) {
+				const uint8_t* previous_data = previous_file->getData();
+				const uint64_t previous_size = previous_file->size();
+				for(SaveTileArea& area : areas) {
+					if(area.dirty)
+						continue;
 
-				if(save_tile->getMapFlags()) {
-					f.addByte(OTBM_ATTR_TILE_FLAGS);
-					f.addU32(save_tile->getMapFlags());
-					if (save_tile->getMapFlags() & TILESTATE_ZONE_BRUSH)
+					const OTBMAreaIndex::Area* previous = map.saved_areas.findArea(area.key, area.tiles);
+					if(previous && previous->length > 2 && previous->offset + previous->length <= previous_size
+						&& previous_data[previous->offset] == NODE_START
+						&& previous_data[previous->offset + 1] == OTBM_TILE_AREA
+						&& previous_data[previous->offset + previous->length - 1] == NODE_END)
 					{
-						for (const auto& zoneId : save_tile->getZoneIds())
-						{
-							zoneMap[zoneId].push_back(save_tile->getPosition());
-						}
+						area.previous = previous;
 					}
 				}
+			}
 
-				if(save_tile->ground) {
-					Item* ground = save_tile->ground;
-					if(ground->isMetaItem()) {
-						// Do nothing, we don't save metaitems...
-					} else if(ground->hasBorderEquivalent()) {
-						bool found = false;
-						for(Item* item : save_tile->items) {
-							if(item->getGroundEquivalent() == ground->getID()) {
-								// Do nothing
-								// Found equivalent
-								found = true;
-								break;
-							}
-						}
-
-						if(!found) {
-							ground->serializeItemNode_OTBM(self, f);
-						}
-					} else if(ground->isComplex()) {
-						ground->serializeItemNode_OTBM(self, f);
+			std::vector<std::unique_ptr<MemoryNodeFileWriteHandle>> buffers(areas.size());
+			uint64_t tiles_saved = 0;
+
+			// Copied areas are only known to be clean because no change was recorded in
+			// them, the self check serializes them anyway and compares the bytes
+			const bool self_check = previous_file && g_settings.getInteger(Config::INCREMENTAL_SAVE_SELF_CHECK);
+			std::atomic<size_t> stale_areas(0);
+
+			WorkerPool pool;
+			pool.runOrdered(areas.size(),
+				[&](size_t index) {
+					SaveTileArea& area = areas[index];
+					if(area.previous && !self_check)
+						return;
+
+					auto buffer = std::make_unique<MemoryNodeFileWriteHandle>();
+					serializeTileArea(self, map, area, *buffer);
+					if(area.previous) {
+						if(buffer->getSize() == area.previous->length
+							&& memcmp(buffer->getMemory(), previous_file->getData() + area.previous->offset, buffer->getSize()) == 0)
+							return;
+
+						// Changed without being marked dirty, the fresh bytes are written instead
+						area.previous = nullptr;
+						++stale_areas;
+					}
+					buffers[index] = std::move(buffer);
+				},
+				[&](size_t index) {
+					const SaveTileArea& area = areas[index];
+					const size_t offset = f.tell();
+					if(area.previous) {
+						f.addEncoded(previous_file->getData() + area.previous->offset, area.previous->length);
 					} else {
-						f.addByte(OTBM_ATTR_ITEM);
-						ground->serializeItemCompact_OTBM(self, f);
+						f.addEncoded(buffers[index]->getMemory(), buffers[index]->getSize());
+						buffers[index].reset();
 					}
-				}
+					file_areas.addArea(area.key, offset, f.tell() - offset, area.tiles);
 
-				for(Item* item : save_tile->items) {
-					if(!item->isMetaItem()) {
-						item->serializeItemNode_OTBM(self, f);
-					}
+					// Update progressbar
+					tiles_saved += areas[index].steps;
+					g_gui.SetLoadDone(int(tiles_saved / double(map.getTileCount()) * 100.0));
 				}
+			);
 
-				f.endNode();
-				++map_iterator;
-			}
-
-			// Only close the last node if one has actually been created
-			if(!first) {
-				f.endNode();
+			if(stale_areas > 0) {
+				wxLogWarning("%llu tile areas had changed without being marked as changed, they were saved again instead of being copied from the previous file.",
+					(unsigned long long)stale_areas.load());
 			}
 
 			f.addNode(OTBM_TOWNS);
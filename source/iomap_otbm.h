@@ -21,6 +21,8 @@
 #include <toml++/toml.hpp>
 
 #include "iomap.h"
+#include "filehandle.h"
+#include "otbm_area_index.h"
 
 // Pragma pack is VERY important since otherwise it won't be able to load the structs correctly
 #pragma pack(1)
@@ -124,13 +126,18 @@ public:
 	IOMapOTBM(MapVersion ver) { version = ver; }
 	~IOMapOTBM() {}
 
-	void saveZonesToToml(const std::map<uint16_t, std::vector<Position>>& zoneMap, const wxFileName& dir, Map& map);
+	void saveZonesToToml(const wxFileName& dir, Map& map);
 
 	static bool getVersionInfo(const FileName& identifier, MapVersion& out_ver);
 
 	virtual bool loadMap(Map& map, const FileName& identifier);
 	virtual bool saveMap(Map& map, const FileName& identifier);
 
+	// Lets saveMap copy the tile areas nobody has changed out of 'filename' instead of
+	// serializing them. It must be the file the map was last loaded from or saved to,
+	// possibly renamed; anything else is detected and the whole map is written.
+	void setIncrementalSource(const std::string& filename) { incremental_source = filename; }
+
 protected:
 	static bool getVersionInfo(NodeFileReadHandle* f,  MapVersion& out_ver);
 
@@ -146,6 +153,12 @@ protected:
 	bool saveHouses(Map& map, const FileName& dir);
 	bool saveHouses(Map& map, pugi::xml_document& doc);
 	//void saveZonesToToml(const toml::table& zonesToml, const wxFileName& dir);
+
+	std::string incremental_source;
+	// Opened by saveMap if incremental_source is still the file saved_areas describes
+	std::unique_ptr<MappedNodeFileReadHandle> previous_file;
+	// Tile areas of the file being loaded or saved
+	OTBMAreaIndex file_areas;
 };
 
 #endif
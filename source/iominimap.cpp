@@ -167,33 +167,21 @@ bool IOMinimap::exportMinimap(const std::string& directory)
 	int min_z = m_floor == -1 ? 0 : m_floor;
 	int max_z = m_floor == -1 ? rme::MapMaxLayer : m_floor;
 
+	// Bounds of the tiles of each floor, empty tiles included (they only make images that are left out)
+	const OccupancyMap& occupancy = map.getOccupancy();
 	for (size_t z = min_z; z <= max_z; z++) {
 		auto& rect = bounds[z];
-		rect.x = rme::MapMaxWidth + 1;
-		rect.y = rme::MapMaxHeight + 1;
-		rect.width = 0;
-		rect.height = 0;
-	}
-
-	for(auto it = map.begin(); it != map.end(); ++it) {
-		auto tile = (*it)->get();
-		if(!tile || (!tile->ground && tile->items.empty())) {
-			continue;
-		}
-
-		const auto& position = tile->getPosition();
-		auto& rect = bounds[position.z];
-		if(position.x < rect.x) {
-			rect.x = position.x;
-		}
-		if(position.y < rect.y) {
-			rect.y = position.y;
-		}
-		if (position.x > rect.width) {
-			rect.width = position.x;
-		}
-		if (position.y > rect.height) {
-			rect.height = position.y;
+		int min_x, min_y, max_x, max_y;
+		if (occupancy.getFloorBounds(OccupancyMap::TILES, z, min_x, min_y, max_x, max_y)) {
+			rect.x = min_x;
+			rect.y = min_y;
+			rect.width = max_x;
+			rect.height = max_y;
+		} else {
+			rect.x = rme::MapMaxWidth + 1;
+			rect.y = rme::MapMaxHeight + 1;
+			rect.width = 0;
+			rect.height = 0;
 		}
 	}
 
@@ -217,20 +205,25 @@ bool IOMinimap::exportMinimap(const std::string& directory)
 				bool empty = true;
 				memset(pixels, 0, pixels_size);
 
-				int index = 0;
 				for (int y = 0; y < image_size; y++) {
-					for (int x = 0; x < image_size; x++) {
-						auto tile = map.getTile(w + x, h + y, z);
-						if(!tile || (!tile->ground && tile->items.empty())) {
-							index += rme::PixelFormatRGB;
-							continue;
+					// The image starts on a multiple of 64, only the tiles of each word are looked up
+					for (int x = 0; x < image_size; x += OccupancyMap::BLOCK_SIZE) {
+						uint64_t tiles = occupancy.getWord(OccupancyMap::TILES, w + x, h + y, z);
+						while (tiles != 0) {
+							const int tile_x = x + std::countr_zero(tiles);
+							tiles &= tiles - 1;
+
+							auto tile = map.getTile(w + tile_x, h + y, z);
+							if(!tile || (!tile->ground && tile->items.empty())) {
+								continue;
+							}
+							const int index = (y * image_size + tile_x) * rme::PixelFormatRGB;
+							uint8_t color = tile->getMiniMapColor();
+							pixels[index  ] = (uint8_t)(static_cast<int>(color / 36) % 6 * 51); // red
+							pixels[index+1] = (uint8_t)(static_cast<int>(color / 6) % 6 * 51);  // green
+							pixels[index+2] = (uint8_t)(color % 6 * 51);                        // blue
+							empty = false;
 						}
-						uint8_t color = tile->getMiniMapColor();
-						pixels[index  ] = (uint8_t)(static_cast<int>(color / 36) % 6 * 51); // red
-						pixels[index+1] = (uint8_t)(static_cast<int>(color / 6) % 6 * 51);  // green
-						pixels[index+2] = (uint8_t)(color % 6 * 51);                        // blue
-						index += rme::PixelFormatRGB;
-						empty = false;
 					}
 				}
 
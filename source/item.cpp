@@ -24,6 +24,7 @@
 #include "complexitem.h"
 #include "iomap.h"
 #include "item.h"
+#include "map_allocator.h"
 
 #include "ground_brush.h"
 #include "carpet_brush.h"
@@ -77,13 +78,28 @@ Item::~Item()
 	////
 }
 
+void* Item::operator new(size_t size)
+{
+	if(size == sizeof(Item))
+		return MapAllocator::getItemPool().allocate();
+	return ::operator new(size);
+}
+
+void Item::operator delete(void* pointer, size_t size)
+{
+	if(size == sizeof(Item))
+		SlabPool::release(pointer);
+	else
+		::operator delete(pointer);
+}
+
 Item* Item::deepCopy() const
 {
 	Item* copy = Create(id, subtype);
 	if(copy) {
 		copy->selected = selected;
 		if(attributes)
-			copy->attributes = newd ItemAttributeMap(*attributes);
+			copy->attributes = newd ItemAttributeList(*attributes);
 	}
 	return copy;
 }
@@ -270,22 +286,22 @@ double Item::getWeight() const
 
 void Item::setUniqueID(unsigned short n)
 {
-	setAttribute("uid", n);
+	setAttribute(ITEM_ATTRIBUTE_UNIQUE_ID, n);
 }
 
 void Item::setActionID(unsigned short n)
 {
-	setAttribute("aid", n);
+	setAttribute(ITEM_ATTRIBUTE_ACTION_ID, n);
 }
 
 void Item::setText(const std::string& str)
 {
-	setAttribute("text", str);
+	setAttribute(ITEM_ATTRIBUTE_TEXT, str);
 }
 
 void Item::setDescription(const std::string& str)
 {
-	setAttribute("desc", str);
+	setAttribute(ITEM_ATTRIBUTE_DESCRIPTION, str);
 }
 
 double Item::getWeight()
@@ -415,7 +431,7 @@ void Item::animate()
 	if(!sprite || !sprite->animator)
 		return;
 
-	frame = sprite->animator->getFrame();
+	frame = static_cast<uint8_t>(sprite->animator->getFrame());
 }
 
 // ============================================================================
@@ -93,6 +93,16 @@ protected:
 public:
 	virtual ~Item();
 
+	// Pooled allocation: objects the size of a plain Item come from a
+	// MapAllocator slab pool instead of the heap, bigger derived types (such as
+	// Container and Teleport) use the regular heap. Every item, attributes or
+	// not, is still a full Item object owned through a pointer.
+	static void* operator new(size_t size);
+	static void operator delete(void* pointer, size_t size);
+#ifdef DEBUG_MEM
+	static void* operator new(size_t size, const char*, int) { return operator new(size); }
+#endif
+
 // Deep copy thingy
 	virtual Item* deepCopy() const;
 
@@ -267,7 +277,7 @@ protected:
 	// Subtype is either fluid type, count, subtype or charges
 	uint16_t subtype;
 	bool selected;
-	int frame;
+	uint8_t frame; // Animation lengths are stored as a byte in the .dat
 
 private:
 	Item& operator=(const Item& i);// Can't copy
@@ -288,28 +298,28 @@ inline int Item::getCount() const {
 }
 
 inline uint16_t Item::getUniqueID() const {
-	const int32_t* a = getIntegerAttribute("uid");
+	const int32_t* a = getIntegerAttribute(ITEM_ATTRIBUTE_UNIQUE_ID);
 	if(a)
 		return *a;
 	return 0;
 }
 
 inline uint16_t Item::getActionID() const {
-	const int32_t* a = getIntegerAttribute("aid");
+	const int32_t* a = getIntegerAttribute(ITEM_ATTRIBUTE_ACTION_ID);
 	if(a)
 		return *a;
 	return 0;
 }
 
 inline std::string Item::getText() const {
-	const std::string* a = getStringAttribute("text");
+	const std::string* a = getStringAttribute(ITEM_ATTRIBUTE_TEXT);
 	if(a)
 		return *a;
 	return "";
 }
 
 inline std::string Item::getDescription() const {
-	const std::string* a = getStringAttribute("desc");
+	const std::string* a = getStringAttribute(ITEM_ATTRIBUTE_DESCRIPTION);
 	if(a)
 		return *a;
 	return "";
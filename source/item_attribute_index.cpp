@@ -0,0 +1,170 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "item_attribute_index.h"
+#include "map.h"
+
+bool ItemAttributeIndex::Entry::operator<(const Entry& other) const noexcept
+{
+	if(attribute != other.attribute)
+		return attribute < other.attribute;
+	if(value != other.value)
+		return value < other.value;
+	return position < other.position;
+}
+
+bool ItemAttributeIndex::Entry::operator==(const Entry& other) const noexcept
+{
+	return attribute == other.attribute && value == other.value && position == other.position;
+}
+
+ItemAttributeIndex::ItemAttributeIndex() :
+	entry_count(0)
+{
+	////
+}
+
+bool ItemAttributeIndex::getValue(const Item* item, Attribute attribute, uint16_t& value)
+{
+	switch(attribute) {
+		case ACTION_ID: {
+			value = item->getActionID();
+			return value != 0;
+		}
+		case UNIQUE_ID: {
+			value = item->getUniqueID();
+			return value != 0;
+		}
+		case TEXT: {
+			const std::string* text = item->getStringAttribute(ITEM_ATTRIBUTE_TEXT);
+			value = item->getID();
+			return text && !text->empty();
+		}
+		case DESCRIPTION: {
+			const std::string* description = item->getStringAttribute(ITEM_ATTRIBUTE_DESCRIPTION);
+			value = item->getID();
+			return description && !description->empty();
+		}
+		default:
+			return false;
+	}
+}
+
+void ItemAttributeIndex::getEntries(Tile* tile, std::vector<Entry>& entries)
+{
+	const size_t first = entries.size();
+	foreach_ItemOnTile(tile, [&](Item* item) {
+		// Most items have no attributes at all
+		if(!item->hasAttributes())
+			return;
+
+		for(int attribute = 0; attribute < ATTRIBUTE_COUNT; ++attribute) {
+			Entry entry;
+			entry.attribute = static_cast<Attribute>(attribute);
+			entry.position = tile->getPosition();
+			if(getValue(item, entry.attribute, entry.value) &&
+					std::find(entries.begin() + first, entries.end(), entry) == entries.end()) {
+				entries.push_back(entry);
+			}
+		}
+	});
+}
+
+void ItemAttributeIndex::clear()
+{
+	for(std::map<uint16_t, std::set<Position>>& values : positions)
+		values.clear();
+	entry_count = 0;
+}
+
+bool ItemAttributeIndex::add(Attribute attribute, uint16_t value, const Position& position)
+{
+	if(!positions[attribute][value].insert(position).second)
+		return false;
+
+	++entry_count;
+	return true;
+}
+
+bool ItemAttributeIndex::remove(Attribute attribute, uint16_t value, const Position& position)
+{
+	std::map<uint16_t, std::set<Position>>& values = positions[attribute];
+	auto it = values.find(value);
+	if(it == values.end() || it->second.erase(position) == 0)
+		return false;
+
+	if(it->second.empty())
+		values.erase(it);
+	--entry_count;
+	return true;
+}
+
+void ItemAttributeIndex::assign(std::vector<Entry>& entries)
+{
+	clear();
+	for(const Entry& entry : entries)
+		positions[entry.attribute][entry.value].insert(entry.position);
+	entry_count = entries.size();
+}
+
+void ItemAttributeIndex::addTile(Tile* tile)
+{
+	std::vector<Entry> entries;
+	getEntries(tile, entries);
+	for(const Entry& entry : entries)
+		add(entry.attribute, entry.value, entry.position);
+}
+
+void ItemAttributeIndex::removeTile(Tile* old_tile, Tile* current)
+{
+	std::vector<Entry> entries;
+	getEntries(old_tile, entries);
+	if(entries.empty())
+		return;
+
+	std::vector<Entry> kept;
+	if(current)
+		getEntries(current, kept);
+
+	for(const Entry& entry : entries) {
+		if(std::find(kept.begin(), kept.end(), entry) == kept.end())
+			remove(entry.attribute, entry.value, entry.position);
+	}
+}
+
+void ItemAttributeIndex::find(Attribute attribute, uint16_t first, uint16_t last, std::vector<Entry>& found) const
+{
+	const std::map<uint16_t, std::set<Position>>& values = positions[attribute];
+	for(auto it = values.lower_bound(first); it != values.end() && it->first <= last; ++it) {
+		for(const Position& position : it->second) {
+			Entry entry;
+			entry.attribute = attribute;
+			entry.value = it->first;
+			entry.position = position;
+			found.push_back(entry);
+		}
+	}
+}
+
+void ItemAttributeIndex::getEntries(std::vector<Entry>& entries) const
+{
+	for(int attribute = 0; attribute < ATTRIBUTE_COUNT; ++attribute)
+		find(static_cast<Attribute>(attribute), 0, 0xFFFF, entries);
+	std::sort(entries.begin(), entries.end());
+}
@@ -0,0 +1,91 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_ITEM_ATTRIBUTE_INDEX_H_
+#define RME_ITEM_ATTRIBUTE_INDEX_H_
+
+#include "position.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+class Item;
+class Tile;
+
+// Lists the tiles holding items with action ids, unique ids, texts or
+// descriptions (contents of containers included), so searching for them
+// doesn't have to look up the attributes of every item on the map. Ids are
+// listed by value, texts and descriptions by the id of the item they are on.
+// A tile is listed once per value, however many items on it have that value.
+//
+// Like ItemIdIndex, entries may outlive the items they were made for when a
+// tile is changed in place, whoever reads them has to check the tile.
+class ItemAttributeIndex
+{
+public:
+	enum Attribute {
+		ACTION_ID,
+		UNIQUE_ID,
+		TEXT,
+		DESCRIPTION,
+		ATTRIBUTE_COUNT
+	};
+
+	struct Entry
+	{
+		Attribute attribute;
+		uint16_t value;
+		Position position;
+
+		bool operator<(const Entry& other) const noexcept;
+		bool operator==(const Entry& other) const noexcept;
+	};
+
+	ItemAttributeIndex();
+
+	// The value an item is listed under, false if it doesn't have the attribute
+	static bool getValue(const Item* item, Attribute attribute, uint16_t& value);
+	// The entries for a tile, without repetitions
+	static void getEntries(Tile* tile, std::vector<Entry>& entries);
+
+	void clear();
+	size_t size() const noexcept { return entry_count; }
+
+	bool add(Attribute attribute, uint16_t value, const Position& position);
+	bool remove(Attribute attribute, uint16_t value, const Position& position);
+	// Replaces everything, the entries must not repeat
+	void assign(std::vector<Entry>& entries);
+
+	void addTile(Tile* tile);
+	// Forgets the entries of a tile that was replaced by 'current' (may be
+	// nullptr), unless the new tile has them as well
+	void removeTile(Tile* old_tile, Tile* current);
+
+	// Entries with values in [first, last], ordered by value and position
+	void find(Attribute attribute, uint16_t first, uint16_t last, std::vector<Entry>& found) const;
+	// Every entry, sorted
+	void getEntries(std::vector<Entry>& entries) const;
+
+private:
+	// By value, a busy action id can be on many thousands of tiles so the
+	// positions are kept sorted to add and remove them in logarithmic time
+	std::map<uint16_t, std::set<Position>> positions[ATTRIBUTE_COUNT];
+	size_t entry_count;
+};
+
+#endif
@@ -20,16 +20,174 @@
 #include "item_attributes.h"
 #include "filehandle.h"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace {
+	// Indexed by ItemAttributeKey, must match the order of the enum
+	const char* const well_known_attribute_names[ITEM_ATTRIBUTE_FIRST_CUSTOM] = {
+		"aid",
+		"uid",
+		"text",
+		"desc",
+		"charges",
+		"keyid",
+		"writer",
+		"date",
+		"duration",
+		"name",
+	};
+
+	// Interned names, looked up without locking. The loaders run on several
+	// threads and look up attribute names all the time, while new names are
+	// rare and registered under the mutex.
+	//
+	// Names are only ever appended: a name is stored, then its slot in the
+	// hash index is published, so a reader that finds the slot finds the
+	// name. The index is open addressing over keys and is rebuilt at twice
+	// the size when it gets half full. Older indexes are kept for readers
+	// that may still be probing them, together they are smaller than the
+	// current one.
+	class AttributeKeyTable
+	{
+	public:
+		AttributeKeyTable() :
+			count(0),
+			index(nullptr)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			grow(64);
+			for(uint16_t key = 0; key < ITEM_ATTRIBUTE_FIRST_CUSTOM; ++key)
+				add(well_known_attribute_names[key]);
+		}
+
+		bool find(std::string_view name, ItemAttributeKey& key) const {
+			const Index* current = index.load(std::memory_order_acquire);
+			for(size_t slot = hash(name) & current->mask; ; slot = (slot + 1) & current->mask) {
+				const uint16_t entry = current->slots[slot].load(std::memory_order_acquire);
+				if(entry == 0)
+					return false;
+				if(getName(entry - 1) == name) {
+					key = static_cast<ItemAttributeKey>(entry - 1);
+					return true;
+				}
+			}
+		}
+
+		// Keys are only handed out after their name is stored
+		const std::string& getName(uint32_t key) const {
+			return chunks[key / CHUNK_SIZE][key % CHUNK_SIZE];
+		}
+
+		ItemAttributeKey intern(const std::string& name) {
+			std::lock_guard<std::mutex> lock(mutex);
+			// Another thread may have registered it in the meantime
+			ItemAttributeKey key;
+			if(find(name, key))
+				return key;
+			return add(name);
+		}
+
+	private:
+		static constexpr uint32_t CHUNK_SIZE = 256;
+		// The last key is left out, slots store key + 1
+		static constexpr uint32_t MAX_KEYS = 0xFFFF;
+
+		struct Index
+		{
+			explicit Index(size_t size) :
+				mask(size - 1),
+				slots(newd std::atomic<uint16_t>[size]) {
+				for(size_t i = 0; i < size; ++i)
+					slots[i].store(0, std::memory_order_relaxed);
+			}
+
+			size_t mask;
+			std::unique_ptr<std::atomic<uint16_t>[]> slots;
+		};
+
+		static size_t hash(std::string_view name) {
+			return std::hash<std::string_view>()(name);
+		}
+
+		// These expect the mutex to be held
+		ItemAttributeKey add(const std::string& name) {
+			ASSERT(count < MAX_KEYS);
+			const uint32_t key = count;
+			if(key % CHUNK_SIZE == 0)
+				chunks[key / CHUNK_SIZE].reset(newd std::string[CHUNK_SIZE]);
+			chunks[key / CHUNK_SIZE][key % CHUNK_SIZE] = name;
+			count = key + 1;
+
+			Index* current = index.load(std::memory_order_relaxed);
+			if(count * 2 > current->mask + 1)
+				grow((current->mask + 1) * 2);
+			else
+				insert(*current, key, std::memory_order_release);
+			return static_cast<ItemAttributeKey>(key);
+		}
+
+		void insert(Index& target, uint32_t key, std::memory_order order) {
+			size_t slot = hash(getName(key)) & target.mask;
+			while(target.slots[slot].load(std::memory_order_relaxed) != 0)
+				slot = (slot + 1) & target.mask;
+			target.slots[slot].store(static_cast<uint16_t>(key + 1), order);
+		}
+
+		void grow(size_t size) {
+			auto next = std::make_unique<Index>(size);
+			for(uint32_t key = 0; key < count; ++key)
+				insert(*next, key, std::memory_order_relaxed);
+			index.store(next.get(), std::memory_order_release);
+			indexes.push_back(std::move(next));
+		}
+
+		std::mutex mutex; // Only for registering
+		uint32_t count;
+		std::unique_ptr<std::string[]> chunks[(MAX_KEYS + CHUNK_SIZE - 1) / CHUNK_SIZE];
+		std::vector<std::unique_ptr<Index>> indexes; // Every index ever published
+		std::atomic<Index*> index;
+	};
+
+	AttributeKeyTable& getAttributeKeyTable()
+	{
+		static AttributeKeyTable table;
+		return table;
+	}
+}
+
+ItemAttributeKey ItemAttributeKeys::intern(const std::string& name)
+{
+	ItemAttributeKey key;
+	if(find(name, key))
+		return key;
+	return getAttributeKeyTable().intern(name);
+}
+
+bool ItemAttributeKeys::find(const std::string& name, ItemAttributeKey& key)
+{
+	return getAttributeKeyTable().find(name, key);
+}
+
+const std::string& ItemAttributeKeys::getName(ItemAttributeKey key)
+{
+	return getAttributeKeyTable().getName(key);
+}
+
 ItemAttributes::ItemAttributes() :
 	attributes(nullptr)
 {
 	////
 }
 
-ItemAttributes::ItemAttributes(const ItemAttributes& o)
+ItemAttributes::ItemAttributes(const ItemAttributes& o) :
+	attributes(nullptr)
 {
 	if(o.attributes)
-		attributes = newd ItemAttributeMap(*o.attributes);
+		attributes = newd ItemAttributeList(*o.attributes);
 }
 
 ItemAttributes::~ItemAttributes()
@@ -40,7 +198,7 @@ ItemAttributes::~ItemAttributes()
 void ItemAttributes::createAttributes()
 {
 	if(!attributes)
-		attributes = newd ItemAttributeMap;
+		attributes = newd ItemAttributeList;
 }
 
 void ItemAttributes::clearAllAttributes()
@@ -52,94 +210,161 @@ void ItemAttributes::clearAllAttributes()
 
 ItemAttributeMap ItemAttributes::getAttributes() const
 {
-	if(attributes)
-		return *attributes;
-	return ItemAttributeMap();
+	ItemAttributeMap map;
+	if(attributes) {
+		for(const ItemAttributeEntry& entry : *attributes)
+			map[ItemAttributeKeys::getName(entry.key)] = entry.value;
+	}
+	return map;
 }
 
-void ItemAttributes::setAttribute(const std::string& key, const ItemAttribute& value)
+const ItemAttribute* ItemAttributes::findAttribute(ItemAttributeKey key) const
+{
+	if(!attributes)
+		return nullptr;
+
+	for(const ItemAttributeEntry& entry : *attributes) {
+		if(entry.key == key)
+			return &entry.value;
+	}
+	return nullptr;
+}
+
+ItemAttribute& ItemAttributes::findOrCreateAttribute(ItemAttributeKey key)
 {
 	createAttributes();
-	(*attributes)[key] = value;
+	for(ItemAttributeEntry& entry : *attributes) {
+		if(entry.key == key)
+			return entry.value;
+	}
+	attributes->push_back({key, ItemAttribute()});
+	return attributes->back().value;
+}
+
+void ItemAttributes::setAttribute(const std::string& key, const ItemAttribute& value)
+{
+	setAttribute(ItemAttributeKeys::intern(key), value);
 }
 
 void ItemAttributes::setAttribute(const std::string& key, const std::string& value)
 {
-	createAttributes();
-	(*attributes)[key].set(value);
+	setAttribute(ItemAttributeKeys::intern(key), value);
 }
 
 void ItemAttributes::setAttribute(const std::string& key, int32_t value)
 {
-	createAttributes();
-	(*attributes)[key].set(value);
+	setAttribute(ItemAttributeKeys::intern(key), value);
 }
 
 void ItemAttributes::setAttribute(const std::string& key, double value)
 {
-	createAttributes();
-	(*attributes)[key].set(value);
+	setAttribute(ItemAttributeKeys::intern(key), value);
 }
 
 void ItemAttributes::setAttribute(const std::string& key, bool value)
 {
-	createAttributes();
-	(*attributes)[key].set(value);
+	setAttribute(ItemAttributeKeys::intern(key), value);
+}
+
+void ItemAttributes::setAttribute(ItemAttributeKey key, const ItemAttribute& value)
+{
+	findOrCreateAttribute(key) = value;
+}
+
+void ItemAttributes::setAttribute(ItemAttributeKey key, const std::string& value)
+{
+	findOrCreateAttribute(key).set(value);
+}
+
+void ItemAttributes::setAttribute(ItemAttributeKey key, int32_t value)
+{
+	findOrCreateAttribute(key).set(value);
+}
+
+void ItemAttributes::setAttribute(ItemAttributeKey key, double value)
+{
+	findOrCreateAttribute(key).set(value);
+}
+
+void ItemAttributes::setAttribute(ItemAttributeKey key, bool value)
+{
+	findOrCreateAttribute(key).set(value);
 }
 
 void ItemAttributes::eraseAttribute(const std::string& key)
+{
+	ItemAttributeKey attribute_key;
+	if(attributes && ItemAttributeKeys::find(key, attribute_key))
+		eraseAttribute(attribute_key);
+}
+
+void ItemAttributes::eraseAttribute(ItemAttributeKey key)
 {
 	if(!attributes)
 		return;
 
-	ItemAttributeMap::iterator iter = attributes->find(key);
-
-	if(iter != attributes->end())
-		attributes->erase(iter);
+	for(ItemAttributeList::iterator iter = attributes->begin(); iter != attributes->end(); ++iter) {
+		if(iter->key == key) {
+			attributes->erase(iter);
+			return;
+		}
+	}
 }
 
 const std::string* ItemAttributes::getStringAttribute(const std::string& key) const
 {
-	if(!attributes)
+	ItemAttributeKey attribute_key;
+	if(!attributes || !ItemAttributeKeys::find(key, attribute_key))
 		return nullptr;
-
-	ItemAttributeMap::iterator iter = attributes->find(key);
-	if(iter != attributes->end())
-		return iter->second.getString();
-	return nullptr;
+	return getStringAttribute(attribute_key);
 }
 
 const int32_t* ItemAttributes::getIntegerAttribute(const std::string& key) const
 {
-	if(!attributes)
+	ItemAttributeKey attribute_key;
+	if(!attributes || !ItemAttributeKeys::find(key, attribute_key))
 		return nullptr;
-
-	ItemAttributeMap::iterator iter = attributes->find(key);
-	if(iter != attributes->end())
-		return iter->second.getInteger();
-	return nullptr;
+	return getIntegerAttribute(attribute_key);
 }
 
 const double* ItemAttributes::getFloatAttribute(const std::string& key) const
 {
-	if(!attributes)
+	ItemAttributeKey attribute_key;
+	if(!attributes || !ItemAttributeKeys::find(key, attribute_key))
 		return nullptr;
-
-	ItemAttributeMap::iterator iter = attributes->find(key);
-	if(iter != attributes->end())
-		return iter->second.getFloat();
-	return nullptr;
+	return getFloatAttribute(attribute_key);
 }
 
 const bool* ItemAttributes::getBooleanAttribute(const std::string& key) const
 {
-	if(!attributes)
+	ItemAttributeKey attribute_key;
+	if(!attributes || !ItemAttributeKeys::find(key, attribute_key))
 		return nullptr;
+	return getBooleanAttribute(attribute_key);
+}
 
-	ItemAttributeMap::iterator iter = attributes->find(key);
-	if(iter != attributes->end())
-		return iter->second.getBoolean();
-	return nullptr;
+const std::string* ItemAttributes::getStringAttribute(ItemAttributeKey key) const
+{
+	const ItemAttribute* attribute = findAttribute(key);
+	return attribute ? attribute->getString() : nullptr;
+}
+
+const int32_t* ItemAttributes::getIntegerAttribute(ItemAttributeKey key) const
+{
+	const ItemAttribute* attribute = findAttribute(key);
+	return attribute ? attribute->getInteger() : nullptr;
+}
+
+const double* ItemAttributes::getFloatAttribute(ItemAttributeKey key) const
+{
+	const ItemAttribute* attribute = findAttribute(key);
+	return attribute ? attribute->getFloat() : nullptr;
+}
+
+const bool* ItemAttributes::getBooleanAttribute(ItemAttributeKey key) const
+{
+	const ItemAttribute* attribute = findAttribute(key);
+	return attribute ? attribute->getBoolean() : nullptr;
 }
 
 bool ItemAttributes::hasStringAttribute(const std::string& key) const
@@ -296,6 +521,7 @@ bool ItemAttributes::unserializeAttributeMap(const IOMap& maphandle, BinaryNode*
 	uint16_t n;
 	if(stream->getU16(n)) {
 		createAttributes();
+		attributes->reserve(attributes->size() + n);
 
 		std::string key;
 		ItemAttribute attrib;
@@ -305,7 +531,7 @@ bool ItemAttributes::unserializeAttributeMap(const IOMap& maphandle, BinaryNode*
 				return false;
 			if(!attrib.unserialize(maphandle, stream))
 				return false;
-			(*attributes)[key] = attrib;
+			setAttribute(ItemAttributeKeys::intern(key), attrib);
 		}
 	}
 	return true;
@@ -313,20 +539,27 @@ bool ItemAttributes::unserializeAttributeMap(const IOMap& maphandle, BinaryNode*
 
 void ItemAttributes::serializeAttributeMap(const IOMap& maphandle, NodeFileWriteHandle& f) const
 {
+	// Attributes are written sorted by name, the way they always have been
+	std::vector<std::pair<const std::string*, const ItemAttribute*>> sorted;
+	sorted.reserve(attributes->size());
+	for(const ItemAttributeEntry& entry : *attributes)
+		sorted.emplace_back(&ItemAttributeKeys::getName(entry.key), &entry.value);
+	std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+		return *lhs.first < *rhs.first;
+	});
+
 	// Maximum of 65535 attributes per item
-	f.addU16(std::min((size_t)0xFFFF, attributes->size()));
+	f.addU16(std::min((size_t)0xFFFF, sorted.size()));
 
-	ItemAttributeMap::const_iterator attribute = attributes->begin();
 	int i = 0;
-	while(attribute != attributes->end() && i <= 0xFFFF) {
-		const std::string& key = attribute->first;
+	for(auto attribute = sorted.begin(); attribute != sorted.end() && i <= 0xFFFF; ++attribute, ++i) {
+		const std::string& key = *attribute->first;
 		if(key.size() > 0xFFFF)
 			f.addString(key.substr(0, 65535));
 		else
 			f.addString(key);
 
-		attribute->second.serialize(maphandle, f);
-		++attribute, ++i;
+		attribute->second->serialize(maphandle, f);
 	}
 }
 
@@ -20,6 +20,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include "filehandle.h"
 
@@ -71,6 +72,43 @@ private:
 
 typedef std::map<std::string, ItemAttribute> ItemAttributeMap;
 
+// Attribute names are interned into small integer keys, the well-known ones
+// have fixed keys so the common accessors never have to touch a string.
+enum ItemAttributeKey : uint16_t
+{
+	ITEM_ATTRIBUTE_ACTION_ID, // "aid"
+	ITEM_ATTRIBUTE_UNIQUE_ID, // "uid"
+	ITEM_ATTRIBUTE_TEXT, // "text"
+	ITEM_ATTRIBUTE_DESCRIPTION, // "desc"
+	ITEM_ATTRIBUTE_CHARGES, // "charges"
+	ITEM_ATTRIBUTE_KEY_ID, // "keyid"
+	ITEM_ATTRIBUTE_WRITER, // "writer"
+	ITEM_ATTRIBUTE_DATE, // "date"
+	ITEM_ATTRIBUTE_DURATION, // "duration"
+	ITEM_ATTRIBUTE_NAME, // "name"
+
+	ITEM_ATTRIBUTE_FIRST_CUSTOM
+};
+
+class ItemAttributeKeys
+{
+public:
+	// Returns the key of the name, registering it if it is new
+	static ItemAttributeKey intern(const std::string& name);
+	// Returns false if the name has never been used as a key
+	static bool find(const std::string& name, ItemAttributeKey& key);
+	static const std::string& getName(ItemAttributeKey key);
+};
+
+struct ItemAttributeEntry
+{
+	ItemAttributeKey key;
+	ItemAttribute value;
+};
+
+// Items rarely carry more than a couple of attributes, a flat list beats any map
+typedef std::vector<ItemAttributeEntry> ItemAttributeList;
+
 class ItemAttributes
 {
 public:
@@ -89,12 +127,23 @@ public:
 	void setAttribute(const std::string& key, double value);
 	void setAttribute(const std::string& key, bool set);
 
+	void setAttribute(ItemAttributeKey key, const ItemAttribute& attr);
+	void setAttribute(ItemAttributeKey key, const std::string& value);
+	void setAttribute(ItemAttributeKey key, int32_t value);
+	void setAttribute(ItemAttributeKey key, double value);
+	void setAttribute(ItemAttributeKey key, bool set);
+
 	// returns nullptr if the attribute is not set
 	const std::string* getStringAttribute(const std::string& key) const;
 	const int32_t* getIntegerAttribute(const std::string& key) const;
 	const double* getFloatAttribute(const std::string& key) const;
 	const bool* getBooleanAttribute(const std::string& key) const;
 
+	const std::string* getStringAttribute(ItemAttributeKey key) const;
+	const int32_t* getIntegerAttribute(ItemAttributeKey key) const;
+	const double* getFloatAttribute(ItemAttributeKey key) const;
+	const bool* getBooleanAttribute(ItemAttributeKey key) const;
+
 	// Returns true if the attribute (of that type) exists
 	bool hasStringAttribute(const std::string& key) const;
 	bool hasIntegerAttribute(const std::string& key) const;
@@ -102,14 +151,19 @@ public:
 	bool hasBooleanAttribute(const std::string& key) const;
 
 	void eraseAttribute(const std::string& key);
+	void eraseAttribute(ItemAttributeKey key);
 
 	void clearAllAttributes();
 	ItemAttributeMap getAttributes() const;
+	// False if the item certainly has no attributes
+	bool hasAttributes() const noexcept { return attributes != nullptr; }
 
 protected:
-	ItemAttributeMap* attributes;
+	ItemAttributeList* attributes;
 
 	void createAttributes();
+	const ItemAttribute* findAttribute(ItemAttributeKey key) const;
+	ItemAttribute& findOrCreateAttribute(ItemAttributeKey key);
 };
 
 #endif
@@ -0,0 +1,232 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "item_id_index.h"
+#include "map.h"
+
+namespace {
+	// No cell has this number, x and y would be past rme::MapMaxWidth
+	constexpr uint32_t EMPTY_CELL = 0xFFFFFFFF;
+	constexpr size_t MIN_CAPACITY = 4;
+
+	inline size_t getHome(uint32_t cell, size_t mask)
+	{
+		return static_cast<size_t>((cell * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+	}
+}
+
+ItemIdIndex::ItemIdIndex() :
+	entry_count(0)
+{
+	////
+}
+
+uint32_t ItemIdIndex::getCell(int x, int y, int z)
+{
+	// Two bits of x and y per level of the hex-tree, like QTreeNode::getLeaf
+	uint32_t key = 0;
+	for(int shift = 14; shift >= 2; shift -= 2) {
+		key = (key << 4) | ((x >> shift) & 3) | (((y >> shift) & 3) << 2);
+	}
+	return (key << 4) | (z & 15);
+}
+
+Position ItemIdIndex::getCellPosition(uint32_t cell)
+{
+	Position position(0, 0, cell & 15);
+	uint32_t key = cell >> 4;
+	for(int shift = 2; shift <= 14; shift += 2) {
+		position.x |= (key & 3) << shift;
+		position.y |= ((key >> 2) & 3) << shift;
+		key >>= 4;
+	}
+	return position;
+}
+
+void ItemIdIndex::clear()
+{
+	sets.clear();
+	entry_count = 0;
+}
+
+size_t ItemIdIndex::memsize() const
+{
+	size_t size = sets.capacity() * sizeof(CellSet);
+	for(const CellSet& set : sets) {
+		size += set.slots.capacity() * sizeof(uint32_t);
+	}
+	return size;
+}
+
+bool ItemIdIndex::add(uint16_t id, uint32_t cell)
+{
+	if(sets.empty()) {
+		sets.resize(0x10000);
+	}
+
+	if(!sets[id].insert(cell)) {
+		return false;
+	}
+	++entry_count;
+	return true;
+}
+
+bool ItemIdIndex::remove(uint16_t id, uint32_t cell)
+{
+	if(sets.empty() || !sets[id].erase(cell)) {
+		return false;
+	}
+	--entry_count;
+	return true;
+}
+
+bool ItemIdIndex::contains(uint16_t id, uint32_t cell) const
+{
+	if(sets.empty()) {
+		return false;
+	}
+	const CellSet& set = sets[id];
+	return set.find(cell) != set.slots.size();
+}
+
+void ItemIdIndex::reserve(uint16_t id, size_t count)
+{
+	if(sets.empty()) {
+		sets.resize(0x10000);
+	}
+
+	CellSet& set = sets[id];
+	const size_t wanted = set.count + count;
+	size_t capacity = std::max(set.slots.size(), MIN_CAPACITY);
+	while(wanted * 4 > capacity * 3) {
+		capacity *= 2;
+	}
+	if(capacity != set.slots.size()) {
+		set.rehash(capacity);
+	}
+}
+
+void ItemIdIndex::addTile(const Tile* tile)
+{
+	const uint32_t cell = getCell(tile->getPosition());
+	foreach_ItemOnTile(const_cast<Tile*>(tile), [&](Item* item) {
+		add(item->getID(), cell);
+	});
+}
+
+void ItemIdIndex::getCells(uint16_t id, std::vector<uint32_t>& cells) const
+{
+	cells.clear();
+	if(sets.empty()) {
+		return;
+	}
+
+	const CellSet& set = sets[id];
+	cells.reserve(set.count);
+	for(uint32_t cell : set.slots) {
+		if(cell != EMPTY_CELL) {
+			cells.push_back(cell);
+		}
+	}
+	std::sort(cells.begin(), cells.end());
+}
+
+size_t ItemIdIndex::CellSet::find(uint32_t cell) const
+{
+	if(count == 0) {
+		return slots.size();
+	}
+
+	const size_t mask = slots.size() - 1;
+	for(size_t index = getHome(cell, mask); ; index = (index + 1) & mask) {
+		if(slots[index] == cell) {
+			return index;
+		}
+		if(slots[index] == EMPTY_CELL) {
+			return slots.size();
+		}
+	}
+}
+
+bool ItemIdIndex::CellSet::insert(uint32_t cell)
+{
+	if(slots.empty()) {
+		slots.assign(MIN_CAPACITY, EMPTY_CELL);
+	} else if((count + 1) * 4 > slots.size() * 3) {
+		rehash(slots.size() * 2);
+	}
+
+	const size_t mask = slots.size() - 1;
+	size_t index = getHome(cell, mask);
+	while(slots[index] != EMPTY_CELL) {
+		if(slots[index] == cell) {
+			return false;
+		}
+		index = (index + 1) & mask;
+	}
+	slots[index] = cell;
+	++count;
+	return true;
+}
+
+bool ItemIdIndex::CellSet::erase(uint32_t cell)
+{
+	size_t hole = find(cell);
+	if(hole == slots.size()) {
+		return false;
+	}
+
+	// Moves the cells after the hole that would no longer be found into it
+	const size_t mask = slots.size() - 1;
+	slots[hole] = EMPTY_CELL;
+	for(size_t index = (hole + 1) & mask; slots[index] != EMPTY_CELL; index = (index + 1) & mask) {
+		const size_t home = getHome(slots[index], mask);
+		if(((index - home) & mask) >= ((index - hole) & mask)) {
+			slots[hole] = slots[index];
+			slots[index] = EMPTY_CELL;
+			hole = index;
+		}
+	}
+	--count;
+
+	if(count == 0) {
+		std::vector<uint32_t>().swap(slots);
+	} else if(slots.size() > MIN_CAPACITY && count * 8 < slots.size()) {
+		rehash(slots.size() / 2);
+	}
+	return true;
+}
+
+void ItemIdIndex::CellSet::rehash(size_t capacity)
+{
+	std::vector<uint32_t> old(capacity, EMPTY_CELL);
+	old.swap(slots);
+
+	const size_t mask = capacity - 1;
+	for(uint32_t cell : old) {
+		if(cell == EMPTY_CELL) {
+			continue;
+		}
+		size_t index = getHome(cell, mask);
+		while(slots[index] != EMPTY_CELL) {
+			index = (index + 1) & mask;
+		}
+		slots[index] = cell;
+	}
+}
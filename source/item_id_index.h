@@ -0,0 +1,81 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_ITEM_ID_INDEX_H_
+#define RME_ITEM_ID_INDEX_H_
+
+#include "position.h"
+
+#include <vector>
+
+class Tile;
+
+// Remembers which parts of the map every item id occurs in, so that looking
+// for an id only has to visit those instead of the whole map. The map is
+// divided into cells of 4x4 tiles on one floor (the floors of the map
+// leaves). An id is listed once per cell, however often it occurs there, so
+// there are never more entries than items on the map, at 4 to 11 bytes each.
+//
+// Entries may outlive the items they were made for when a tile is changed in
+// place, whoever reads a cell has to check it (and may remove the entry).
+// Items are never missing, as long as every change to the map goes through
+// setTile/swapTile or is reported with markTileChanged.
+class ItemIdIndex
+{
+public:
+	ItemIdIndex();
+
+	// Cells are numbered in the order MapIterator visits them
+	static uint32_t getCell(int x, int y, int z);
+	static uint32_t getCell(const Position& position) { return getCell(position.x, position.y, position.z); }
+	// Position of the first tile of the cell
+	static Position getCellPosition(uint32_t cell);
+
+	void clear();
+	size_t size() const noexcept { return entry_count; }
+	size_t memsize() const;
+
+	bool add(uint16_t id, uint32_t cell);
+	bool remove(uint16_t id, uint32_t cell);
+	bool contains(uint16_t id, uint32_t cell) const;
+	// Makes room for 'count' more cells of the id
+	void reserve(uint16_t id, size_t count);
+
+	// Adds every item of the tile, contents of containers included
+	void addTile(const Tile* tile);
+
+	// Cells listed for the id, in ascending order
+	void getCells(uint16_t id, std::vector<uint32_t>& cells) const;
+
+private:
+	// Open addressing (linear probing) set of cells
+	struct CellSet
+	{
+		std::vector<uint32_t> slots; // Power of two sized, EMPTY_CELL where free
+		uint32_t count = 0;
+
+		size_t find(uint32_t cell) const;
+		bool insert(uint32_t cell);
+		bool erase(uint32_t cell);
+		void rehash(size_t capacity);
+	};
+
+	std::vector<CellSet> sets; // Indexed by id, only allocated once the first id is added
+	size_t entry_count;
+};
+
+#endif
@@ -23,6 +23,20 @@ LightDrawer::LightDrawer()
 	texture = 0;
 	buffer.resize(static_cast<size_t>(rme::ClientMapWidth * rme::ClientMapHeight * rme::PixelFormatRGBA));
 	global_color = wxColor(50, 50, 50, 255);
+	uploaded = false;
+	uploaded_x = 0;
+	uploaded_y = 0;
+
+	for(int intensity = 0; intensity <= rme::MaxLightIntensity; ++intensity) {
+		const int size = intensity * 2 + 1;
+		const Light light{ static_cast<uint16_t>(intensity), static_cast<uint16_t>(intensity), 0, static_cast<uint8_t>(intensity) };
+		falloff[intensity].resize(static_cast<size_t>(size * size));
+		for(int y = 0; y < size; ++y) {
+			for(int x = 0; x < size; ++x) {
+				falloff[intensity][y * size + x] = calculateIntensity(x, y, light);
+			}
+		}
+	}
 
 	createGLTexture();
 }
@@ -36,36 +50,22 @@ LightDrawer::~LightDrawer()
 
 void LightDrawer::draw(int map_x, int map_y, int scroll_x, int scroll_y)
 {
-	constexpr int half_tile_size = rme::TileSize / 2;
-
-	for (int x = 0; x < rme::ClientMapWidth; ++x) {
-		for (int y = 0; y < rme::ClientMapHeight; ++y) {
-			int mx = (map_x + x);
-			int my = (map_y + y);
-			int px = (mx * rme::TileSize + half_tile_size);
-			int py = (my * rme::TileSize + half_tile_size);
-			int index = (y * rme::ClientMapWidth + x);
-			int color_index = index * rme::PixelFormatRGBA;
-
-			buffer[color_index]	 = global_color.Red();
-			buffer[color_index + 1] = global_color.Green();
-			buffer[color_index + 2] = global_color.Blue();
-			buffer[color_index + 3] = global_color.Alpha();
-
-			for (auto& light : lights) {
-				float intensity = calculateIntensity(mx, my, light);
-				if (intensity == 0.f) {
-					continue;
-				}
-				wxColor light_color = colorFromEightBit(light.color);
-				uint8_t red = static_cast<uint8_t>(light_color.Red() * intensity);
-				uint8_t green = static_cast<uint8_t>(light_color.Green() * intensity);
-				uint8_t blue = static_cast<uint8_t>(light_color.Blue() * intensity);
-				buffer[color_index]	 = std::max(buffer[color_index], red);
-				buffer[color_index + 1] = std::max(buffer[color_index + 1], green);
-				buffer[color_index + 2] = std::max(buffer[color_index + 2], blue);
-			}
-		}
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	if(!uploaded || map_x != uploaded_x || map_y != uploaded_y || global_color != uploaded_color || lights != uploaded_lights) {
+		fillBuffer(map_x, map_y);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, 0x812F);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, 0x812F);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, rme::ClientMapWidth, rme::ClientMapHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
+
+		uploaded = true;
+		uploaded_x = map_x;
+		uploaded_y = map_y;
+		uploaded_color = global_color;
+		uploaded_lights = lights;
 	}
 
 	const int draw_x = map_x * rme::TileSize - scroll_x;
@@ -73,13 +73,6 @@ void LightDrawer::draw(int map_x, int map_y, int scroll_x, int scroll_y)
 	constexpr int draw_width = rme::ClientMapWidth * rme::TileSize;
 	constexpr int draw_height = rme::ClientMapHeight * rme::TileSize;
 
-	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, 0x812F);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, 0x812F);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, rme::ClientMapWidth, rme::ClientMapHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
-
 	glBlendFunc(GL_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA);
 
 	glEnable(GL_TEXTURE_2D);
@@ -94,6 +87,50 @@ void LightDrawer::draw(int map_x, int map_y, int scroll_x, int scroll_y)
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
+void LightDrawer::fillBuffer(int map_x, int map_y)
+{
+	for(size_t i = 0; i < buffer.size(); i += rme::PixelFormatRGBA) {
+		buffer[i] = global_color.Red();
+		buffer[i + 1] = global_color.Green();
+		buffer[i + 2] = global_color.Blue();
+		buffer[i + 3] = global_color.Alpha();
+	}
+
+	// One row of a light, blended into the buffer with a plain max over the bytes
+	uint8_t row[(rme::MaxLightIntensity * 2 + 1) * rme::PixelFormatRGBA];
+
+	for(const Light& light : lights) {
+		const int radius = light.intensity;
+		const int light_x = light.map_x - map_x;
+		const int light_y = light.map_y - map_y;
+		const int start_x = std::max(light_x - radius, 0);
+		const int end_x = std::min(light_x + radius, rme::ClientMapWidth - 1);
+		const int start_y = std::max(light_y - radius, 0);
+		const int end_y = std::min(light_y + radius, rme::ClientMapHeight - 1);
+		if(radius == 0 || start_x > end_x || start_y > end_y) {
+			continue;
+		}
+
+		const wxColor color = colorFromEightBit(light.color);
+		const int size = radius * 2 + 1;
+		const int width = end_x - start_x + 1;
+		for(int y = start_y; y <= end_y; ++y) {
+			const float* intensity = &falloff[radius][(y - light_y + radius) * size + (start_x - light_x + radius)];
+			for(int x = 0; x < width; ++x) {
+				row[x * rme::PixelFormatRGBA] = static_cast<uint8_t>(color.Red() * intensity[x]);
+				row[x * rme::PixelFormatRGBA + 1] = static_cast<uint8_t>(color.Green() * intensity[x]);
+				row[x * rme::PixelFormatRGBA + 2] = static_cast<uint8_t>(color.Blue() * intensity[x]);
+				row[x * rme::PixelFormatRGBA + 3] = 0;
+			}
+
+			uint8_t* pixels = &buffer[(y * rme::ClientMapWidth + start_x) * rme::PixelFormatRGBA];
+			for(int i = 0; i < width * rme::PixelFormatRGBA; ++i) {
+				pixels[i] = std::max(pixels[i], row[i]);
+			}
+		}
+	}
+}
+
 void LightDrawer::setGlobalLightColor(uint8_t color)
 {
 	global_color = colorFromEightBit(color);
@@ -21,6 +21,10 @@
 #include "graphics.h"
 #include "position.h"
 
+// Draws the light map of the ingame box. Every light is only added to the
+// tiles within its intensity, using a falloff table made once per intensity.
+// The buffer is filled and uploaded again only when the lights, the global
+// light or the position of the box differ from the last frame.
 class LightDrawer
 {
 	struct Light {
@@ -28,6 +32,8 @@ class LightDrawer
 		uint16_t map_y = 0;
 		uint8_t color = 0;
 		uint8_t intensity = 0;
+
+		bool operator==(const Light& other) const noexcept = default;
 	};
 
 public:
@@ -41,6 +47,7 @@ public:
 	void clear() noexcept;
 
 private:
+	void fillBuffer(int map_x, int map_y);
 	void createGLTexture();
 	void unloadGLTexture();
 
@@ -62,6 +69,16 @@ private:
 	std::vector<Light> lights;
 	std::vector<uint8_t> buffer;
 	wxColor global_color;
+
+	// By intensity, the intensity of the (2 * intensity + 1)^2 tiles around a light
+	std::vector<float> falloff[rme::MaxLightIntensity + 1];
+
+	// What the texture was made of
+	bool uploaded;
+	int uploaded_x;
+	int uploaded_y;
+	std::vector<Light> uploaded_lights;
+	wxColor uploaded_color;
 };
 
 #endif
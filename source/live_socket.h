@@ -67,6 +67,9 @@ class LiveSocket
 		//
 		virtual void updateCursor(const Position& position) = 0;
 
+		// Closes the connection(s), Editor calls it through the base class
+		virtual void close() = 0;
+
 	protected:
 		// receive / send methods
 		void receiveNode(NetworkMessage& message, Editor& editor, Action* action, int32_t ndx, int32_t ndy, bool underground);
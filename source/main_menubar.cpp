@@ -36,6 +36,7 @@
 #include "items.h"
 #include "editor.h"
 #include "materials.h"
+#include "map_reachability.h"
 #include "live_client.h"
 #include "live_server.h"
 
@@ -76,9 +77,12 @@ MainMenuBar::MainMenuBar(MainFrame *frame) : frame(frame)
 	MAKE_ACTION(SEARCH_ON_MAP_ZONES, wxITEM_NORMAL, OnSearchForZonesOnMap);
 	MAKE_ACTION(SEARCH_ON_MAP_UNIQUE, wxITEM_NORMAL, OnSearchForUniqueOnMap);
 	MAKE_ACTION(SEARCH_ON_MAP_ACTION, wxITEM_NORMAL, OnSearchForActionOnMap);
+	MAKE_ACTION(SEARCH_ON_MAP_UNIQUE_RANGE, wxITEM_NORMAL, OnSearchForUniqueRangeOnMap);
+	MAKE_ACTION(SEARCH_ON_MAP_ACTION_RANGE, wxITEM_NORMAL, OnSearchForActionRangeOnMap);
 	MAKE_ACTION(SEARCH_ON_MAP_CONTAINER, wxITEM_NORMAL, OnSearchForContainerOnMap);
 	MAKE_ACTION(SEARCH_ON_MAP_WRITEABLE, wxITEM_NORMAL, OnSearchForWriteableOnMap);
 	MAKE_ACTION(SEARCH_ON_MAP_DUPLICATED_ITEMS, wxITEM_NORMAL, OnSearchForDuplicatedItemsOnMap);
+	MAKE_ACTION(SEARCH_ON_MAP_DUPLICATED_UNIQUE, wxITEM_NORMAL, OnSearchForDuplicatedUniqueOnMap);
 	MAKE_ACTION(SEARCH_ON_SELECTION_EVERYTHING, wxITEM_NORMAL, OnSearchForStuffOnSelection);
 	MAKE_ACTION(SEARCH_ON_SELECTION_ZONES, wxITEM_NORMAL, OnSearchForZonesOnSelection);
 	MAKE_ACTION(SEARCH_ON_SELECTION_UNIQUE, wxITEM_NORMAL, OnSearchForUniqueOnSelection);
@@ -236,6 +240,13 @@ MainMenuBar::~MainMenuBar()
 	}
 }
 
+// Progress callback for the parallel map traversals
+static void UpdateLoadBar(uint64_t done, uint64_t total)
+{
+	if(total != 0)
+		g_gui.SetLoadDone((uint32_t)(100 * done / total));
+}
+
 namespace OnMapRemoveItems
 {
 	struct RemoveItemCondition
@@ -245,9 +256,7 @@ namespace OnMapRemoveItems
 
 		uint16_t itemId;
 
-		bool operator()(Map& map, Item* item, int64_t removed, int64_t done) {
-			if(done % 0x8000 == 0)
-				g_gui.SetLoadDone((uint32_t)(100 * done / map.getTileCount()));
+		bool operator()(Map& map, Item* item) const {
 			return item->getID() == itemId && !item->isComplex();
 		}
 	};
@@ -338,9 +347,12 @@ void MainMenuBar::Update()
 	EnableItem(SEARCH_ON_MAP_EVERYTHING, is_host);
 	EnableItem(SEARCH_ON_MAP_UNIQUE, is_host);
 	EnableItem(SEARCH_ON_MAP_ACTION, is_host);
+	EnableItem(SEARCH_ON_MAP_UNIQUE_RANGE, is_host);
+	EnableItem(SEARCH_ON_MAP_ACTION_RANGE, is_host);
 	EnableItem(SEARCH_ON_MAP_CONTAINER, is_host);
 	EnableItem(SEARCH_ON_MAP_WRITEABLE, is_host);
 	EnableItem(SEARCH_ON_MAP_DUPLICATED_ITEMS, is_host);
+	EnableItem(SEARCH_ON_MAP_DUPLICATED_UNIQUE, is_host);
 	EnableItem(SEARCH_ON_SELECTION_EVERYTHING, has_selection && is_host);
 	EnableItem(SEARCH_ON_SELECTION_UNIQUE, has_selection && is_host);
 	EnableItem(SEARCH_ON_SELECTION_ACTION, has_selection && is_host);
@@ -868,33 +880,6 @@ void MainMenuBar::OnRedo(wxCommandEvent& WXUNUSED(event))
 	g_gui.DoRedo();
 }
 
-namespace OnSearchForItem
-{
-	struct Finder
-	{
-		Finder(uint16_t itemId, uint32_t maxCount) :
-			itemId(itemId), maxCount(maxCount) {}
-
-		uint16_t itemId;
-		uint32_t maxCount;
-		std::vector< std::pair<Tile*, Item*> > result;
-
-		bool limitReached() const { return result.size() >= (size_t)maxCount; }
-
-		void operator()(Map& map, Tile* tile, Item* item, long long done)
-		{
-			if(result.size() >= (size_t)maxCount)
-				return;
-
-			if(done % 0x8000 == 0)
-				g_gui.SetLoadDone((unsigned int)(100 * done / map.getTileCount()));
-
-			if(item->getID() == itemId)
-				result.push_back(std::make_pair(tile, item));
-		}
-	};
-}
-
 void MainMenuBar::OnSearchForItem(wxCommandEvent& WXUNUSED(event))
 {
 	if(!g_gui.IsEditorOpen())
@@ -903,17 +888,17 @@ void MainMenuBar::OnSearchForItem(wxCommandEvent& WXUNUSED(event))
 	FindItemDialog dialog(frame, "Search for Item");
 	dialog.setSearchMode((FindItemDialog::SearchMode)g_settings.getInteger(Config::FIND_ITEM_MODE));
 	if(dialog.ShowModal() == wxID_OK) {
-		OnSearchForItem::Finder finder(dialog.getResultID(), (uint32_t)g_settings.getInteger(Config::REPLACE_SIZE));
+		const uint32_t maxCount = (uint32_t)g_settings.getInteger(Config::REPLACE_SIZE);
 		g_gui.CreateLoadBar("Searching map...");
 
-		foreach_ItemOnMap(g_gui.GetCurrentMap(), finder, false);
-		std::vector< std::pair<Tile*, Item*> >& result = finder.result;
+		std::vector<std::pair<Tile*, Item*> > result;
+		g_gui.GetCurrentEditor()->findItems(dialog.getResultID(), false, maxCount, result);
 
 		g_gui.DestroyLoadBar();
 
-		if(finder.limitReached()) {
+		if(result.size() >= (size_t)maxCount) {
 			wxString msg;
-			msg << "The configured limit has been reached. Only " << finder.maxCount << " results will be displayed.";
+			msg << "The configured limit has been reached. Only " << maxCount << " results will be displayed.";
 			g_gui.PopupDialog("Notice", msg, wxOK);
 		}
 
@@ -960,11 +945,8 @@ namespace OnSearchForStuff
 		bool search_writeable;
 		std::vector<std::pair<Tile*, Item*> > found;
 
-		void operator()(Map& map, Tile* tile, Item* item, long long done)
+		void operator()(Map& map, Tile* tile, Item* item)
 		{
-			if(done % 0x8000 == 0) {
-				g_gui.SetLoadDone((unsigned int)(100 * done / map.getTileCount()));
-			}
 			Container* container;
 			if ((search_zones && item->isGroundTile() && !tile->getZoneIds().empty()) ||
 				(search_unique && item->getUniqueID() > 0) ||
@@ -975,6 +957,11 @@ namespace OnSearchForStuff
 			}
 		}
 
+		void merge(const Searcher& other)
+		{
+			found.insert(found.end(), other.found.begin(), other.found.end());
+		}
+
 		wxString desc(Tile* tile, Item* item)
 		{
 			wxString label;
@@ -1037,6 +1024,29 @@ namespace OnSearchForStuff
 	};
 }
 
+namespace OnSearchForIdRange
+{
+	struct Finder
+	{
+		ItemAttributeIndex::Attribute attribute;
+		uint16_t first;
+		uint16_t last;
+		std::vector<std::pair<Tile*, Item*>> found;
+
+		void operator()(Map& map, Tile* tile, Item* item)
+		{
+			uint16_t value;
+			if(ItemAttributeIndex::getValue(item, attribute, value) && value >= first && value <= last)
+				found.push_back(std::make_pair(tile, item));
+		}
+
+		void merge(const Finder& other)
+		{
+			found.insert(found.end(), other.found.begin(), other.found.end());
+		}
+	};
+}
+
 void MainMenuBar::OnSearchForStuffOnMap(wxCommandEvent& WXUNUSED(event))
 {
 	SearchItems(true, true, true, true, false);
@@ -1047,6 +1057,38 @@ void MainMenuBar::OnSearchForDuplicatedItemsOnMap(wxCommandEvent& WXUNUSED(event
 	SearchDuplicatedItems(false);
 }
 
+void MainMenuBar::OnSearchForDuplicatedUniqueOnMap(wxCommandEvent& WXUNUSED(event))
+{
+	if(!g_gui.IsEditorOpen())
+		return;
+
+	Map& map = g_gui.GetCurrentMap();
+	const std::map<uint16_t, PositionVector> duplicates = map.getDuplicateUniqueIds();
+	if(duplicates.empty()) {
+		g_gui.PopupDialog("Find Duplicated Unique IDs", "No unique ID is used more than once on this map.", wxOK);
+		return;
+	}
+
+	SearchResultWindow* result = g_gui.ShowSearchWindow();
+	result->Clear();
+	for(const auto& duplicate : duplicates) {
+		for(const Position& position : duplicate.second) {
+			wxString label;
+			label << "UID: " << duplicate.first;
+			if(Tile* tile = map.getTile(position)) {
+				const Item* found = nullptr;
+				foreach_ItemOnTile(tile, [&](Item* item) {
+					if(!found && item->getUniqueID() == duplicate.first)
+						found = item;
+				});
+				if(found)
+					label << " " << wxstr(found->getName());
+			}
+			result->AddPosition(label, position);
+		}
+	}
+}
+
 void MainMenuBar::OnSearchForZonesOnMap(wxCommandEvent& WXUNUSED(event))
 {
 	SearchItems(false, false, false, false, true);
@@ -1062,6 +1104,16 @@ void MainMenuBar::OnSearchForActionOnMap(wxCommandEvent& WXUNUSED(event))
 	SearchItems(false, true, false, false, false);
 }
 
+void MainMenuBar::OnSearchForUniqueRangeOnMap(wxCommandEvent& WXUNUSED(event))
+{
+	SearchIdRange(true);
+}
+
+void MainMenuBar::OnSearchForActionRangeOnMap(wxCommandEvent& WXUNUSED(event))
+{
+	SearchIdRange(false);
+}
+
 void MainMenuBar::OnSearchForContainerOnMap(wxCommandEvent& WXUNUSED(event))
 {
 	SearchItems(false, false, true, false, false);
@@ -1110,17 +1162,17 @@ void MainMenuBar::OnSearchForItemOnSelection(wxCommandEvent& WXUNUSED(event))
 	FindItemDialog dialog(frame, "Search on Selection");
 	dialog.setSearchMode((FindItemDialog::SearchMode)g_settings.getInteger(Config::FIND_ITEM_MODE));
 	if(dialog.ShowModal() == wxID_OK) {
-		OnSearchForItem::Finder finder(dialog.getResultID(), (uint32_t)g_settings.getInteger(Config::REPLACE_SIZE));
+		const uint32_t maxCount = (uint32_t)g_settings.getInteger(Config::REPLACE_SIZE);
 		g_gui.CreateLoadBar("Searching on selected area...");
 
-		foreach_ItemOnMap(g_gui.GetCurrentMap(), finder, true);
-		std::vector<std::pair<Tile*, Item*> >& result = finder.result;
+		std::vector<std::pair<Tile*, Item*> > result;
+		g_gui.GetCurrentEditor()->findItems(dialog.getResultID(), true, maxCount, result);
 
 		g_gui.DestroyLoadBar();
 
-		if(finder.limitReached()) {
+		if(result.size() >= (size_t)maxCount) {
 			wxString msg;
-			msg << "The configured limit has been reached. Only " << finder.maxCount << " results will be displayed.";
+			msg << "The configured limit has been reached. Only " << maxCount << " results will be displayed.";
 			g_gui.PopupDialog("Notice", msg, wxOK);
 		}
 
@@ -1165,7 +1217,7 @@ void MainMenuBar::OnRemoveItemOnSelection(wxCommandEvent& WXUNUSED(event))
 		g_gui.GetCurrentEditor()->clearActions();
 		g_gui.CreateLoadBar("Searching item on selection to remove...");
 		OnMapRemoveItems::RemoveItemCondition condition(dialog.getResultID());
-		int64_t count = RemoveItemOnMap(g_gui.GetCurrentMap(), condition, true);
+		int64_t count = parallel_RemoveItemOnMap(g_gui.GetCurrentMap(), condition, true, UpdateLoadBar);
 		g_gui.DestroyLoadBar();
 
 		wxString msg;
@@ -1325,7 +1377,7 @@ void MainMenuBar::OnMapRemoveItems(wxCommandEvent& WXUNUSED(event))
 		OnMapRemoveItems::RemoveItemCondition condition(itemid);
 		g_gui.CreateLoadBar("Searching map for items to remove...");
 
-		int64_t count = RemoveItemOnMap(g_gui.GetCurrentMap(), condition, false);
+		int64_t count = parallel_RemoveItemOnMap(g_gui.GetCurrentMap(), condition, false, UpdateLoadBar);
 
 		g_gui.DestroyLoadBar();
 
@@ -1345,10 +1397,7 @@ namespace OnMapRemoveCorpses
 	{
 		condition() {}
 
-		bool operator()(Map& map, Item* item, long long removed, long long done){
-			if(done % 0x800 == 0)
-				g_gui.SetLoadDone((unsigned int)(100 * done / map.getTileCount()));
-
+		bool operator()(Map& map, Item* item) const {
 			return g_materials.isInTileset(item, "Corpses") & !item->isComplex();
 		}
 	};
@@ -1368,7 +1417,7 @@ void MainMenuBar::OnMapRemoveCorpses(wxCommandEvent& WXUNUSED(event))
 		OnMapRemoveCorpses::condition func;
 		g_gui.CreateLoadBar("Searching map for items to remove...");
 
-		int64_t count = RemoveItemOnMap(g_gui.GetCurrentMap(), func, false);
+		int64_t count = parallel_RemoveItemOnMap(g_gui.GetCurrentMap(), func, false, UpdateLoadBar);
 
 		g_gui.DestroyLoadBar();
 
@@ -1381,49 +1430,24 @@ void MainMenuBar::OnMapRemoveCorpses(wxCommandEvent& WXUNUSED(event))
 
 namespace OnMapRemoveUnreachable
 {
-	struct condition
+	struct Finder
 	{
-		condition() {}
+		Finder(const ReachabilityMap& reachability) :
+			reachability(&reachability) {}
+
+		const ReachabilityMap* reachability;
+		std::vector<Position> unreachable;
 
-		bool isReachable(Tile* tile)
+		void operator()(Map& map, Tile* tile)
 		{
-			if(tile == nullptr)
-				return false;
-			if(!tile->isBlocking())
-				return true;
-			return false;
+			const Position& position = tile->getPosition();
+			if(!reachability->isReachable(position))
+				unreachable.push_back(position);
 		}
 
-		bool operator()(Map& map, Tile* tile, long long removed, long long done, long long total)
+		void merge(const Finder& other)
 		{
-			if(done % 0x1000 == 0)
-				g_gui.SetLoadDone((unsigned int)(100 * done / total));
-
-			const Position& pos = tile->getPosition();
-			int sx = std::max(pos.x - 10, 0);
-			int ex = std::min(pos.x + 10, 65535);
-			int sy = std::max(pos.y - 8,  0);
-			int ey = std::min(pos.y + 8,  65535);
-			int sz, ez;
-
-			if(pos.z < 8) {
-				sz = 0;
-				ez = 9;
-			} else {
-				// underground
-				sz = std::max(pos.z - 2, rme::MapGroundLayer);
-				ez = std::min(pos.z + 2, rme::MapMaxLayer);
-			}
-
-			for(int z = sz; z <= ez; ++z) {
-				for(int y = sy; y <= ey; ++y) {
-					for(int x = sx; x <= ex; ++x) {
-						if(isReachable(map.getTile(x, y, z)))
-							return false;
-					}
-				}
-			}
-			return true;
+			unreachable.insert(unreachable.end(), other.unreachable.begin(), other.unreachable.end());
 		}
 	};
 }
@@ -1439,10 +1463,17 @@ void MainMenuBar::OnMapRemoveUnreachable(wxCommandEvent& WXUNUSED(event))
 		g_gui.GetCurrentEditor()->getSelection().clear();
 		g_gui.GetCurrentEditor()->clearActions();
 
-		OnMapRemoveUnreachable::condition func;
 		g_gui.CreateLoadBar("Searching map for tiles to remove...");
 
-		long long removed = remove_if_TileOnMap(g_gui.GetCurrentMap(), func);
+		Map& map = g_gui.GetCurrentMap();
+		ReachabilityMap reachability(map);
+		OnMapRemoveUnreachable::Finder finder(reachability);
+		parallel_foreach_TileOnMap(map, finder, UpdateLoadBar);
+
+		// Unreachable tiles are blocking, removing them doesn't make any other tile unreachable
+		for(const Position& position : finder.unreachable)
+			map.setTile(position, nullptr, true);
+		long long removed = finder.unreachable.size();
 
 		g_gui.DestroyLoadBar();
 
@@ -1613,121 +1644,53 @@ void MainMenuBar::OnMapStatistics(wxCommandEvent& WXUNUSED(event))
 	if(!g_gui.IsEditorOpen())
 		return;
 
-	g_gui.CreateLoadBar("Collecting data...");
-
 	Map* map = &g_gui.GetCurrentMap();
 
-	int load_counter = 0;
+#ifdef __DEBUG__
+	// Kept up to date by the map, a debug build also counts everything to be sure
+	map->checkStatistics();
+#endif
+	const MapStatistics& statistics = map->getStatistics();
+	const HouseStatistics house_statistics = map->getHouseStatistics();
 
-	uint64_t tile_count = 0;
-	uint64_t detailed_tile_count = 0;
-	uint64_t blocking_tile_count = 0;
-	uint64_t walkable_tile_count = 0;
+	uint64_t tile_count = statistics.tile_count;
+	uint64_t detailed_tile_count = statistics.detailed_tile_count;
+	uint64_t blocking_tile_count = statistics.blocking_tile_count;
+	uint64_t walkable_tile_count = statistics.walkable_tile_count;
 	double percent_pathable = 0.0;
 	double percent_detailed = 0.0;
-	uint64_t spawn_count = 0;
-	uint64_t creature_count = 0;
+	uint64_t spawn_count = statistics.spawn_count;
+	uint64_t creature_count = statistics.creature_count;
 	double creatures_per_spawn = 0.0;
 
-	uint64_t item_count = 0;
-	uint64_t loose_item_count = 0;
-	uint64_t depot_count = 0;
-	uint64_t action_item_count = 0;
-	uint64_t unique_item_count = 0;
-	uint64_t container_count = 0; // Only includes containers containing more than 1 item
+	uint64_t item_count = statistics.item_count;
+	uint64_t loose_item_count = statistics.loose_item_count;
+	uint64_t depot_count = statistics.depot_count;
+	uint64_t action_item_count = statistics.action_item_count;
+	uint64_t unique_item_count = statistics.unique_item_count;
+	uint64_t container_count = statistics.container_count;
 
 	int town_count = map->towns.count();
 	int house_count = map->houses.count();
-	std::map<uint32_t, uint32_t> town_sqm_count;
 	const Town* largest_town = nullptr;
 	uint64_t largest_town_size = 0;
-	uint64_t total_house_sqm = 0;
+	uint64_t total_house_sqm = house_statistics.total_sqm;
 	const House* largest_house = nullptr;
 	uint64_t largest_house_size = 0;
 	double houses_per_town = 0.0;
 	double sqm_per_house = 0.0;
 	double sqm_per_town = 0.0;
 
-	for(MapIterator mit = map->begin(); mit != map->end(); ++mit) {
-		Tile* tile = (*mit)->get();
-		if(load_counter % 8192 == 0) {
-			g_gui.SetLoadDone((unsigned int)(int64_t(load_counter) * 95ll / int64_t(map->getTileCount())));
-		}
-
-		if(tile->empty())
-			continue;
-
-		tile_count += 1;
-
-		bool is_detailed = false;
-#define ANALYZE_ITEM(_item) {\
-	item_count += 1; \
-	if(!(_item)->isGroundTile() && !(_item)->isBorder()) { \
-		is_detailed = true; \
-		const ItemType& it = g_items.getItemType((_item)->getID()); \
-		if(it.moveable) { \
-			loose_item_count += 1; \
-		} \
-		if(it.isDepot()) { \
-			depot_count += 1; \
-		} \
-		if((_item)->getActionID() > 0) { \
-			action_item_count += 1; \
-		} \
-		if((_item)->getUniqueID() > 0) { \
-			unique_item_count += 1; \
-		} \
-		if(Container* c = dynamic_cast<Container*>((_item))) { \
-			if(c->getVector().size()) { \
-				container_count += 1; \
-			} \
-		} \
-	} \
-}
-		if(tile->ground) {
-			ANALYZE_ITEM(tile->ground);
-		}
-
-		for(Item* item : tile->items) {
-			ANALYZE_ITEM(item);
-		}
-#undef ANALYZE_ITEM
-
-		if(tile->spawn)
-			spawn_count += 1;
-
-		if(tile->creature)
-			creature_count += 1;
-
-		if(tile->isBlocking())
-			blocking_tile_count += 1;
-		else
-			walkable_tile_count += 1;
-
-		if(is_detailed)
-			detailed_tile_count += 1;
-
-		load_counter += 1;
-	}
-
 	creatures_per_spawn = (spawn_count != 0 ? double(creature_count) / double(spawn_count) : -1.0);
 	percent_pathable = 100.0*(tile_count != 0 ? double(walkable_tile_count) / double(tile_count) : -1.0);
 	percent_detailed = 100.0*(tile_count != 0 ? double(detailed_tile_count) / double(tile_count) : -1.0);
 
-	load_counter = 0;
 	Houses& houses = map->houses;
-	for(HouseMap::const_iterator hit = houses.begin(); hit != houses.end(); ++hit) {
-		const House* house = hit->second;
-
-		if(load_counter % 64)
-			g_gui.SetLoadDone((unsigned int)(95ll + int64_t(load_counter) * 5ll / int64_t(house_count)));
-
-		if(house->size() > largest_house_size) {
-			largest_house = house;
-			largest_house_size = house->size();
+	for(const auto& house_sqm : house_statistics.house_sqm) {
+		if(house_sqm.second > largest_house_size) {
+			largest_house = houses.getHouse(house_sqm.first);
+			largest_house_size = house_sqm.second;
 		}
-		total_house_sqm += house->size();
-		town_sqm_count[house->townid] += house->size();
 	}
 
 	houses_per_town = (town_count != 0?  double(house_count) /     double(town_count)  : -1.0);
@@ -1735,24 +1698,15 @@ void MainMenuBar::OnMapStatistics(wxCommandEvent& WXUNUSED(event))
 	sqm_per_town    = (town_count != 0?  double(total_house_sqm) / double(town_count)  : -1.0);
 
 	Towns& towns = map->towns;
-	for(std::map<uint32_t, uint32_t>::iterator town_iter = town_sqm_count.begin();
-			town_iter != town_sqm_count.end();
-			++town_iter)
-	{
-		// No load bar for this, load is non-existant
-		uint32_t town_id = town_iter->first;
-		uint32_t town_sqm = town_iter->second;
-		Town* town = towns.getTown(town_id);
-		if(town && town_sqm > largest_town_size) {
+	for(const auto& town_sqm : house_statistics.town_sqm) {
+		// Houses can name towns that don't exist
+		Town* town = towns.getTown(town_sqm.first);
+		if(town && town_sqm.second > largest_town_size) {
 			largest_town = town;
-			largest_town_size = town_sqm;
-		} else {
-			// Non-existant town!
+			largest_town_size = town_sqm.second;
 		}
 	}
 
-	g_gui.DestroyLoadBar();
-
 	std::ostringstream os;
 	os.setf(std::ios::fixed, std::ios::floatfield);
 	os.precision(2);
@@ -1774,6 +1728,7 @@ void MainMenuBar::OnMapStatistics(wxCommandEvent& WXUNUSED(event))
 	os << "\t\tNumber of containers: " << container_count << "\n";
 	os << "\t\tNumber of items with Action ID: " << action_item_count << "\n";
 	os << "\t\tNumber of items with Unique ID: " << unique_item_count << "\n";
+	os << "\t\tNumber of duplicated Unique IDs: " << map->getUniqueIds().getDuplicates().size() << "\n";
 
 	os << "\tCreature data:\n";
 	os << "\t\tTotal creature count: " << creature_count << "\n";
@@ -1797,6 +1752,14 @@ void MainMenuBar::OnMapStatistics(wxCommandEvent& WXUNUSED(event))
 	if(largest_house)
 		os << "\t\tLargest House: \"" << largest_house->name << "\" (" << largest_house_size << " sqm)\n";
 
+	os << "\tAllocator data (all open maps):\n";
+	for(const SlabPool* pool : {&MapAllocator::getTilePool(), &MapAllocator::getFloorPool(), &MapAllocator::getNodePool(), &MapAllocator::getItemPool()}) {
+		const SlabPool::Statistics statistics = pool->getStatistics();
+		os << "\t\t" << pool->getName() << ": " << statistics.live << " in use, "
+			<< statistics.allocations << " allocated since startup, "
+			<< statistics.slabs << " slabs (" << statistics.bytes / 1024 << " KB)\n";
+	}
+
 	os << "\n";
 	os << "Generated by Remere's Map Editor version " + __RME_VERSION__ + "\n";
 
@@ -2199,7 +2162,28 @@ void MainMenuBar::SearchItems(bool unique, bool action, bool container, bool wri
 	searcher.search_container = container;
 	searcher.search_writeable = writable;
 
-	foreach_ItemOnMap(g_gui.GetCurrentMap(), searcher, onSelection);
+	Map& map = g_gui.GetCurrentMap();
+	if(map.hasItemIndex() && !container && !zones) {
+		// Nothing but indexed attributes, no need to look at every item
+		std::vector<std::pair<Tile*, Item*>> indexed;
+		if(unique)
+			map.findAttributeItems(ItemAttributeIndex::UNIQUE_ID, 1, 0xFFFF, onSelection, 0, indexed);
+		if(action)
+			map.findAttributeItems(ItemAttributeIndex::ACTION_ID, 1, 0xFFFF, onSelection, 0, indexed);
+		if(writable)
+			map.findAttributeItems(ItemAttributeIndex::TEXT, 0, 0xFFFF, onSelection, 0, indexed);
+
+		std::set<Item*> listed;
+		for(const std::pair<Tile*, Item*>& entry : indexed) {
+			if(listed.insert(entry.second).second)
+				searcher.found.push_back(entry);
+		}
+		std::stable_sort(searcher.found.begin(), searcher.found.end(), [](const std::pair<Tile*, Item*>& pair1, const std::pair<Tile*, Item*>& pair2) {
+			return pair1.first->getPosition() < pair2.first->getPosition();
+		});
+	} else {
+		parallel_foreach_ItemOnMap(map, searcher, onSelection, UpdateLoadBar);
+	}
 	searcher.sort();
 	std::vector<std::pair<Tile*, Item*> >& found = searcher.found;
 
@@ -2212,6 +2196,57 @@ void MainMenuBar::SearchItems(bool unique, bool action, bool container, bool wri
 	}
 }
 
+void MainMenuBar::SearchIdRange(bool unique)
+{
+	if(!g_gui.IsEditorOpen())
+		return;
+
+	const wxString kind = unique ? "Unique" : "Action";
+	wxString text = wxGetTextFromUser("Enter an ID or a range of IDs, like 1000-2000:", "Find " + kind + " ID Range", wxEmptyString, frame);
+	text.Trim(true).Trim(false);
+	if(text.IsEmpty())
+		return;
+
+	unsigned long first = 0;
+	unsigned long last = 0;
+	wxString firstText = text.BeforeFirst('-').Trim(true);
+	wxString lastText = text.Contains("-") ? text.AfterFirst('-').Trim(false) : firstText;
+	if(!firstText.ToULong(&first) || !lastText.ToULong(&last) || first == 0 || first > last || last > 0xFFFF) {
+		g_gui.PopupDialog("Find " + kind + " ID Range", "\"" + text + "\" is not an ID or a range of IDs between 1 and 65535.", wxOK);
+		return;
+	}
+
+	g_gui.CreateLoadBar("Searching on map...");
+
+	Map& map = g_gui.GetCurrentMap();
+	OnSearchForIdRange::Finder finder;
+	finder.attribute = unique ? ItemAttributeIndex::UNIQUE_ID : ItemAttributeIndex::ACTION_ID;
+	finder.first = static_cast<uint16_t>(first);
+	finder.last = static_cast<uint16_t>(last);
+	if(map.hasItemIndex()) {
+		map.findAttributeItems(finder.attribute, finder.first, finder.last, false, 0, finder.found);
+	} else {
+		parallel_foreach_ItemOnMap(map, finder, false, UpdateLoadBar);
+		std::stable_sort(finder.found.begin(), finder.found.end(), [&finder](const std::pair<Tile*, Item*>& pair1, const std::pair<Tile*, Item*>& pair2) {
+			uint16_t value1 = 0;
+			uint16_t value2 = 0;
+			ItemAttributeIndex::getValue(pair1.second, finder.attribute, value1);
+			ItemAttributeIndex::getValue(pair2.second, finder.attribute, value2);
+			return value1 < value2;
+		});
+	}
+
+	g_gui.DestroyLoadBar();
+
+	SearchResultWindow* result = g_gui.ShowSearchWindow();
+	result->Clear();
+	for(const std::pair<Tile*, Item*>& entry : finder.found) {
+		wxString label;
+		label << (unique ? "UID: " : "AID: ") << (unique ? entry.second->getUniqueID() : entry.second->getActionID()) << " " << wxstr(entry.second->getName());
+		result->AddPosition(label, entry.first->getPosition());
+	}
+}
+
 void MainMenuBar::SearchDuplicatedItems(bool selection)
 {
 	if(!g_gui.IsEditorOpen()) {
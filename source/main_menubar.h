@@ -48,9 +48,12 @@ namespace MenuBar
 		SEARCH_ON_MAP_ZONES,
 		SEARCH_ON_MAP_UNIQUE,
 		SEARCH_ON_MAP_ACTION,
+		SEARCH_ON_MAP_UNIQUE_RANGE,
+		SEARCH_ON_MAP_ACTION_RANGE,
 		SEARCH_ON_MAP_CONTAINER,
 		SEARCH_ON_MAP_WRITEABLE,
 		SEARCH_ON_MAP_DUPLICATED_ITEMS,
+		SEARCH_ON_MAP_DUPLICATED_UNIQUE,
 		SEARCH_ON_SELECTION_EVERYTHING,
 		SEARCH_ON_SELECTION_ZONES,
 		SEARCH_ON_SELECTION_UNIQUE,
@@ -234,9 +237,12 @@ public:
 	void OnSearchForZonesOnMap(wxCommandEvent& event);
 	void OnSearchForUniqueOnMap(wxCommandEvent& event);
 	void OnSearchForActionOnMap(wxCommandEvent& event);
+	void OnSearchForUniqueRangeOnMap(wxCommandEvent& event);
+	void OnSearchForActionRangeOnMap(wxCommandEvent& event);
 	void OnSearchForContainerOnMap(wxCommandEvent& event);
 	void OnSearchForWriteableOnMap(wxCommandEvent& event);
 	void OnSearchForDuplicatedItemsOnMap(wxCommandEvent& event);
+	void OnSearchForDuplicatedUniqueOnMap(wxCommandEvent& event);
 
 	// Select menu
 	void OnSearchForStuffOnSelection(wxCommandEvent& event);
@@ -301,6 +307,8 @@ protected:
 	// Checks the items in the menus according to the settings (in config)
 	void LoadValues();
 	void SearchItems(bool unique, bool action, bool container, bool writable, bool zones, bool onSelection = false);
+	// Asks for an id or a range of ids and lists the items using them
+	void SearchIdRange(bool unique);
 	void SearchDuplicatedItems(bool selection);
 
 protected:
@@ -29,7 +29,9 @@ Map::Map() : BaseMap(),
 	houses(*this),
 	has_changed(false),
 	unnamed(false),
-	waypoints(*this)
+	waypoints(*this),
+	item_index_enabled(false),
+	statistics_stale(false)
 {
 	// Earliest version possible
 	// Caller is responsible for converting us to proper version
@@ -49,9 +51,16 @@ bool Map::open(const std::string file)
 
 	tilecount = 0;
 
+	// Indexed and counted in one go once everything is loaded
+	const bool indexed = item_index_enabled;
+	setItemIndexEnabled(false);
+	statistics_stale = true;
+
 	IOMapOTBM maploader(getVersion());
 
 	bool success = maploader.loadMap(*this, wxstr(file));
+	setItemIndexEnabled(indexed);
+	getStatistics();
 
 	mapVersion = maploader.version;
 
@@ -151,6 +160,9 @@ bool Map::convert(const ConversionMap& rm, bool showdialog)
 	uint64_t tiles_done = 0;
 	std::vector<uint16_t> id_list;
 
+	// Items are replaced in place all over the map
+	saved_areas.clear();
+
 	//std::ofstream conversions("converted_items.txt");
 
 	for(MapIterator miter = begin(); miter != end(); ++miter) {
@@ -264,6 +276,12 @@ bool Map::convert(const ConversionMap& rm, bool showdialog)
 		}
 	}
 
+	if(item_index_enabled) {
+		itemIndex.clear();
+		buildItemIndex(itemIndex, attributeIndex);
+	}
+	statistics_stale = true;
+
 	if(showdialog)
 		g_gui.DestroyLoadBar();
 
@@ -290,6 +308,7 @@ void Map::cleanInvalidTiles(bool showdialog)
 			else {
 				delete *item_iter;
 				item_iter = tile->items.erase(item_iter);
+				markTileChanged(tile->getX(), tile->getY(), tile->getZ());
 			}
 		}
 
@@ -355,120 +374,59 @@ void Map::setSpawnFilename(const std::string&  new_spawnfile)
 
 bool Map::addSpawn(Tile* tile)
 {
-	Spawn* spawn = tile->spawn;
-	if(spawn) {
-		int z = tile->getZ();
-		int start_x = tile->getX() - spawn->getSize();
-		int start_y = tile->getY() - spawn->getSize();
-		int end_x = tile->getX() + spawn->getSize();
-		int end_y = tile->getY() + spawn->getSize();
-
-		for(int y = start_y; y <= end_y; ++y) {
-			for(int x = start_x; x <= end_x; ++x) {
-				TileLocation* ctile_loc = createTileL(x, y, z);
-				ctile_loc->increaseSpawnCount();
-			}
-		}
+	if(tile->spawn) {
 		spawns.addSpawn(tile);
+		markSpawnAreaDirty(tile);
 		return true;
 	}
 	return false;
 }
 
-void Map::removeSpawnInternal(Tile* tile)
-{
-	Spawn* spawn = tile->spawn;
-	ASSERT(spawn);
-
-	int z = tile->getZ();
-	int start_x = tile->getX() - spawn->getSize();
-	int start_y = tile->getY() - spawn->getSize();
-	int end_x = tile->getX() + spawn->getSize();
-	int end_y = tile->getY() + spawn->getSize();
-
-	for(int y = start_y; y <= end_y; ++y) {
-		for(int x = start_x; x <= end_x; ++x) {
-			TileLocation* ctile_loc = getTileL(x, y, z);
-			if(ctile_loc != nullptr && ctile_loc->getSpawnCount() > 0)
-				ctile_loc->decreaseSpawnCount();
-		}
-	}
-}
-
 void Map::removeSpawn(Tile* tile)
 {
 	if(tile->spawn) {
-		removeSpawnInternal(tile);
 		spawns.removeSpawn(tile);
+		markSpawnAreaDirty(tile);
 	}
 }
 
-SpawnList Map::getSpawnList(const Tile* tile) const
+void Map::markSpawnAreaDirty(const Tile* tile)
 {
-	SpawnList list;
-	if(!tile) return list;
-
-	const TileLocation* location = tile->getLocation();
-	if(!location || location->getSpawnCount() == 0)
-		return list;
-
-	uint32_t found = 0;
-	if(tile->spawn) {
-		++found;
-		list.push_back(tile->spawn);
-	}
-
-	// Scans the border tiles in an expanding square around the original spawn
+	// Which empty tiles are saved depends on the spawn areas, see getTileSize
 	const Position& position = tile->getPosition();
-	int start_x = position.x - 1;
-	int end_x = position.x + 1;
-	int start_y = position.y - 1;
-	int end_y = position.y + 1;
-
-	while(found != location->getSpawnCount()) {
-		for(int x = start_x; x <= end_x; ++x) {
-			const Tile* start_tile = getTile(x, start_y, position.z);
-			if(start_tile && start_tile->spawn) {
-				list.push_back(start_tile->spawn);
-				++found;
-			}
-			const Tile* end_tile = getTile(x, end_y, position.z);
-			if(end_tile && end_tile->spawn) {
-				list.push_back(end_tile->spawn);
-				++found;
-			}
-		}
+	const int radius = tile->spawn->getSize();
+	saved_areas.markDirty(position.x - radius, position.y - radius, position.x + radius, position.y + radius, position.z);
+}
 
-		for(int y = start_y + 1; y < end_y; ++y) {
-			const Tile* start_tile = getTile(start_x, y, position.z);
-			if(start_tile && start_tile->spawn) {
-				list.push_back(start_tile->spawn);
-				++found;
-			}
-			const Tile* end_tile = getTile(end_x, y, position.z);
-			if(end_tile && end_tile->spawn) {
-				list.push_back(end_tile->spawn);
-				++found;
-			}
-		}
-		--start_x;
-		--start_y;
-		++end_x;
-		++end_y;
-	}
-	return list;
+int Map::getTileSize(const Tile* tile) const
+{
+	const int size = tile->size();
+	if(size == 0 && spawns.getSpawnCount(tile->getPosition()) != 0)
+		return 1;
+	return size;
+}
+
+SpawnList Map::getSpawnList(const Tile* tile) const
+{
+	if(!tile) return SpawnList();
+	return getSpawnList(tile->getPosition());
 }
 
 SpawnList Map::getSpawnList(const Position& position) const
 {
-	const Tile* tile = getTile(position);
-	return getSpawnList(tile);
+	SpawnList list;
+	spawns.forEachSpawn(position, [&](const Position& center, int) {
+		const Tile* tile = getTile(center);
+		if(tile && tile->spawn) {
+			list.push_back(tile->spawn);
+		}
+	});
+	return list;
 }
 
 SpawnList Map::getSpawnList(int x, int y, int z) const
 {
-	const Tile* tile = getTile(x, y, z);
-	return getSpawnList(tile);
+	return getSpawnList(Position(x, y, z));
 }
 
 bool Map::exportMinimap(FileName filename, int floor /*= rme::MapGroundLayer*/, bool displaydialog)
@@ -623,62 +581,372 @@ bool Map::exportMinimap(FileName filename, int floor /*= rme::MapGroundLayer*/,
 	return true;
 }
 
+void Map::markTileReplaced(int x, int y, int z, Tile* old_tile, Tile* new_tile)
+{
+	BaseMap::markTileReplaced(x, y, z, old_tile, new_tile);
+	saved_areas.markDirty(x, y, z);
+	updateUniqueIds(old_tile, new_tile);
+	markHouseDoorsChanged(old_tile);
+	markHouseDoorsChanged(new_tile);
+
+	static const std::vector<uint16_t> no_zones;
+	const std::vector<uint16_t>& old_zones = old_tile ? old_tile->getZoneIds() : no_zones;
+	const std::vector<uint16_t>& new_zones = new_tile ? new_tile->getZoneIds() : no_zones;
+	if(!old_zones.empty() || !new_zones.empty()) {
+		zones.update(Position(x, y, z), old_zones, new_zones);
+	}
+
+	if(item_index_enabled) {
+		if(new_tile) {
+			itemIndex.addTile(new_tile);
+			attributeIndex.addTile(new_tile);
+		}
+		if(old_tile) {
+			removeItemIds(old_tile);
+			attributeIndex.removeTile(old_tile, new_tile);
+		}
+	}
+
+	// Not worth it while everything is going to be counted again
+	if(!statistics_stale) {
+		statistics.removeTile(old_tile);
+		statistics.addTile(new_tile);
+	}
+}
+
 void Map::updateUniqueIds(Tile* old_tile, Tile* new_tile)
 {
 	if(old_tile && old_tile->hasUniqueItem()) {
+		const Position& position = old_tile->getPosition();
 		if(old_tile->ground) {
 			uint16_t uid = old_tile->ground->getUniqueID();
 			if(uid != 0)
-				removeUniqueId(uid);
+				removeUniqueId(uid, position);
 		}
 		for(const Item* item : old_tile->items) {
 			if(item) {
 				uint16_t uid = item->getUniqueID();
 				if(uid != 0) {
-					removeUniqueId(uid);
+					removeUniqueId(uid, position);
 				}
 			}
 		}
 	}
 
 	if(new_tile && new_tile->hasUniqueItem()) {
+		const Position& position = new_tile->getPosition();
 		if(new_tile->ground) {
 			uint16_t uid = new_tile->ground->getUniqueID();
 			if(uid != 0)
-				addUniqueId(uid);
+				addUniqueId(uid, position);
 		}
 		for(const Item* item : new_tile->items) {
 			if(item) {
 				uint16_t uid = item->getUniqueID();
 				if(uid != 0) {
-					addUniqueId(uid);
+					addUniqueId(uid, position);
 				}
 			}
 		}
 	}
 }
 
-void Map::addUniqueId(uint16_t uid)
+void Map::markTileChanged(int x, int y, int z)
 {
-	auto it = std::find(uniqueIds.begin(), uniqueIds.end(), uid);
-	if (it == uniqueIds.end()) {
-		uniqueIds.push_back(uid);
+	BaseMap::markTileChanged(x, y, z);
+	saved_areas.markDirty(x, y, z);
+	Tile* tile = getTile(x, y, z);
+	if(item_index_enabled && tile) {
+		itemIndex.addTile(tile);
+		attributeIndex.addTile(tile);
+	}
+	markHouseDoorsChanged(tile);
+	// Zone ids are only ever added to tiles in place (when zones are loaded)
+	if(tile) {
+		for(uint16_t zone_id : tile->getZoneIds()) {
+			zones.add(zone_id, tile->getPosition());
+		}
 	}
+	// What the tile held before is not known anymore
+	statistics_stale = true;
+}
+
+void Map::markTileHouseChanged(int x, int y, int z)
+{
+	saved_areas.markDirty(x, y, z);
+	markLeafChanged(x, y);
 }
 
-void Map::removeUniqueId(uint16_t uid)
+void Map::markHouseDoorsChanged(const Tile* tile)
 {
-	auto it = std::find(uniqueIds.begin(), uniqueIds.end(), uid);
-	if (it != uniqueIds.end()) {
-		uniqueIds.erase(it);
+	if(tile && tile->isHouseTile()) {
+		if(House* house = houses.getHouse(tile->getHouseID()))
+			house->markDoorsChanged();
 	}
 }
 
+const MapStatistics& Map::getStatistics()
+{
+	if(statistics_stale) {
+		statistics = MapStatistics();
+		parallel_foreach_TileOnMap(*this, statistics, [](uint64_t, uint64_t) {});
+		statistics_stale = false;
+	}
+	return statistics;
+}
+
+bool Map::checkStatistics()
+{
+	if(statistics_stale)
+		return true;
+
+	MapStatistics counted;
+	parallel_foreach_TileOnMap(*this, counted, [](uint64_t, uint64_t) {});
+	if(counted == statistics)
+		return true;
+
+	wxLogWarning("The map statistics were off (kept/counted: %s), they have been corrected.",
+		statistics.describeDifferences(counted).c_str());
+	statistics = counted;
+	return false;
+}
+
+HouseStatistics Map::getHouseStatistics() const
+{
+	return HouseStatistics(houses);
+}
+
+void Map::addUniqueId(uint16_t uid, const Position& position)
+{
+	uniqueIds.add(uid, position);
+}
+
+void Map::removeUniqueId(uint16_t uid, const Position& position)
+{
+	uniqueIds.remove(uid, position);
+}
+
 bool Map::hasUniqueId(uint16_t uid) const
 {
-	if (uid < rme::MinUniqueId || uniqueIds.empty())
+	if(uid < rme::MinUniqueId)
 		return false;
+	return uniqueIds.contains(uid);
+}
+
+std::map<uint16_t, PositionVector> Map::getDuplicateUniqueIds() const
+{
+	std::map<uint16_t, PositionVector> result;
+	for(uint16_t uid : uniqueIds.getDuplicates())
+		result.emplace(uid, uniqueIds.getPositions(uid));
+	return result;
+}
+
+namespace {
+	// Lists the ids of every cell once, the tiles of a cell are visited one after another
+	struct ItemIdCollector
+	{
+		std::vector<uint64_t> entries; // id << 32 | cell
+		std::vector<ItemAttributeIndex::Entry> attributes;
+		std::vector<uint16_t> cell_ids;
+		uint32_t cell = 0xFFFFFFFF; // None yet
+
+		void operator()(Map& map, Tile* tile)
+		{
+			const uint32_t tile_cell = ItemIdIndex::getCell(tile->getPosition());
+			if(tile_cell != cell) {
+				cell = tile_cell;
+				cell_ids.clear();
+			}
+
+			foreach_ItemOnTile(tile, [&](Item* item) {
+				const uint16_t id = item->getID();
+				if(std::find(cell_ids.begin(), cell_ids.end(), id) == cell_ids.end()) {
+					cell_ids.push_back(id);
+					entries.push_back(uint64_t(id) << 32 | cell);
+				}
+			});
+			ItemAttributeIndex::getEntries(tile, attributes);
+		}
+
+		void merge(const ItemIdCollector& other)
+		{
+			entries.insert(entries.end(), other.entries.begin(), other.entries.end());
+			attributes.insert(attributes.end(), other.attributes.begin(), other.attributes.end());
+		}
+	};
+
+	Floor* getCellFloor(BaseMap& map, const Position& position)
+	{
+		QTreeNode* leaf = map.getLeaf(position.x, position.y);
+		return leaf ? leaf->getFloor(position.z) : nullptr;
+	}
+}
+
+void Map::setItemIndexEnabled(bool enabled)
+{
+	if(enabled == item_index_enabled)
+		return;
+
+	item_index_enabled = enabled;
+	itemIndex.clear();
+	attributeIndex.clear();
+	if(enabled)
+		buildItemIndex(itemIndex, attributeIndex);
+}
 
-	auto it = std::find(uniqueIds.begin(), uniqueIds.end(), uid);
-	return it != uniqueIds.end();
+void Map::buildItemIndex(ItemIdIndex& index, ItemAttributeIndex& attributes)
+{
+	ItemIdCollector collector;
+	parallel_foreach_TileOnMap(*this, collector, [](uint64_t, uint64_t) {});
+
+	std::vector<uint32_t> counts(0x10000, 0);
+	for(uint64_t entry : collector.entries)
+		++counts[entry >> 32];
+	for(uint32_t id = 0; id < counts.size(); ++id) {
+		if(counts[id] != 0)
+			index.reserve(static_cast<uint16_t>(id), counts[id]);
+	}
+
+	for(uint64_t entry : collector.entries)
+		index.add(static_cast<uint16_t>(entry >> 32), static_cast<uint32_t>(entry));
+
+	attributes.assign(collector.attributes);
+}
+
+void Map::removeItemIds(Tile* old_tile)
+{
+	std::vector<uint16_t> ids;
+	foreach_ItemOnTile(old_tile, [&](Item* item) {
+		ids.push_back(item->getID());
+	});
+	if(ids.empty())
+		return;
+
+	const Position& position = old_tile->getPosition();
+	std::vector<uint16_t> remaining;
+	if(Floor* floor = getCellFloor(*this, position)) {
+		for(TileLocation& location : floor->locs) {
+			if(Tile* tile = location.get()) {
+				foreach_ItemOnTile(tile, [&](Item* item) {
+					remaining.push_back(item->getID());
+				});
+			}
+		}
+	}
+	std::sort(remaining.begin(), remaining.end());
+
+	const uint32_t cell = ItemIdIndex::getCell(position);
+	for(uint16_t id : ids) {
+		if(!std::binary_search(remaining.begin(), remaining.end(), id))
+			itemIndex.remove(id, cell);
+	}
+}
+
+void Map::findItems(uint16_t id, bool selectedOnly, size_t limit, std::vector<std::pair<Tile*, Item*>>& result)
+{
+	ASSERT(item_index_enabled);
+
+	std::vector<uint32_t> cells;
+	itemIndex.getCells(id, cells);
+	for(uint32_t cell : cells) {
+		if(limit != 0 && result.size() >= limit)
+			return;
+
+		bool found = false;
+		if(Floor* floor = getCellFloor(*this, ItemIdIndex::getCellPosition(cell))) {
+			for(TileLocation& location : floor->locs) {
+				Tile* tile = location.get();
+				if(!tile)
+					continue;
+
+				foreach_ItemOnTile(tile, [&](Item* item) {
+					if(item->getID() != id)
+						return;
+					found = true;
+					if(selectedOnly && !tile->isSelected())
+						return;
+					if(limit == 0 || result.size() < limit)
+						result.push_back(std::make_pair(tile, item));
+				});
+			}
+		}
+
+		// Left over from a tile that was changed in place
+		if(!found)
+			itemIndex.remove(id, cell);
+	}
+}
+
+Map::ItemIndexCheck Map::checkItemIndex()
+{
+	ItemIndexCheck check;
+	if(!item_index_enabled)
+		return check;
+
+	ItemIdIndex scanned;
+	ItemAttributeIndex scanned_attributes;
+	buildItemIndex(scanned, scanned_attributes);
+
+	std::vector<uint32_t> indexed;
+	std::vector<uint32_t> present;
+	for(uint32_t id = 0; id < 0x10000; ++id) {
+		itemIndex.getCells(static_cast<uint16_t>(id), indexed);
+		scanned.getCells(static_cast<uint16_t>(id), present);
+
+		std::vector<uint32_t> difference;
+		std::set_difference(present.begin(), present.end(), indexed.begin(), indexed.end(), std::back_inserter(difference));
+		for(uint32_t cell : difference)
+			itemIndex.add(static_cast<uint16_t>(id), cell);
+		check.missing += difference.size();
+
+		difference.clear();
+		std::set_difference(indexed.begin(), indexed.end(), present.begin(), present.end(), std::back_inserter(difference));
+		for(uint32_t cell : difference)
+			itemIndex.remove(static_cast<uint16_t>(id), cell);
+		check.stale += difference.size();
+	}
+
+	std::vector<ItemAttributeIndex::Entry> indexed_attributes;
+	std::vector<ItemAttributeIndex::Entry> present_attributes;
+	attributeIndex.getEntries(indexed_attributes);
+	scanned_attributes.getEntries(present_attributes);
+
+	std::vector<ItemAttributeIndex::Entry> difference;
+	std::set_difference(present_attributes.begin(), present_attributes.end(), indexed_attributes.begin(), indexed_attributes.end(), std::back_inserter(difference));
+	check.missing += difference.size();
+	difference.clear();
+	std::set_difference(indexed_attributes.begin(), indexed_attributes.end(), present_attributes.begin(), present_attributes.end(), std::back_inserter(difference));
+	check.stale += difference.size();
+	attributeIndex.assign(present_attributes);
+	return check;
+}
+
+void Map::findAttributeItems(ItemAttributeIndex::Attribute attribute, uint16_t first, uint16_t last, bool selectedOnly, size_t limit, std::vector<std::pair<Tile*, Item*>>& result)
+{
+	ASSERT(item_index_enabled);
+
+	std::vector<ItemAttributeIndex::Entry> entries;
+	attributeIndex.find(attribute, first, last, entries);
+	for(const ItemAttributeIndex::Entry& entry : entries) {
+		if(limit != 0 && result.size() >= limit)
+			return;
+
+		bool found = false;
+		if(Tile* tile = getTile(entry.position)) {
+			foreach_ItemOnTile(tile, [&](Item* item) {
+				uint16_t value;
+				if(!ItemAttributeIndex::getValue(item, attribute, value) || value != entry.value)
+					return;
+				found = true;
+				if(selectedOnly && !tile->isSelected())
+					return;
+				if(limit == 0 || result.size() < limit)
+					result.push_back(std::make_pair(tile, item));
+			});
+		}
+
+		// Left over from a tile that was changed in place
+		if(!found)
+			attributeIndex.remove(attribute, entry.value, entry.position);
+	}
 }
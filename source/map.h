@@ -25,7 +25,14 @@
 #include "spawn.h"
 #include "complexitem.h"
 #include "waypoints.h"
+#include "zones.h"
 #include "templates.h"
+#include "unique_id_registry.h"
+#include "item_attribute_index.h"
+#include "item_id_index.h"
+#include "map_statistics.h"
+#include "otbm_area_index.h"
+#include "worker_pool.h"
 
 class Map : public BaseMap
 {
@@ -62,6 +69,9 @@ public:
 	bool addSpawn(Tile* spawn);
 	void removeSpawn(Tile* tile);
 	void removeSpawn(const Position& position) { removeSpawn(getTile(position)); }
+	// Tile::size(), except that an empty tile in a spawn area counts as one.
+	// Such tiles are kept and saved, the tile can't tell that by itself.
+	int getTileSize(const Tile* tile) const;
 
 	// Returns all possible spawns on the target tile
 	SpawnList getSpawnList(const Tile* tile) const;
@@ -92,13 +102,50 @@ public:
 	void flagAsNamed() noexcept { unnamed = false; }
 
 	bool hasUniqueId(uint16_t uid) const;
+	// Every position of every unique id used more than once
+	std::map<uint16_t, PositionVector> getDuplicateUniqueIds() const;
+	const UniqueIdRegistry& getUniqueIds() const noexcept { return uniqueIds; }
+
+	// Where every item id is used (see ItemIdIndex), it is only kept up to
+	// date while enabled. Enabling it indexes the whole map.
+	void setItemIndexEnabled(bool enabled);
+	bool hasItemIndex() const noexcept { return item_index_enabled; }
+	const ItemIdIndex& getItemIndex() const noexcept { return itemIndex; }
+	// Answered from the index, which has to be enabled: the items with the id
+	// in the order foreach_ItemOnMap visits them, at most 'limit' (0 for all)
+	void findItems(uint16_t id, bool selectedOnly, size_t limit, std::vector<std::pair<Tile*, Item*>>& result);
+	// Kept along with the item index (see ItemAttributeIndex)
+	const ItemAttributeIndex& getAttributeIndex() const noexcept { return attributeIndex; }
+	// Answered from the index: the items with values of the attribute in
+	// [first, last], ordered by value, at most 'limit' (0 for all)
+	void findAttributeItems(ItemAttributeIndex::Attribute attribute, uint16_t first, uint16_t last, bool selectedOnly, size_t limit, std::vector<std::pair<Tile*, Item*>>& result);
+
+	struct ItemIndexCheck
+	{
+		uint64_t missing = 0; // Errors, ids the index didn't list
+		uint64_t stale = 0; // Entries of ids no longer there, these are expected
+	};
+	// Compares the index with a full scan of the map and corrects it
+	ItemIndexCheck checkItemIndex();
+
+	// Tile and item counts, counted again (on the worker threads) if tiles
+	// were changed in place since the last time
+	const MapStatistics& getStatistics();
+	// Compares the kept counts with a new count, logs the differences and
+	// corrects them, false if they were off. Counts the whole map, for debugging.
+	bool checkStatistics();
+	// Counted from the tile lists of the houses every time
+	HouseStatistics getHouseStatistics() const;
+
+	void markTileChanged(int x, int y, int z) override;
+	// Lighter markTileChanged for tiles that only joined or left a house
+	void markTileHouseChanged(int x, int y, int z);
 
 protected:
 	// Loads a map
 	bool open(const std::string identifier);
 
 protected:
-	void removeSpawnInternal(Tile* tile);
 
 	wxArrayString warnings;
 	wxString error;
@@ -119,11 +166,20 @@ public:
 	Towns towns;
 	Houses houses;
 	Spawns spawns;
+	// Mirrors the zone ids of the tiles
+	Zones zones;
 
 protected:
-	void updateUniqueIds(Tile* old_tile, Tile* new_tile) override;
-	void addUniqueId(uint16_t uid);
-	void removeUniqueId(uint16_t uid);
+	void markTileReplaced(int x, int y, int z, Tile* old_tile, Tile* new_tile) override;
+	void updateUniqueIds(Tile* old_tile, Tile* new_tile);
+	// The doors of a house tile may have changed
+	void markHouseDoorsChanged(const Tile* tile);
+	void markSpawnAreaDirty(const Tile* tile);
+	void buildItemIndex(ItemIdIndex& index, ItemAttributeIndex& attributes);
+	// Removes the ids of a tile that left the map from its cell, unless other tiles there hold them
+	void removeItemIds(Tile* old_tile);
+	void addUniqueId(uint16_t uid, const Position& position);
+	void removeUniqueId(uint16_t uid, const Position& position);
 
 	bool has_changed; // If the map has changed
 	bool unnamed; // If the map has yet to receive a name
@@ -136,9 +192,44 @@ public:
 	Waypoints waypoints;
 
 private:
-	std::vector<uint16_t> uniqueIds;
+	UniqueIdRegistry uniqueIds;
+	ItemIdIndex itemIndex;
+	ItemAttributeIndex attributeIndex;
+	bool item_index_enabled;
+	MapStatistics statistics;
+	bool statistics_stale;
+	// Tile areas of the file the map was last loaded from or saved to
+	OTBMAreaIndex saved_areas;
 };
 
+// Calls f(item) for the ground, the items and the contents of containers
+// (breadth first, after the container itself) of a tile
+template <typename ForeachType>
+inline void foreach_ItemOnTile(Tile* tile, ForeachType&& f)
+{
+	if(tile->ground) {
+		f(tile->ground);
+	}
+
+	std::queue<Container*> containers;
+	for(Item* item : tile->items) {
+		f(item);
+		if(Container* container = dynamic_cast<Container*>(item)) {
+			containers.push(container);
+			do {
+				container = containers.front();
+				for(Item* contained : container->getVector()) {
+					f(contained);
+					if(Container* c = dynamic_cast<Container*>(contained)) {
+						containers.push(c);
+					}
+				}
+				containers.pop();
+			} while(containers.size());
+		}
+	}
+}
+
 template <typename ForeachType>
 inline void foreach_ItemOnMap(Map& map, ForeachType& foreach, bool selectedTiles)
 {
@@ -154,33 +245,9 @@ inline void foreach_ItemOnMap(Map& map, ForeachType& foreach, bool selectedTiles
 			continue;
 		}
 
-		if(tile->ground) {
-			foreach(map, tile, tile->ground, done);
-		}
-
-		std::queue<Container*> containers;
-		for(ItemVector::iterator itemiter = tile->items.begin(); itemiter != tile->items.end(); ++itemiter) {
-			Item* item = *itemiter;
-			Container* container = dynamic_cast<Container*>(item);
+		foreach_ItemOnTile(tile, [&](Item* item) {
 			foreach(map, tile, item, done);
-			if(container) {
-				containers.push(container);
-
-				do {
-					container = containers.front();
-					ItemVector& v = container->getVector();
-					for(ItemVector::iterator containeriter = v.begin(); containeriter != v.end(); ++containeriter) {
-						Item* i = *containeriter;
-						Container* c = dynamic_cast<Container*>(i);
-						foreach(map, tile, i, done);
-						if(c) {
-							containers.push(c);
-						}
-					}
-					containers.pop();
-				} while(containers.size());
-			}
-		}
+		});
 		++tileiter;
 	}
 }
@@ -234,6 +301,7 @@ inline int64_t RemoveItemOnMap(Map& map, RemoveIfType& condition, bool selectedO
 			continue;
 		}
 
+		const int64_t removed_before = removed;
 		if(tile->ground) {
 			if(condition(map, tile->ground, removed, done)) {
 				delete tile->ground;
@@ -252,9 +320,179 @@ inline int64_t RemoveItemOnMap(Map& map, RemoveIfType& condition, bool selectedO
 			else
 				++iit;
 		}
+
+		if(removed != removed_before) {
+			const Position& position = tile->getPosition();
+			map.markTileChanged(position.x, position.y, position.z);
+		}
 		++it;
 	}
 	return removed;
 }
 
+// Splits the map into blocks of whole leaves for the parallel traversals
+// below. There are many more blocks than threads, a thread that is done
+// with its block claims the next free one, so uneven areas even out.
+class MapPartition
+{
+public:
+	explicit MapPartition(Map& map, size_t threads = 0);
+
+	size_t getBlockCount() const noexcept { return block_count; }
+
+	// Calls visit(block, tile) for every tile on the worker threads, the tiles
+	// of a block are visited in map order by one thread. progress(done, total)
+	// is only ever called on the calling thread.
+	template <typename VisitType, typename ProgressType>
+	void run(VisitType visit, ProgressType progress);
+
+private:
+	Map& map;
+	WorkerPool pool;
+	std::vector<QTreeNode*> leaves;
+	size_t leaves_per_block;
+	size_t block_count;
+};
+
+inline MapPartition::MapPartition(Map& map, size_t threads) :
+	map(map),
+	pool(threads),
+	leaves_per_block(1),
+	block_count(0)
+{
+	map.getLeaves(leaves);
+	if(leaves.empty())
+		return;
+
+	const size_t wanted = pool.getThreadCount() * 16;
+	leaves_per_block = std::max<size_t>(1, leaves.size() / wanted);
+	block_count = (leaves.size() + leaves_per_block - 1) / leaves_per_block;
+}
+
+template <typename VisitType, typename ProgressType>
+void MapPartition::run(VisitType visit, ProgressType progress)
+{
+	const std::thread::id caller = std::this_thread::get_id();
+	const uint64_t total = map.getTileCount();
+	std::atomic<uint64_t> done(0);
+
+	pool.run(block_count, [&](size_t block) {
+		const size_t first = block * leaves_per_block;
+		const size_t last = std::min(first + leaves_per_block, leaves.size());
+		uint64_t visited = 0;
+		for(size_t index = first; index < last; ++index) {
+			QTreeNode* leaf = leaves[index];
+			for(uint32_t z = 0; z < rme::MapLayers; ++z) {
+				Floor* floor = leaf->getFloor(z);
+				if(!floor)
+					continue;
+				for(TileLocation& location : floor->locs) {
+					if(Tile* tile = location.get()) {
+						visit(block, tile);
+						++visited;
+					}
+				}
+			}
+		}
+
+		const uint64_t now = done += visited;
+		if(std::this_thread::get_id() == caller)
+			progress(now, total);
+	});
+}
+
+// Parallel versions of the traversals above. Every block of the map gets its
+// own copy of the visitor (as it was passed in), the copies are merged back
+// with foreach.merge(copy) in map order once all blocks are done, so the
+// result is the same as that of a sequential walk. Visitors run on worker
+// threads and must neither change the map nor touch the GUI.
+template <typename ForeachType, typename ProgressType>
+inline void parallel_foreach_TileOnMap(Map& map, ForeachType& foreach, ProgressType progress)
+{
+	MapPartition partition(map);
+	std::vector<ForeachType> locals(partition.getBlockCount(), foreach);
+
+	partition.run([&](size_t block, Tile* tile) {
+		locals[block](map, tile);
+	}, progress);
+
+	for(ForeachType& local : locals)
+		foreach.merge(local);
+}
+
+template <typename ForeachType, typename ProgressType>
+inline void parallel_foreach_ItemOnMap(Map& map, ForeachType& foreach, bool selectedTiles, ProgressType progress)
+{
+	MapPartition partition(map);
+	std::vector<ForeachType> locals(partition.getBlockCount(), foreach);
+
+	partition.run([&](size_t block, Tile* tile) {
+		if(selectedTiles && !tile->isSelected())
+			return;
+
+		ForeachType& local = locals[block];
+		foreach_ItemOnTile(tile, [&](Item* item) {
+			local(map, tile, item);
+		});
+	}, progress);
+
+	for(ForeachType& local : locals)
+		foreach.merge(local);
+}
+
+// The condition is shared by all threads, it only decides (condition(map, item)).
+// What it picks is collected per block and removed on the calling thread at the end.
+template <typename RemoveIfType, typename ProgressType>
+inline int64_t parallel_RemoveItemOnMap(Map& map, const RemoveIfType& condition, bool selectedOnly, ProgressType progress)
+{
+	using ItemList = std::vector<std::pair<Tile*, Item*>>;
+
+	MapPartition partition(map);
+	std::vector<ItemList> found(partition.getBlockCount());
+
+	partition.run([&](size_t block, Tile* tile) {
+		if(selectedOnly && !tile->isSelected())
+			return;
+
+		ItemList& list = found[block];
+		if(tile->ground && condition(map, tile->ground)) {
+			list.emplace_back(tile, tile->ground);
+		}
+		for(Item* item : tile->items) {
+			if(condition(map, item)) {
+				list.emplace_back(tile, item);
+			}
+		}
+	}, progress);
+
+	int64_t removed = 0;
+	for(const ItemList& list : found) {
+		auto it = list.begin();
+		while(it != list.end()) {
+			Tile* tile = it->first;
+			if(it->second == tile->ground) {
+				tile->ground = nullptr;
+				delete it->second;
+				++removed;
+				++it;
+			}
+
+			// The rest of the tile's items were found in the order they are stacked in
+			tile->items.erase(std::remove_if(tile->items.begin(), tile->items.end(), [&](Item* item) {
+				if(it != list.end() && it->first == tile && it->second == item) {
+					delete item;
+					++removed;
+					++it;
+					return true;
+				}
+				return false;
+			}), tile->items.end());
+
+			const Position& position = tile->getPosition();
+			map.markTileChanged(position.x, position.y, position.z);
+		}
+	}
+	return removed;
+}
+
 #endif
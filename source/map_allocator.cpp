@@ -0,0 +1,410 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "map_allocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+	// Slabs are aligned to their size, so the slab of any object is found by masking its address
+	constexpr size_t SLAB_SIZE = 64 * 1024;
+	// Empty slabs kept per pool so that a map that keeps creating and deleting a few objects doesn't hit the system allocator
+	constexpr size_t CACHED_EMPTY_SLABS = 4;
+
+	size_t alignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	void* allocateAligned(size_t size)
+	{
+#ifdef _WIN32
+		void* memory = _aligned_malloc(size, size);
+#else
+		void* memory = std::aligned_alloc(size, size);
+#endif
+		if(!memory)
+			throw std::bad_alloc();
+		return memory;
+	}
+
+	void freeAligned(void* memory)
+	{
+#ifdef _WIN32
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+}
+
+struct SlabPool::Slab
+{
+	SlabPool* owner;
+	Slab* prev;
+	Slab* next;
+	void* free_slots; // Singly linked through the first bytes of each freed slot
+	uint32_t used;
+	uint32_t carved; // Slots handed out at least once, the rest have never been touched
+};
+
+// The free slots a thread holds for each pool
+struct SlabPool::ThreadCache
+{
+	struct Bin
+	{
+		void* slots[CACHE_SIZE];
+		// Only the owning thread writes these, getStatistics reads them from other threads
+		std::atomic<uint32_t> count{0};
+		std::atomic<uint64_t> allocations{0}; // Not yet added to the pool's count
+	};
+
+	Bin bins[MAX_POOLS];
+
+	// All live caches, so that the slots they hold can be left out of the live count
+	static std::mutex registry_mutex;
+	static ThreadCache* registry;
+	ThreadCache* prev;
+	ThreadCache* next;
+
+	ThreadCache();
+	~ThreadCache();
+};
+
+std::mutex SlabPool::ThreadCache::registry_mutex;
+SlabPool::ThreadCache* SlabPool::ThreadCache::registry = nullptr;
+
+namespace {
+	std::atomic<size_t> pool_count(0);
+	SlabPool* pools[SlabPool::MAX_POOLS];
+
+	// Objects may still be freed by the destructors of other thread locals
+	// after the cache is gone, they go straight to the pool then
+	thread_local bool thread_cache_destroyed = false;
+}
+
+SlabPool::ThreadCache::ThreadCache() :
+	prev(nullptr),
+	next(nullptr)
+{
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	next = registry;
+	if(next)
+		next->prev = this;
+	registry = this;
+}
+
+SlabPool::ThreadCache::~ThreadCache()
+{
+	for(size_t i = 0; i < MAX_POOLS; ++i) {
+		const uint32_t count = bins[i].count.load(std::memory_order_relaxed);
+		if(count > 0 || bins[i].allocations.load(std::memory_order_relaxed) > 0)
+			pools[i]->flush(*this, count);
+	}
+	thread_cache_destroyed = true;
+
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	if(prev)
+		prev->next = next;
+	else
+		registry = next;
+	if(next)
+		next->prev = prev;
+}
+
+SlabPool::ThreadCache* SlabPool::getThreadCache()
+{
+	if(thread_cache_destroyed)
+		return nullptr;
+	thread_local ThreadCache cache;
+	return &cache;
+}
+
+SlabPool::SlabPool(const char* name, size_t object_size, size_t object_alignment) :
+	name(name),
+	index(pool_count++),
+	slot_size(alignUp(std::max(object_size, sizeof(void*)), std::max(object_alignment, alignof(void*)))),
+	slot_offset(alignUp(sizeof(Slab), std::max(object_alignment, alignof(void*)))),
+	slots_per_slab(static_cast<uint32_t>((SLAB_SIZE - slot_offset) / slot_size)),
+	first(nullptr),
+	last(nullptr),
+	empty_slabs(0),
+	live(0),
+	allocations(0),
+	slab_count(0)
+{
+	ASSERT(slots_per_slab > 0);
+	ASSERT(index < MAX_POOLS);
+	pools[index] = this;
+}
+
+SlabPool::~SlabPool()
+{
+	// Objects that are still alive keep pointing into their slabs
+	if(live == 0)
+		trim();
+}
+
+void* SlabPool::allocate()
+{
+	ThreadCache* cache = getThreadCache();
+	if(!cache) {
+		std::lock_guard<std::mutex> lock(mutex);
+		++allocations;
+		return allocateSlot();
+	}
+
+	ThreadCache::Bin& bin = cache->bins[index];
+	if(bin.count.load(std::memory_order_relaxed) == 0)
+		refill(*cache);
+	bin.allocations.store(bin.allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	const uint32_t count = bin.count.load(std::memory_order_relaxed) - 1;
+	bin.count.store(count, std::memory_order_relaxed);
+	return bin.slots[count];
+}
+
+void SlabPool::release(void* pointer)
+{
+	if(!pointer)
+		return;
+
+	Slab* slab = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(pointer) & ~uintptr_t(SLAB_SIZE - 1));
+	SlabPool* pool = slab->owner;
+
+	ThreadCache* cache = getThreadCache();
+	if(!cache) {
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		pool->releaseSlot(pointer);
+		return;
+	}
+
+	ThreadCache::Bin& bin = cache->bins[pool->index];
+	if(bin.count.load(std::memory_order_relaxed) == CACHE_SIZE)
+		pool->flush(*cache, CACHE_SIZE / 2);
+	const uint32_t count = bin.count.load(std::memory_order_relaxed);
+	bin.slots[count] = pointer;
+	bin.count.store(count + 1, std::memory_order_relaxed);
+}
+
+void SlabPool::refill(ThreadCache& cache)
+{
+	ThreadCache::Bin& bin = cache.bins[index];
+	std::lock_guard<std::mutex> lock(mutex);
+	uint32_t count = bin.count.load(std::memory_order_relaxed);
+	while(count < CACHE_SIZE / 2)
+		bin.slots[count++] = allocateSlot();
+	bin.count.store(count, std::memory_order_relaxed);
+	allocations += bin.allocations.exchange(0, std::memory_order_relaxed);
+}
+
+void SlabPool::flush(ThreadCache& cache, uint32_t count)
+{
+	// The oldest slots go, the ones freed last are the likeliest to be in the CPU cache
+	ThreadCache::Bin& bin = cache.bins[index];
+	const uint32_t cached = bin.count.load(std::memory_order_relaxed);
+	ASSERT(count <= cached);
+	std::lock_guard<std::mutex> lock(mutex);
+	for(uint32_t i = 0; i < count; ++i)
+		releaseSlot(bin.slots[i]);
+	std::copy(bin.slots + count, bin.slots + cached, bin.slots);
+	bin.count.store(cached - count, std::memory_order_relaxed);
+	allocations += bin.allocations.exchange(0, std::memory_order_relaxed);
+}
+
+void* SlabPool::allocateSlot()
+{
+	Slab* slab = first;
+	if(!slab) {
+		slab = createSlab();
+		link(slab, true);
+		++empty_slabs;
+	}
+
+	void* pointer;
+	if(slab->free_slots) {
+		pointer = slab->free_slots;
+		slab->free_slots = *reinterpret_cast<void**>(pointer);
+	} else {
+		pointer = reinterpret_cast<uint8_t*>(slab) + slot_offset + size_t(slab->carved) * slot_size;
+		++slab->carved;
+	}
+
+	if(slab->used++ == 0)
+		--empty_slabs;
+	if(slab->used == slots_per_slab)
+		unlink(slab);
+
+	++live;
+	return pointer;
+}
+
+void SlabPool::releaseSlot(void* pointer)
+{
+	Slab* slab = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(pointer) & ~uintptr_t(SLAB_SIZE - 1));
+	ASSERT(slab->owner == this);
+	ASSERT(slab->used > 0);
+
+	*reinterpret_cast<void**>(pointer) = slab->free_slots;
+	slab->free_slots = pointer;
+
+	if(slab->used-- == slots_per_slab)
+		link(slab, true);
+	--live;
+
+	if(slab->used == 0) {
+		unlink(slab);
+		if(empty_slabs < CACHED_EMPTY_SLABS) {
+			link(slab, false);
+			++empty_slabs;
+		} else {
+			destroySlab(slab);
+		}
+	}
+}
+
+void SlabPool::trim()
+{
+	ThreadCache* cache = getThreadCache();
+	if(cache)
+		flush(*cache, cache->bins[index].count.load(std::memory_order_relaxed));
+
+	std::lock_guard<std::mutex> lock(mutex);
+	while(last && last->used == 0) {
+		Slab* slab = last;
+		unlink(slab);
+		destroySlab(slab);
+		--empty_slabs;
+	}
+}
+
+SlabPool::Statistics SlabPool::getStatistics() const
+{
+	// Slots in a thread's cache left the pool but hold no object. The caches
+	// keep changing while they are summed, so the numbers are approximate
+	// while other threads allocate.
+	size_t cached = 0;
+	uint64_t unreported = 0;
+	{
+		std::lock_guard<std::mutex> lock(ThreadCache::registry_mutex);
+		for(const ThreadCache* cache = ThreadCache::registry; cache; cache = cache->next) {
+			cached += cache->bins[index].count.load(std::memory_order_relaxed);
+			unreported += cache->bins[index].allocations.load(std::memory_order_relaxed);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	Statistics statistics;
+	statistics.live = live > cached ? live - cached : 0;
+	statistics.allocations = allocations + unreported;
+	statistics.slabs = slab_count;
+	statistics.bytes = slab_count * SLAB_SIZE;
+	return statistics;
+}
+
+SlabPool::Slab* SlabPool::createSlab()
+{
+	Slab* slab = static_cast<Slab*>(allocateAligned(SLAB_SIZE));
+	slab->owner = this;
+	slab->prev = nullptr;
+	slab->next = nullptr;
+	slab->free_slots = nullptr;
+	slab->used = 0;
+	slab->carved = 0;
+	++slab_count;
+	return slab;
+}
+
+void SlabPool::destroySlab(Slab* slab)
+{
+	freeAligned(slab);
+	--slab_count;
+}
+
+void SlabPool::link(Slab* slab, bool front)
+{
+	if(front) {
+		slab->prev = nullptr;
+		slab->next = first;
+		if(first)
+			first->prev = slab;
+		else
+			last = slab;
+		first = slab;
+	} else {
+		slab->prev = last;
+		slab->next = nullptr;
+		if(last)
+			last->next = slab;
+		else
+			first = slab;
+		last = slab;
+	}
+}
+
+void SlabPool::unlink(Slab* slab)
+{
+	if(slab->prev)
+		slab->prev->next = slab->next;
+	else
+		first = slab->next;
+	if(slab->next)
+		slab->next->prev = slab->prev;
+	else
+		last = slab->prev;
+	slab->prev = nullptr;
+	slab->next = nullptr;
+}
+
+// The pools are never destroyed, tiles held by global objects (copy buffer,
+// undo history) may be freed after static destruction has begun.
+SlabPool& MapAllocator::getTilePool()
+{
+	static SlabPool* pool = newd SlabPool("Tiles", sizeof(Tile), alignof(Tile));
+	return *pool;
+}
+
+SlabPool& MapAllocator::getFloorPool()
+{
+	static SlabPool* pool = newd SlabPool("Floors", sizeof(Floor), alignof(Floor));
+	return *pool;
+}
+
+SlabPool& MapAllocator::getNodePool()
+{
+	static SlabPool* pool = newd SlabPool("Tree nodes", sizeof(QTreeNode), alignof(QTreeNode));
+	return *pool;
+}
+
+SlabPool& MapAllocator::getItemPool()
+{
+	static SlabPool* pool = newd SlabPool("Pooled items", sizeof(Item), alignof(Item));
+	return *pool;
+}
+
+void MapAllocator::trim()
+{
+	getItemPool().trim();
+	getTilePool().trim();
+	getFloorPool().trim();
+	getNodePool().trim();
+}
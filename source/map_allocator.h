@@ -21,8 +21,85 @@
 #include "tile.h"
 #include "map_region.h"
 
+#include <mutex>
+#include <new>
+
 class BaseMap;
 
+// Fixed size object pool that carves objects out of large aligned slabs.
+// Freed objects go to the free list of their slab, and a slab that runs empty
+// is handed back to the system as a whole (a few are kept around for reuse).
+// Objects are still destroyed one at a time, closing a map doesn't drop its
+// slabs wholesale since they are shared with every other map.
+//
+// Every thread keeps a small cache of free slots per pool, allocations and
+// frees only lock the pool to move half a cache worth of slots at once.
+class SlabPool
+{
+public:
+	struct Statistics
+	{
+		size_t live; // Objects currently allocated, the free slots cached by threads are not counted
+		uint64_t allocations; // Objects allocated since startup
+		size_t slabs;
+		size_t bytes; // Memory held by the slabs
+	};
+
+	SlabPool(const char* name, size_t object_size, size_t object_alignment);
+	~SlabPool();
+
+	SlabPool(const SlabPool&) = delete;
+	SlabPool& operator=(const SlabPool&) = delete;
+
+	void* allocate();
+	// Returns the memory to whichever pool it was allocated from
+	static void release(void* pointer);
+
+	// Hands the calling thread's cached slots and all cached empty slabs back to the system
+	void trim();
+
+	const char* getName() const noexcept { return name; }
+	Statistics getStatistics() const;
+
+	// The number of slots a thread keeps per pool
+	static constexpr uint32_t CACHE_SIZE = 64;
+	static constexpr size_t MAX_POOLS = 8;
+
+private:
+	struct Slab;
+	struct ThreadCache;
+
+	// These expect the mutex to be held
+	void* allocateSlot();
+	void releaseSlot(void* pointer);
+	Slab* createSlab();
+	void destroySlab(Slab* slab);
+	void link(Slab* slab, bool front);
+	void unlink(Slab* slab);
+
+	// Moves slots between the pool and a thread's cache
+	void refill(ThreadCache& cache);
+	void flush(ThreadCache& cache, uint32_t count);
+
+	static ThreadCache* getThreadCache();
+
+	const char* name;
+	size_t index; // Of the pool's cache in every ThreadCache
+	size_t slot_size;
+	size_t slot_offset;
+	uint32_t slots_per_slab;
+
+	mutable std::mutex mutex;
+	// Slabs with at least one free slot, the empty ones are kept at the back
+	Slab* first;
+	Slab* last;
+	size_t empty_slabs;
+
+	size_t live; // Slots handed out of the slabs, to objects or to thread caches
+	uint64_t allocations;
+	size_t slab_count;
+};
+
 class MapAllocator
 {
 
@@ -39,9 +116,14 @@ public:
 		freeTile(t);
 	}
 
-	//
+	// Tile, Floor and QTreeNode route 'delete' back to their pool, so objects
+	// allocated here may be freed anywhere, even after the map is gone.
 	Tile* allocateTile(TileLocation* location) {
-		return newd Tile(*location);
+		return ::new(getTilePool().allocate()) Tile(*location);
+	}
+	// Tile without a location, it must be given one before it is placed on a map
+	Tile* allocateTile(int x, int y, int z) {
+		return ::new(getTilePool().allocate()) Tile(x, y, z);
 	}
 	void freeTile(Tile* t) {
 		delete t;
@@ -49,7 +131,7 @@ public:
 
 	//
 	Floor* allocateFloor(int x, int y, int z) {
-		return newd Floor(x, y, z);
+		return ::new(getFloorPool().allocate()) Floor(x, y, z);
 	}
 	void freeFloor(Floor* f) {
 		delete f;
@@ -57,11 +139,20 @@ public:
 
 	//
 	QTreeNode* allocateNode(BaseMap& map) {
-		return newd QTreeNode(map);
+		return ::new(getNodePool().allocate()) QTreeNode(map);
 	}
 	void freeNode(QTreeNode* qt) {
 		delete qt;
 	}
+
+	// The pools are shared by all open maps
+	static SlabPool& getTilePool();
+	static SlabPool& getFloorPool();
+	static SlabPool& getNodePool();
+	// Item objects no bigger than a plain Item, see Item::operator new
+	static SlabPool& getItemPool();
+
+	static void trim();
 };
 
 #endif
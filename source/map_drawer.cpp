@@ -261,6 +261,8 @@ void MapDrawer::Release()
 	}
 	tooltips.clear();
 
+	sprite_batch.clear();
+
 	if(light_drawer) {
 		light_drawer->clear();
 	}
@@ -316,6 +318,8 @@ inline int getFloorAdjustment(int floor)
 void MapDrawer::DrawShade(int map_z)
 {
 	if(map_z == end_z && start_z != end_z) {
+		sprite_batch.flush();
+
 		bool only_colors = options.isOnlyColors();
 		if(!only_colors)
 			glDisable(GL_TEXTURE_2D);
@@ -361,6 +365,12 @@ void MapDrawer::DrawMap()
 	bool only_colors = options.isOnlyColors();
 	bool tile_indicators = options.isTileIndicators();
 
+	const bool use_draw_lists = canUseDrawLists();
+	if(use_draw_lists)
+		draw_list_options = getDrawListOptions();
+	++draw_frame;
+	size_t drawn_leaves = 0;
+
 	for(int map_z = start_z; map_z >= superend_z; map_z--) {
 		if(options.show_shade) {
 			DrawShade(map_z);
@@ -375,7 +385,6 @@ void MapDrawer::DrawMap()
 			int nd_end_x = (end_x & ~3) + 4;
 			int nd_end_y = (end_y & ~3) + 4;
 
-			zoneTiles.clear();
 			for(int nd_map_x = nd_start_x; nd_map_x <= nd_end_x; nd_map_x += 4) {
 				for(int nd_map_y = nd_start_y; nd_map_y <= nd_end_y; nd_map_y += 4) {
 					QTreeNode* nd = editor.getMap().getLeaf(nd_map_x, nd_map_y);
@@ -387,10 +396,15 @@ void MapDrawer::DrawMap()
 					}
 
 					if(!live_client || nd->isVisible(map_z > rme::MapGroundLayer)) {
+						if(use_draw_lists) {
+							DrawLeaf(nd, nd_map_x, nd_map_y, map_z);
+							++drawn_leaves;
+						}
 						for(int map_x = 0; map_x < 4; ++map_x) {
 							for(int map_y = 0; map_y < 4; ++map_y) {
 								TileLocation* location = nd->getTile(map_x, map_y, map_z);
-								DrawTile(location);
+								if(!use_draw_lists)
+									DrawTile(location);
 								if(location && options.isDrawLight()) {
 									auto& position = location->getPosition();
 									if(position.x >= box_start_map_x && position.x <= box_end_map_x && position.y >= box_start_map_y && position.y <= box_end_map_y) {
@@ -415,6 +429,7 @@ void MapDrawer::DrawMap()
 						int cy = (nd_map_y) * rme::TileSize - view_scroll_y - getFloorAdjustment(floor);
 						int cx = (nd_map_x) * rme::TileSize - view_scroll_x - getFloorAdjustment(floor);
 
+						sprite_batch.flush();
 						glColor4ub(255, 0, 255, 128);
 						glBegin(GL_QUADS);
 							glVertex2f(cx, cy + rme::TileSize * 4);
@@ -426,46 +441,10 @@ void MapDrawer::DrawMap()
 				}
 			}
 
-			for (auto& itZonePos : zoneTiles)
-			{
-				ZoneFinder finder(itZonePos.second);
-				auto zones = finder.findZones();
-
-				for (const auto& itZone : zones)
-				{
-					const FinderPosition center = finder.findClosestToCenter(itZone);
-
-					QTreeNode* nd = editor.getMap().getLeaf(center.x, center.y);
-					TileLocation* location = nd->getTile(center.x, center.y, center.z);
-
-					const Tile* tile = location->get();
-
-					std::ostringstream tooltip;
-					tooltip << "zone id: ";
-					size_t zones = tile->getZoneIds().size();
-					for (const auto& zoneId : tile->getZoneIds())
-					{
-						tooltip << zoneId;
-						if (--zones > 0)
-							tooltip << "/";
-					}
-
-					int offset;
-					if (map_z <= rme::MapGroundLayer)
-					{
-						offset = (rme::MapGroundLayer - map_z) * rme::TileSize;
-					}
-					else
-					{
-						offset = rme::TileSize * (floor - map_z);
-					}
-
-					int draw_x = ((tile->getX() * rme::TileSize) - view_scroll_x) - offset;
-					int draw_y = ((tile->getY() * rme::TileSize) - view_scroll_y) - offset;
-					MakeTooltip(draw_x, draw_y + 8, tooltip.str());
-				}
-			}
+			if(options.isTooltips() && map_z == floor)
+				DrawZoneLabels(map_z);
 
+			sprite_batch.flush();
 			if(!only_colors)
 				glDisable(GL_TEXTURE_2D);
 
@@ -481,6 +460,11 @@ void MapDrawer::DrawMap()
 		++end_y;
 	}
 
+	// Forget the leaves that went out of view
+	if(leaf_draw_lists.size() > drawn_leaves * 2 + 256) {
+		std::erase_if(leaf_draw_lists, [this](const auto& entry) { return entry.second.last_frame != draw_frame; });
+	}
+
 	if(!only_colors)
 		glEnable(GL_TEXTURE_2D);
 }
@@ -591,6 +575,7 @@ void MapDrawer::DrawSecondaryMap(int map_z)
 		}
 	}
 
+	sprite_batch.flush();
 	glDisable(GL_TEXTURE_2D);
 }
 
@@ -727,6 +712,7 @@ void MapDrawer::DrawDraggingShadow()
 		}
 	}
 
+	sprite_batch.flush();
 	glDisable(GL_TEXTURE_2D);
 }
 
@@ -762,6 +748,7 @@ void MapDrawer::DrawHigherFloors()
 		}
 	}
 
+	sprite_batch.flush();
 	glDisable(GL_TEXTURE_2D);
 }
 
@@ -1185,15 +1172,15 @@ void MapDrawer::DrawBrush()
 			}
 		}
 	}
+
+	sprite_batch.flush();
 }
 
 void MapDrawer::BlitItem(int& draw_x, int& draw_y, const Tile* tile, const Item* item, bool ephemeral, int red, int green, int blue, int alpha)
 {
 	const ItemType& type = g_items.getItemType(item->getID());
 	if(type.id == 0) {
-		glDisable(GL_TEXTURE_2D);
 		glBlitSquare(draw_x, draw_y, *wxRED);
-		glEnable(GL_TEXTURE_2D);
 		return;
 	}
 
@@ -1205,14 +1192,10 @@ void MapDrawer::BlitItem(int& draw_x, int& draw_y, const Tile* tile, const Item*
 
 	// Ugly hacks. :)
 	if(type.id == 459 && !options.ingame) {
-		glDisable(GL_TEXTURE_2D);
 		glBlitSquare(draw_x, draw_y, red, green, 0, alpha/3*2);
-		glEnable(GL_TEXTURE_2D);
 		return;
 	} else if(type.id == 460 && !options.ingame) {
-		glDisable(GL_TEXTURE_2D);
 		glBlitSquare(draw_x, draw_y, red, 0, 0, alpha/3*2);
-		glEnable(GL_TEXTURE_2D);
 		return;
 	}
 
@@ -1287,14 +1270,14 @@ void MapDrawer::BlitItem(int& draw_x, int& draw_y, const Tile* tile, const Item*
 	for(int cx = 0; cx != sprite->width; cx++) {
 		for(int cy = 0; cy != sprite->height; cy++) {
 			for(int cf = 0; cf != sprite->layers; cf++) {
-				int texnum = sprite->getHardwareID(cx,cy,cf,
+				GameSprite::Image* image = sprite->getImage(cx,cy,cf,
 					subtype,
 					pattern_x,
 					pattern_y,
 					pattern_z,
 					frame
 				);
-				glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, texnum, red, green, blue, alpha);
+				glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, image, red, green, blue, alpha);
 			}
 		}
 	}
@@ -1316,14 +1299,10 @@ void MapDrawer::BlitItem(int& draw_x, int& draw_y, const Position& pos, const It
 	}
 
 	if(type.id == 459 && !options.ingame) { // Ugly hack yes?
-		glDisable(GL_TEXTURE_2D);
 		glBlitSquare(draw_x, draw_y, red, green, 0, alpha/3*2);
-		glEnable(GL_TEXTURE_2D);
 		return;
 	} else if(type.id == 460 && !options.ingame) { // Ugly hack yes?
-		glDisable(GL_TEXTURE_2D);
 		glBlitSquare(draw_x, draw_y, red, 0, 0, alpha/3*2);
-		glEnable(GL_TEXTURE_2D);
 		return;
 	}
 
@@ -1390,14 +1369,14 @@ void MapDrawer::BlitItem(int& draw_x, int& draw_y, const Position& pos, const It
 	for(int cx = 0; cx != sprite->width; ++cx) {
 		for(int cy = 0; cy != sprite->height; ++cy) {
 			for(int cf = 0; cf != sprite->layers; ++cf) {
-				int texnum = sprite->getHardwareID(cx,cy,cf,
+				GameSprite::Image* image = sprite->getImage(cx,cy,cf,
 					subtype,
 					pattern_x,
 					pattern_y,
 					pattern_z,
 					frame
 				);
-				glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, texnum, red, green, blue, alpha);
+				glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, image, red, green, blue, alpha);
 			}
 		}
 	}
@@ -1423,8 +1402,8 @@ void MapDrawer::BlitSpriteType(int screenx, int screeny, uint32_t spriteid, int
 	for(int cx = 0; cx != sprite->width; ++cx) {
 		for(int cy = 0; cy != sprite->height; ++cy) {
 			for(int cf = 0; cf != sprite->layers; ++cf) {
-				int texnum = sprite->getHardwareID(cx,cy,cf,-1,0,0,0, frame);
-				glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, texnum, red, green, blue, alpha);
+				GameSprite::Image* image = sprite->getImage(cx,cy,cf,-1,0,0,0, frame);
+				glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, image, red, green, blue, alpha);
 			}
 		}
 	}
@@ -1441,8 +1420,8 @@ void MapDrawer::BlitSpriteType(int screenx, int screeny, GameSprite* sprite, int
 	for(int cx = 0; cx != sprite->width; ++cx) {
 		for(int cy = 0; cy != sprite->height; ++cy) {
 			for(int cf = 0; cf != sprite->layers; ++cf) {
-				int texnum = sprite->getHardwareID(cx,cy,cf,-1,0,0,0, frame);
-				glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, texnum, red, green, blue, alpha);
+				GameSprite::Image* image = sprite->getImage(cx,cy,cf,-1,0,0,0, frame);
+				glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, image, red, green, blue, alpha);
 			}
 		}
 	}
@@ -1465,8 +1444,8 @@ void MapDrawer::BlitCreature(int screenx, int screeny, const Outfit& outfit, Dir
 			if(GameSprite* mountSpr = g_gui.gfx.getCreatureSprite(outfit.lookMount)) {
 				for(int cx = 0; cx != mountSpr->width; ++cx) {
 					for(int cy = 0; cy != mountSpr->height; ++cy) {
-						int texnum = mountSpr->getHardwareID(cx, cy, 0, 0, (int)dir, 0, 0, 0);
-						glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, texnum, red, green, blue, alpha);
+						GameSprite::Image* image = mountSpr->getImage(cx, cy, 0, 0, (int)dir, 0, 0, 0);
+						glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, image, red, green, blue, alpha);
 					}
 				}
 				pattern_z = std::min<int>(1, sprite->pattern_z - 1);
@@ -1484,8 +1463,8 @@ void MapDrawer::BlitCreature(int screenx, int screeny, const Outfit& outfit, Dir
 
 			for(int cx = 0; cx != sprite->width; ++cx) {
 				for(int cy = 0; cy != sprite->height; ++cy) {
-					int texnum = sprite->getHardwareID(cx, cy, (int)dir, pattern_y, pattern_z, outfit, frame);
-					glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, texnum, red, green, blue, alpha);
+					GameSprite::Image* image = sprite->getImage(cx, cy, (int)dir, pattern_y, pattern_z, outfit, frame);
+					glBlitTexture(screenx - cx * rme::TileSize, screeny - cy * rme::TileSize, image, red, green, blue, alpha);
 				}
 			}
 		}
@@ -1520,19 +1499,8 @@ void MapDrawer::WriteTooltip(Tile* tile, const Item* item, std::ostringstream& s
 	if(stream.tellp() > 0)
 		stream << "\n";
 
-
-	if (!zoneIds.empty())
-	{
-		for (auto& zoneId : zoneIds)
-		{
-			auto itZone = zoneTiles.find(zoneId);
-			if (itZone == zoneTiles.end())
-				zoneTiles.emplace(zoneId, std::vector<FinderPosition>({ FinderPosition(tile->getX(), tile->getY(), tile->getZ()) }));
-			else
-				itZone->second.push_back(FinderPosition(tile->getX(), tile->getY(), tile->getZ()));
-		}
-	}
-	else
+	// Zones are labelled once per area by DrawZoneLabels
+	if(zoneIds.empty())
 		stream << "id: " << id << "\n";
 	
 	if(action > 0)
@@ -1550,6 +1518,30 @@ void MapDrawer::WriteTooltip(const Waypoint* waypoint, std::ostringstream& strea
 	stream << "wp: " << waypoint->name << "\n";
 }
 
+void MapDrawer::DrawZoneLabels(int map_z)
+{
+	Map& map = editor.getMap();
+	map.zones.forEachLabel(map_z, start_x, start_y, end_x, end_y, [&](uint16_t, int x, int y) {
+		const Position position(x, y, map_z);
+		const Tile* tile = map.getTile(position);
+		if(!tile)
+			return;
+
+		std::ostringstream stream;
+		stream << "zone id: ";
+		size_t zones = tile->getZoneIds().size();
+		for(uint16_t zone_id : tile->getZoneIds()) {
+			stream << zone_id;
+			if(--zones > 0)
+				stream << "/";
+		}
+
+		int draw_x, draw_y;
+		getDrawPosition(position, draw_x, draw_y);
+		MakeTooltip(draw_x, draw_y + 8, stream.str());
+	});
+}
+
 void MapDrawer::DrawTile(TileLocation* location)
 {
 	if(!location) return;
@@ -1563,9 +1555,10 @@ void MapDrawer::DrawTile(TileLocation* location)
 	const Position& position = location->getPosition();
 	bool show_tooltips = options.isTooltips();
 
+	// Only tiles that hold a waypoint ask for it, by position
 	if(show_tooltips && location->getWaypointCount() > 0) {
-		Waypoint* waypoint = canvas->editor.getMap().waypoints.getWaypoint(position);
-		if(waypoint)
+		const Waypoints& waypoints = canvas->editor.getMap().waypoints;
+		if(const Waypoint* waypoint = waypoints.getWaypoint(position))
 			WriteTooltip(waypoint, tooltip);
 	}
 
@@ -1593,13 +1586,16 @@ void MapDrawer::DrawTile(TileLocation* location)
 				r = int(r * factor[idx]);
 			}
 
-			if(options.show_spawns && location->getSpawnCount() > 0) {
-				float f = 1.0f;
-				for(uint32_t i = 0; i < location->getSpawnCount(); ++i) {
-					f *= 0.7f;
+			if(options.show_spawns) {
+				const uint32_t spawn_count = editor.getMap().spawns.getSpawnCount(position);
+				if(spawn_count > 0) {
+					float f = 1.0f;
+					for(uint32_t i = 0; i < spawn_count; ++i) {
+						f *= 0.7f;
+					}
+					g = uint8_t(g * f);
+					b = uint8_t(b * f);
 				}
-				g = uint8_t(g * f);
-				b = uint8_t(b * f);
 			}
 
 			if(options.show_houses && tile->isHouseTile()) {
@@ -1647,14 +1643,12 @@ void MapDrawer::DrawTile(TileLocation* location)
 		}
 
 		if(only_colors) {
-			glDisable(GL_TEXTURE_2D);
 			if(options.show_as_minimap) {
 				wxColor color = colorFromEightBit(tile->getMiniMapColor());
 				glBlitSquare(draw_x, draw_y, color);
 			} else if(r != 255 || g != 255 || b != 255) {
 				glBlitSquare(draw_x, draw_y, r, g, b, 128);
 			}
-			glEnable(GL_TEXTURE_2D);
 		} else {
 			if(options.show_preview && zoom <= 2.0)
 				tile->ground->animate();
@@ -1697,6 +1691,85 @@ void MapDrawer::DrawTile(TileLocation* location)
 	}
 }
 
+void MapDrawer::DrawLeaf(QTreeNode* leaf, int map_x, int map_y, int map_z)
+{
+	int x, y;
+	getDrawPosition(Position(map_x, map_y, map_z), x, y);
+
+	const uint64_t key = static_cast<uint64_t>(map_x) << 20 | static_cast<uint64_t>(map_y) << 4 | static_cast<uint64_t>(map_z);
+	LeafDrawList& list = leaf_draw_lists[key];
+	list.last_frame = draw_frame;
+
+	if(list.leaf == leaf && list.revision == leaf->getRevision() && list.options == draw_list_options) {
+		for(const LeafDrawCommand& command : list.commands) {
+			if(!command.image) {
+				sprite_batch.addSquare(x + command.x, y + command.y, command.size, command.r, command.g, command.b, command.a);
+				continue;
+			}
+
+			const TextureRegion region = command.image->getTextureRegion();
+			if(region.texture != 0)
+				sprite_batch.add(x + command.x, y + command.y, command.size, region, command.r, command.g, command.b, command.a);
+		}
+		return;
+	}
+
+	list.leaf = leaf;
+	list.revision = leaf->getRevision();
+	list.options = draw_list_options;
+	list.commands.clear();
+
+	recording = &list;
+	recording_x = x;
+	recording_y = y;
+	for(int tile_x = 0; tile_x < 4; ++tile_x) {
+		for(int tile_y = 0; tile_y < 4; ++tile_y) {
+			DrawTile(leaf->getTile(tile_x, tile_y, map_z));
+		}
+	}
+	recording = nullptr;
+}
+
+bool MapDrawer::canUseDrawLists() const
+{
+	// Tooltips, hooks and animations are made while drawing, the
+	// modified flags change without the leaves hearing of it
+	if(options.isTooltips() || options.show_hooks || options.show_only_modified)
+		return false;
+	return !options.show_preview || zoom > 2.0;
+}
+
+MapDrawer::DrawListOptions MapDrawer::getDrawListOptions() const
+{
+	const bool flags[] = {
+		options.ingame,
+		options.transparent_items,
+		options.show_creatures,
+		options.show_spawns,
+		options.show_houses,
+		options.show_special_tiles,
+		options.show_zone_areas,
+		options.show_items,
+		options.highlight_items,
+		options.show_blocking,
+		options.show_as_minimap,
+		options.show_only_colors,
+		options.hide_items_when_zoomed && zoom > 10.f,
+	};
+
+	DrawListOptions draw_options;
+	for(size_t i = 0; i < std::size(flags); ++i) {
+		if(flags[i])
+			draw_options.flags |= 1 << i;
+	}
+	if(options.show_houses)
+		draw_options.house_id = current_house_id;
+	if(options.show_spawns)
+		draw_options.spawns = editor.getMap().spawns.getRevision();
+	draw_options.graphics = g_gui.gfx.getRevision();
+	return draw_options;
+}
+
 void MapDrawer::DrawBrushIndicator(int x, int y, Brush* brush, uint8_t r, uint8_t g, uint8_t b)
 {
 	x += (rme::TileSize / 2);
@@ -1749,6 +1822,7 @@ void MapDrawer::DrawBrushIndicator(int x, int y, Brush* brush, uint8_t r, uint8_
 
 void MapDrawer::DrawHookIndicator(int x, int y, const ItemType& type)
 {
+	sprite_batch.flush();
 	glDisable(GL_TEXTURE_2D);
 	glColor4ub(uint8_t(0), uint8_t(0), uint8_t(255), uint8_t(200));
 	glBegin(GL_QUADS);
@@ -1825,8 +1899,8 @@ void MapDrawer::DrawIndicator(int x, int y, int indicator, uint8_t r, uint8_t g,
 	if(sprite == nullptr)
 		return;
 
-	int textureId = sprite->getHardwareID(0,0,0,-1,0,0,0,0);
-	glBlitTexture(x, y, textureId, r, g, b, a, true);
+	GameSprite::Image* image = sprite->getImage(0,0,0,-1,0,0,0,0);
+	glBlitTexture(x, y, image, r, g, b, a, true);
 }
 
 void MapDrawer::DrawPositionIndicator(int z)
@@ -2034,17 +2108,13 @@ void MapDrawer::ShowPositionIndicator(const Position& position)
 	pos_indicator_timer.Start();
 }
 
-void MapDrawer::glBlitTexture(int x, int y, int textureId, int red, int green, int blue, int alpha, bool adjustZoom)
+void MapDrawer::glBlitTexture(int x, int y, GameSprite::Image* image, int red, int green, int blue, int alpha, bool adjustZoom)
 {
-	if(textureId <= 0)
+	if(!image)
 		return;
 
-	glBindTexture(GL_TEXTURE_2D, textureId);
-	glColor4ub(uint8_t(red), uint8_t(green), uint8_t(blue), uint8_t(alpha));
-	glBegin(GL_QUADS);
-
+	float size = rme::TileSize;
 	if(adjustZoom) {
-		float size = rme::TileSize;
 		if(zoom < 1.0f) {
 			float offset = 10 / (10 * zoom);
 			size = std::max<float>(16, rme::TileSize * zoom);
@@ -2056,40 +2126,28 @@ void MapDrawer::glBlitTexture(int x, int y, int textureId, int red, int green, i
 			x -= offset;
 			y -= offset;
 		}
-		glTexCoord2f(0.f, 0.f); glVertex2f(x, y);
-		glTexCoord2f(1.f, 0.f); glVertex2f(x + size, y);
-		glTexCoord2f(1.f, 1.f); glVertex2f(x + size, y + size);
-		glTexCoord2f(0.f, 1.f); glVertex2f(x, y + size);
-	} else {
-		glTexCoord2f(0.f, 0.f); glVertex2f(x, y);
-		glTexCoord2f(1.f, 0.f); glVertex2f(x + rme::TileSize, y);
-		glTexCoord2f(1.f, 1.f); glVertex2f(x + rme::TileSize, y + rme::TileSize);
-		glTexCoord2f(0.f, 1.f); glVertex2f(x, y + rme::TileSize);
 	}
+	if(recording)
+		recording->commands.push_back({ float(x - recording_x), float(y - recording_y), size, image, uint8_t(red), uint8_t(green), uint8_t(blue), uint8_t(alpha) });
 
-	glEnd();
+	const TextureRegion region = image->getTextureRegion();
+	if(region.texture == 0)
+		return;
+	sprite_batch.add(x, y, size, region, uint8_t(red), uint8_t(green), uint8_t(blue), uint8_t(alpha));
 }
 
 void MapDrawer::glBlitSquare(int x, int y, int red, int green, int blue, int alpha)
 {
-	glColor4ub(uint8_t(red), uint8_t(green), uint8_t(blue), uint8_t(alpha));
-	glBegin(GL_QUADS);
-		glVertex2f(x, y);
-		glVertex2f(x + rme::TileSize, y);
-		glVertex2f(x + rme::TileSize, y + rme::TileSize);
-		glVertex2f(x, y + rme::TileSize);
-	glEnd();
+	if(recording)
+		recording->commands.push_back({ float(x - recording_x), float(y - recording_y), float(rme::TileSize), nullptr, uint8_t(red), uint8_t(green), uint8_t(blue), uint8_t(alpha) });
+	sprite_batch.addSquare(x, y, rme::TileSize, uint8_t(red), uint8_t(green), uint8_t(blue), uint8_t(alpha));
 }
 
 void MapDrawer::glBlitSquare(int x, int y, const wxColor& color)
 {
-	glColor4ub(color.Red(), color.Green(), color.Blue(), color.Alpha());
-	glBegin(GL_QUADS);
-		glVertex2f(x, y);
-		glVertex2f(x + rme::TileSize, y);
-		glVertex2f(x + rme::TileSize, y + rme::TileSize);
-		glVertex2f(x, y + rme::TileSize);
-	glEnd();
+	if(recording)
+		recording->commands.push_back({ float(x - recording_x), float(y - recording_y), float(rme::TileSize), nullptr, color.Red(), color.Green(), color.Blue(), color.Alpha() });
+	sprite_batch.addSquare(x, y, rme::TileSize, color.Red(), color.Green(), color.Blue(), color.Alpha());
 }
 
 void MapDrawer::glColor(const wxColor& color)
@@ -19,11 +19,14 @@
 #define RME_MAP_DRAWER_H_
 
 #include <iostream>
-#include <unordered_set>
 #include <unordered_map>
 #include <memory>
 
+#include "graphics.h"
+#include "sprite_batch.h"
+
 class GameSprite;
+class QTreeNode;
 
 struct MapTooltip
 {
@@ -95,119 +98,40 @@ public:
 class MapCanvas;
 class LightDrawer;
 
-struct FinderPosition
+class MapDrawer
 {
-	FinderPosition() {}
-	FinderPosition(int _x, int _y, int _z) : x(_x), y(_y), z(_z) {}
-	int x, y, z;
-
-	bool operator==(const FinderPosition& other) const
-	{
-		return x == other.x && y == other.y && z == other.z;
-	}
-
-	double distance(const FinderPosition& b) const
-	{
-		return std::sqrt(std::pow(x - b.x, 2) + std::pow(y - b.y, 2));
-	}
-
-	struct Hash
+	// What DrawTile blitted for the tiles of one leaf and floor, relative to the
+	// leaf. As long as neither the tiles nor the options change, drawing the
+	// leaf again only replays it.
+	struct LeafDrawCommand
 	{
-		size_t operator()(const FinderPosition& p) const
-		{
-			return p.x ^ p.y ^ p.z;
-		}
+		float x, y, size;
+		GameSprite::Image* image; // nullptr for the coloured squares
+		uint8_t r, g, b, a;
 	};
-};
 
-class ZoneFinder
-{
-	private:
-	std::unordered_set<FinderPosition, FinderPosition::Hash> positions;
-	std::vector<std::vector<FinderPosition>> zones;
-	std::unordered_set<FinderPosition, FinderPosition::Hash> visited;
-
-	bool isValid(const FinderPosition& pos)
+	// Everything besides the tiles the draw lists depend on
+	struct DrawListOptions
 	{
-		return positions.find(pos) != positions.end() && visited.find(pos) == visited.end();
-	}
+		uint32_t flags = 0;
+		uint32_t house_id = 0;
+		uint64_t spawns = 0;
+		uint32_t graphics = 0;
 
-	void dfs(const FinderPosition& pos, std::vector<FinderPosition>& zone)
-	{
-		if (visited.find(pos) != visited.end())
-		{
-			return;
-		}
-
-		visited.insert(pos);
-		zone.push_back(pos);
-
-		std::vector<FinderPosition> neighbors = {
-			{pos.x + 1, pos.y, pos.z},
-			{pos.x - 1, pos.y, pos.z},
-			{pos.x, pos.y + 1, pos.z},
-			{pos.x, pos.y - 1, pos.z}
-		};
-
-		for (const auto& next : neighbors)
-		{
-			if (isValid(next))
-			{
-				dfs(next, zone);
-			}
+		bool operator==(const DrawListOptions& other) const noexcept {
+			return flags == other.flags && house_id == other.house_id && spawns == other.spawns && graphics == other.graphics;
 		}
-	}
-
-	public:
-	ZoneFinder(const std::vector<FinderPosition>& inputPositions) : positions(inputPositions.begin(), inputPositions.end()) {}
-
-	std::vector<std::vector<FinderPosition>> findZones()
-	{
-		for (const auto& pos : positions)
-		{
-			if (visited.find(pos) == visited.end())
-			{
-				std::vector<FinderPosition> zone;
-				dfs(pos, zone);
-				zones.push_back(zone);
-			}
-		}
-
-		return zones;
-	}
+	};
 
-	FinderPosition findClosestToCenter(const std::vector<FinderPosition>& zone)
+	struct LeafDrawList
 	{
-		FinderPosition centroid = { 0, 0, 0 };
-		for (const auto& pos : zone)
-		{
-			centroid.x += pos.x;
-			centroid.y += pos.y;
-			centroid.z += pos.z;
-		}
-
-		centroid.x /= zone.size();
-		centroid.y /= zone.size();
-		centroid.z /= zone.size();
-
-		double minDistance = std::numeric_limits<double>::max();
-		FinderPosition closestPosition;
-		for (const auto& pos : zone)
-		{
-			const double dist = pos.distance(centroid);
-			if (dist < minDistance)
-			{
-				minDistance = dist;
-				closestPosition = pos;
-			}
-		}
-
-		return closestPosition;
-	}
-};
+		const QTreeNode* leaf = nullptr;
+		uint64_t revision = 0;
+		DrawListOptions options;
+		uint64_t last_frame = 0;
+		std::vector<LeafDrawCommand> commands;
+	};
 
-class MapDrawer
-{
 	MapCanvas* canvas;
 	Editor& editor;
 	DrawingOptions options;
@@ -226,7 +150,18 @@ class MapDrawer
 	int floor;
 
 protected:
-	std::unordered_map<uint16_t, std::vector<FinderPosition>> zoneTiles;
+	// glBlitTexture and glBlitSquare only record into it, it is flushed
+	// before anything else is drawn on top
+	SpriteBatch sprite_batch;
+
+	// By leaf position and floor
+	std::unordered_map<uint64_t, LeafDrawList> leaf_draw_lists;
+	DrawListOptions draw_list_options;
+	uint64_t draw_frame = 0;
+	// The draw list glBlitTexture and glBlitSquare add to, and the draw position of its leaf
+	LeafDrawList* recording = nullptr;
+	int recording_x = 0, recording_y = 0;
+
 	std::vector<MapTooltip*> tooltips;
 	std::ostringstream tooltip;
 
@@ -279,6 +214,12 @@ protected:
 	void BlitCreature(int screenx, int screeny, const Creature* c, int red = 255, int green = 255, int blue = 255, int alpha = 255);
 	void BlitCreature(int screenx, int screeny, const Outfit& outfit, Direction dir, int red = 255, int green = 255, int blue = 255, int alpha = 255);
 	void DrawTile(TileLocation* tile);
+	// Adds a tooltip for every zone area whose label is in view
+	void DrawZoneLabels(int map_z);
+	// Draws the tiles of a leaf through its draw list
+	void DrawLeaf(QTreeNode* leaf, int map_x, int map_y, int map_z);
+	bool canUseDrawLists() const;
+	DrawListOptions getDrawListOptions() const;
 	void DrawBrushIndicator(int x, int y, Brush* brush, uint8_t r, uint8_t g, uint8_t b);
 	void DrawHookIndicator(int x, int y, const ItemType& type);
 	void DrawTileIndicators(TileLocation* location);
@@ -301,7 +242,7 @@ protected:
 	};
 
 	void getColor(Brush* brush, const Position& position, uint8_t &r, uint8_t &g, uint8_t &b);
-	void glBlitTexture(int x, int y, int textureId, int red, int green, int blue, int alpha, bool adjustZoom = false);
+	void glBlitTexture(int x, int y, GameSprite::Image* image, int red, int green, int blue, int alpha, bool adjustZoom = false);
 	void glBlitSquare(int x, int y, int red, int green, int blue, int alpha);
 	void glBlitSquare(int x, int y, const wxColor& color);
 	void glColor(const wxColor& color);
@@ -0,0 +1,191 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "map_occupancy.h"
+#include "iominimap.h"
+#include "tile.h"
+
+static_assert(OccupancyMap::BLOCK_SIZE == MMBLOCK_SIZE, "occupancy blocks are minimap blocks");
+
+namespace {
+	// Positions are 16 bit
+	constexpr int BLOCKS_PER_SIDE = 0x10000 / OccupancyMap::BLOCK_SIZE;
+
+	inline bool isInside(int x, int y, int z)
+	{
+		return x >= 0 && y >= 0 && x <= 0xFFFF && y <= 0xFFFF && z >= 0 && z < rme::MapLayers;
+	}
+}
+
+OccupancyMap::OccupancyMap()
+{
+	clear();
+}
+
+void OccupancyMap::clear()
+{
+	for(Floor& floor : floors) {
+		std::vector<std::vector<int32_t>>().swap(floor.directory);
+		std::vector<Block>().swap(floor.blocks);
+	}
+	for(uint64_t& count : counts)
+		count = 0;
+}
+
+const OccupancyMap::Block* OccupancyMap::getBlock(int x, int y, int z) const
+{
+	if(!isInside(x, y, z))
+		return nullptr;
+
+	const Floor& floor = floors[z];
+	const size_t row = y / BLOCK_SIZE;
+	if(row >= floor.directory.size() || floor.directory[row].empty())
+		return nullptr;
+
+	const int32_t index = floor.directory[row][x / BLOCK_SIZE];
+	return index < 0 ? nullptr : &floor.blocks[index];
+}
+
+OccupancyMap::Block* OccupancyMap::createBlock(int x, int y, int z)
+{
+	Floor& floor = floors[z];
+	if(floor.directory.empty())
+		floor.directory.resize(BLOCKS_PER_SIDE);
+
+	std::vector<int32_t>& columns = floor.directory[y / BLOCK_SIZE];
+	if(columns.empty())
+		columns.assign(BLOCKS_PER_SIDE, -1);
+
+	int32_t& index = columns[x / BLOCK_SIZE];
+	if(index < 0) {
+		index = static_cast<int32_t>(floor.blocks.size());
+		Block block = {};
+		block.x = x & ~(BLOCK_SIZE - 1);
+		block.y = y & ~(BLOCK_SIZE - 1);
+		floor.blocks.push_back(block);
+	}
+	return &floor.blocks[index];
+}
+
+void OccupancyMap::update(int x, int y, int z, const Tile* tile)
+{
+	if(!isInside(x, y, z))
+		return;
+
+	Block* block = const_cast<Block*>(getBlock(x, y, z));
+	if(!block) {
+		// Nothing to clear
+		if(!tile)
+			return;
+		block = createBlock(x, y, z);
+	}
+
+	const bool values[LAYER_COUNT] = {
+		tile != nullptr,
+		tile && tile->isBlocking(),
+		tile && tile->isSelected()
+	};
+
+	const int row = y & (BLOCK_SIZE - 1);
+	const uint64_t bit = uint64_t(1) << (x & (BLOCK_SIZE - 1));
+	for(int layer = 0; layer < LAYER_COUNT; ++layer) {
+		uint64_t& word = block->rows[layer][row];
+		if(((word & bit) != 0) == values[layer])
+			continue;
+
+		if(values[layer]) {
+			word |= bit;
+			++counts[layer];
+		} else {
+			word &= ~bit;
+			--counts[layer];
+		}
+
+		if(word != 0)
+			block->used_rows[layer] |= uint64_t(1) << row;
+		else
+			block->used_rows[layer] &= ~(uint64_t(1) << row);
+	}
+}
+
+bool OccupancyMap::test(Layer layer, int x, int y, int z) const
+{
+	return (getWord(layer, x, y, z) >> (x & (BLOCK_SIZE - 1))) & 1;
+}
+
+uint64_t OccupancyMap::getWord(Layer layer, int x, int y, int z) const
+{
+	const Block* block = getBlock(x, y, z);
+	return block ? block->rows[layer][y & (BLOCK_SIZE - 1)] : 0;
+}
+
+bool OccupancyMap::getFloorBounds(Layer layer, int z, int& min_x, int& min_y, int& max_x, int& max_y) const
+{
+	bool found = false;
+	for(const Block& block : floors[z].blocks) {
+		const uint64_t used = block.used_rows[layer];
+		if(used == 0)
+			continue;
+
+		uint64_t columns = 0;
+		for(int row = 0; row < BLOCK_SIZE; ++row)
+			columns |= block.rows[layer][row];
+
+		const int first_x = block.x + std::countr_zero(columns);
+		const int last_x = block.x + BLOCK_SIZE - 1 - std::countl_zero(columns);
+		const int first_y = block.y + std::countr_zero(used);
+		const int last_y = block.y + BLOCK_SIZE - 1 - std::countl_zero(used);
+		if(!found) {
+			min_x = first_x;
+			min_y = first_y;
+			max_x = last_x;
+			max_y = last_y;
+			found = true;
+		} else {
+			min_x = std::min(min_x, first_x);
+			min_y = std::min(min_y, first_y);
+			max_x = std::max(max_x, last_x);
+			max_y = std::max(max_y, last_y);
+		}
+	}
+	return found;
+}
+
+bool OccupancyMap::getBounds(Layer layer, Position& min_pos, Position& max_pos) const
+{
+	bool found = false;
+	for(int z = 0; z < rme::MapLayers; ++z) {
+		int min_x, min_y, max_x, max_y;
+		if(!getFloorBounds(layer, z, min_x, min_y, max_x, max_y))
+			continue;
+
+		if(!found) {
+			min_pos = Position(min_x, min_y, z);
+			max_pos = Position(max_x, max_y, z);
+			found = true;
+		} else {
+			min_pos.x = std::min(min_pos.x, min_x);
+			min_pos.y = std::min(min_pos.y, min_y);
+			max_pos.x = std::max(max_pos.x, max_x);
+			max_pos.y = std::max(max_pos.y, max_y);
+			max_pos.z = z;
+		}
+	}
+	return found;
+}
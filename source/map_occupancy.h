@@ -0,0 +1,115 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_MAP_OCCUPANCY_H_
+#define RME_MAP_OCCUPANCY_H_
+
+#include "const.h"
+#include "position.h"
+
+#include <bit>
+#include <vector>
+
+class Tile;
+
+// One bit per position for whether there is a tile, whether that tile is
+// blocking and whether it is selected. Every floor is split into blocks of
+// 64x64 positions, like the minimap, and a row of a block is one word. Scans
+// only visit the blocks that exist, skip rows that are zero and look at 64
+// positions at a time, instead of going down the map tree for each position.
+//
+// BaseMap keeps it up to date when tiles are replaced and when
+// markTileChanged is called. Tiles that are only selected or deselected in
+// place are reported with BaseMap::updateOccupancy.
+class OccupancyMap
+{
+public:
+	enum Layer {
+		TILES,
+		BLOCKING,
+		SELECTED,
+		LAYER_COUNT
+	};
+
+	// Same as MMBLOCK_SIZE
+	static constexpr int BLOCK_SIZE = 64;
+
+	OccupancyMap();
+
+	void clear();
+
+	// Sets the bits of a position from the tile there, nullptr if there is none
+	void update(int x, int y, int z, const Tile* tile);
+
+	bool test(Layer layer, int x, int y, int z) const;
+	// The bits of the 64 positions from (x & ~63, y, z) on, lowest bit first
+	uint64_t getWord(Layer layer, int x, int y, int z) const;
+	// Number of positions set
+	uint64_t count(Layer layer) const noexcept { return counts[layer]; }
+
+	// Smallest box holding every position set, false if there are none
+	bool getBounds(Layer layer, Position& min_pos, Position& max_pos) const;
+	bool getFloorBounds(Layer layer, int z, int& min_x, int& min_y, int& max_x, int& max_y) const;
+
+	// Calls f(x, y, word) for the words of a floor that are not zero, x is a
+	// multiple of 64. Blocks are visited in rows from the top, and the rows of
+	// a block from the top as well.
+	template <typename F>
+	void forEachWord(Layer layer, int z, F&& f) const;
+
+private:
+	struct Block
+	{
+		int x, y; // Of the first position
+		uint64_t rows[LAYER_COUNT][BLOCK_SIZE];
+		uint64_t used_rows[LAYER_COUNT]; // A bit for every row that is not zero
+	};
+
+	struct Floor
+	{
+		// Index into blocks by row and column of blocks, -1 where there is none
+		std::vector<std::vector<int32_t>> directory;
+		std::vector<Block> blocks;
+	};
+
+	const Block* getBlock(int x, int y, int z) const;
+	Block* createBlock(int x, int y, int z);
+
+	Floor floors[rme::MapLayers];
+	uint64_t counts[LAYER_COUNT];
+};
+
+template <typename F>
+inline void OccupancyMap::forEachWord(Layer layer, int z, F&& f) const
+{
+	for(const std::vector<int32_t>& columns : floors[z].directory) {
+		for(int32_t index : columns) {
+			if(index < 0)
+				continue;
+
+			const Block& block = floors[z].blocks[index];
+			uint64_t used = block.used_rows[layer];
+			while(used != 0) {
+				const int row = std::countr_zero(used);
+				used &= used - 1;
+				f(block.x, block.y + row, block.rows[layer][row]);
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,183 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "map_reachability.h"
+#include "map.h"
+#include "worker_pool.h"
+
+namespace {
+	// Visible floors, as in the window of ReachabilityMap
+	void getFloorRange(int z, int& first, int& last)
+	{
+		if(z <= rme::MapGroundLayer) {
+			first = 0;
+			last = rme::MapGroundLayer + 2;
+		} else {
+			first = std::max(z - 2, rme::MapGroundLayer);
+			last = std::min(z + 2, rme::MapMaxLayer);
+		}
+	}
+
+	// row |= row shifted by 'shift' bits (< 64) towards both ends
+	void spreadRow(uint64_t* row, size_t words, int shift, std::vector<uint64_t>& scratch)
+	{
+		scratch.assign(row, row + words);
+		const int back = 64 - shift;
+		for(size_t i = 0; i < words; ++i) {
+			uint64_t up = scratch[i] << shift;
+			uint64_t down = scratch[i] >> shift;
+			if(i > 0)
+				up |= scratch[i - 1] >> back;
+			if(i + 1 < words)
+				down |= scratch[i + 1] << back;
+			row[i] |= up | down;
+		}
+	}
+
+	// Steps that grow a single bit into a run of 2 * range + 1 bits, every
+	// step at most doubles the run so that it stays without gaps
+	std::vector<int> getSpreadSteps(int range)
+	{
+		std::vector<int> steps;
+		int covered = 0;
+		while(covered < range) {
+			const int step = std::min(covered + 1, range - covered);
+			steps.push_back(step);
+			covered += step;
+		}
+		return steps;
+	}
+}
+
+bool ReachabilityMap::Floor::test(int x, int y) const
+{
+	x -= min_x;
+	y -= min_y;
+	if(x < 0 || y < 0 || x >= width || y >= height)
+		return false;
+	return (bits[size_t(y) * words + (x >> 6)] >> (x & 63)) & 1;
+}
+
+void ReachabilityMap::Floor::spread()
+{
+	std::vector<uint64_t> scratch;
+	const std::vector<int> x_steps = getSpreadSteps(RANGE_X);
+	for(int y = 0; y < height; ++y) {
+		uint64_t* row = &bits[size_t(y) * words];
+		for(int step : x_steps)
+			spreadRow(row, words, step, scratch);
+	}
+
+	for(int step : getSpreadSteps(RANGE_Y)) {
+		scratch = bits;
+		for(int y = 0; y < height; ++y) {
+			uint64_t* row = &bits[size_t(y) * words];
+			if(y >= step) {
+				const uint64_t* above = &scratch[size_t(y - step) * words];
+				for(size_t i = 0; i < words; ++i)
+					row[i] |= above[i];
+			}
+			if(y + step < height) {
+				const uint64_t* below = &scratch[size_t(y + step) * words];
+				for(size_t i = 0; i < words; ++i)
+					row[i] |= below[i];
+			}
+		}
+	}
+}
+
+ReachabilityMap::ReachabilityMap(Map& map)
+{
+	const OccupancyMap& occupancy = map.getOccupancy();
+	WorkerPool pool;
+	pool.run(rme::MapLayers, [this, &occupancy](size_t index) {
+		const int z = static_cast<int>(index);
+		Floor& floor = floors[z];
+		// Walkable tiles are the tiles that are not blocking
+		auto getWalkable = [&occupancy, z](int x, int y, uint64_t tiles) {
+			return tiles & ~occupancy.getWord(OccupancyMap::BLOCKING, x, y, z);
+		};
+
+		bool walkable = false;
+		int max_x = 0;
+		int max_y = 0;
+		occupancy.forEachWord(OccupancyMap::TILES, z, [&](int x, int y, uint64_t tiles) {
+			const uint64_t word = getWalkable(x, y, tiles);
+			if(word == 0)
+				return;
+
+			const int first_x = x + std::countr_zero(word);
+			const int last_x = x + 63 - std::countl_zero(word);
+			if(!walkable) {
+				walkable = true;
+				floor.min_x = first_x;
+				floor.min_y = max_y = y;
+				max_x = last_x;
+			} else {
+				floor.min_x = std::min(floor.min_x, first_x);
+				floor.min_y = std::min(floor.min_y, y);
+				max_x = std::max(max_x, last_x);
+				max_y = std::max(max_y, y);
+			}
+		});
+		if(!walkable)
+			return;
+
+		floor.min_x -= RANGE_X;
+		floor.min_y -= RANGE_Y;
+		floor.width = max_x + RANGE_X - floor.min_x + 1;
+		floor.height = max_y + RANGE_Y - floor.min_y + 1;
+		floor.words = (size_t(floor.width) + 63) / 64;
+		floor.bits.assign(floor.words * floor.height, 0);
+
+		occupancy.forEachWord(OccupancyMap::TILES, z, [&](int x, int y, uint64_t tiles) {
+			const uint64_t word = getWalkable(x, y, tiles);
+			if(word == 0)
+				return;
+
+			// The floor doesn't start on a multiple of 64, a word may straddle
+			// two or start before the floor (with nothing walkable there)
+			const int offset = x - floor.min_x;
+			uint64_t* row = &floor.bits[size_t(y - floor.min_y) * floor.words];
+			if(offset < 0) {
+				row[0] |= word >> -offset;
+				return;
+			}
+
+			const size_t i = offset >> 6;
+			const int shift = offset & 63;
+			row[i] |= word << shift;
+			if(shift != 0 && i + 1 < floor.words)
+				row[i + 1] |= word >> (64 - shift);
+		});
+
+		floor.spread();
+	});
+}
+
+bool ReachabilityMap::isReachable(const Position& position) const
+{
+	int first, last;
+	getFloorRange(position.z, first, last);
+	for(int z = first; z <= last; ++z) {
+		if(floors[z].test(position.x, position.y))
+			return true;
+	}
+	return false;
+}
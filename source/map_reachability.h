@@ -0,0 +1,66 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_MAP_REACHABILITY_H_
+#define RME_MAP_REACHABILITY_H_
+
+#include "const.h"
+#include "position.h"
+
+#include <vector>
+
+class Map;
+
+// A tile is out of reach when there is no walkable tile (one that is not
+// blocking) within 10 tiles horizontally and 8 tiles vertically of it, on
+// any of the floors that can be seen from its own. Those are floors 0 to 9
+// above ground, and two floors up and down underground.
+//
+// Every floor keeps one bit per position that tells whether a walkable tile
+// is within that window. The bits are made by spreading the walkable tiles
+// over the window, 64 positions at a time, so a lookup is a few bit tests
+// instead of thousands of tile lookups.
+class ReachabilityMap
+{
+public:
+	static constexpr int RANGE_X = 10;
+	static constexpr int RANGE_Y = 8;
+
+	// Made from the occupancy bitmaps of the map, one floor per worker thread
+	explicit ReachabilityMap(Map& map);
+
+	bool isReachable(const Position& position) const;
+
+private:
+	struct Floor
+	{
+		// Bounds of the walkable tiles, grown by the window
+		int min_x = 0;
+		int min_y = 0;
+		int width = 0;
+		int height = 0;
+		size_t words = 0; // Per row
+		std::vector<uint64_t> bits;
+
+		bool test(int x, int y) const;
+		void spread();
+	};
+
+	Floor floors[rme::MapLayers];
+};
+
+#endif
@@ -27,7 +27,6 @@
 TileLocation::TileLocation() :
 	tile(nullptr),
 	position(0, 0, 0),
-	spawn_count(0),
 	waypoint_count(0),
 	house_exits(nullptr)
 {
@@ -44,7 +43,7 @@ int TileLocation::size() const
 {
 	if(tile)
 		return tile->size();
-	return spawn_count + waypoint_count + (house_exits? 1 : 0);
+	return waypoint_count + (house_exits? 1 : 0);
 }
 
 bool TileLocation::empty() const
@@ -73,11 +72,17 @@ Floor::Floor(int sx, int sy, int z)
 	}
 }
 
+void Floor::operator delete(void* pointer)
+{
+	SlabPool::release(pointer);
+}
+
 //**************** QTreeNode **********************
 
 QTreeNode::QTreeNode(BaseMap& map) :
 	map(map),
 	visible(0),
+	revision(++map.last_revision),
 	isLeaf(false)
 {
 	// Doesn't matter if we're leaf or node
@@ -89,13 +94,18 @@ QTreeNode::~QTreeNode()
 {
 	if(isLeaf) {
 		for(int i = 0; i < rme::MapLayers; ++i)
-			delete array[i];
+			map.allocator.freeFloor(array[i]);
 	} else {
 		for(int i = 0; i < rme::MapLayers; ++i)
-			delete child[i];
+			map.allocator.freeNode(child[i]);
 	}
 }
 
+void QTreeNode::operator delete(void* pointer)
+{
+	SlabPool::release(pointer);
+}
+
 QTreeNode* QTreeNode::getLeaf(int x, int y)
 {
 	QTreeNode* node = this;
@@ -132,11 +142,11 @@ QTreeNode* QTreeNode::getLeafForce(int x, int y)
 
 		} else {
 			if(level == 0) {
-				qt = newd QTreeNode(map);
+				qt = map.allocator.allocateNode(map);
 				qt->isLeaf = true;
 				return qt;
 			} else {
-				qt = newd QTreeNode(map);
+				qt = map.allocator.allocateNode(map);
 			}
 		}
 		node = node->child[index];
@@ -153,7 +163,7 @@ Floor* QTreeNode::createFloor(int x, int y, int z)
 {
 	ASSERT(isLeaf);
 	if(!array[z])
-		array[z] = newd Floor(x, y, z);
+		array[z] = map.allocator.allocateFloor(x, y, z);
 	return array[z];
 }
 
@@ -248,6 +258,7 @@ Tile* QTreeNode::setTile(int x, int y, int z, Tile* newtile)
 	TileLocation* tmp = &f->locs[offset_x*4+offset_y];
 	Tile* oldtile = tmp->tile;
 	tmp->tile = newtile;
+	markChanged();
 
 	if(newtile && !oldtile)
 		++map.tilecount;
@@ -268,4 +279,10 @@ void QTreeNode::clearTile(int x, int y, int z)
 	TileLocation* tmp = &f->locs[offset_x*4+offset_y];
 	delete tmp->tile;
 	tmp->tile = map.allocator(tmp);
+	markChanged();
+}
+
+void QTreeNode::markChanged()
+{
+	revision = ++map.last_revision;
 }
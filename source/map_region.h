@@ -37,7 +37,6 @@ public:
 protected:
 	Tile* tile;
 	Position position;
-	size_t spawn_count;
 	size_t waypoint_count;
 	HouseExitList* house_exits; // Any house exits pointing here
 
@@ -56,9 +55,6 @@ public:
 	int getY() const noexcept { return position.y; }
 	int getZ() const noexcept { return position.z; }
 
-	size_t getSpawnCount() const noexcept { return spawn_count; }
-	void increaseSpawnCount() noexcept { spawn_count++; }
-	void decreaseSpawnCount() noexcept { spawn_count--; }
 	size_t getWaypointCount() const noexcept { return waypoint_count; }
 	void increaseWaypointCount() noexcept { waypoint_count++; }
 	void decreaseWaypointCount() noexcept { waypoint_count--; }
@@ -74,6 +70,11 @@ class Floor
 {
 public:
 	Floor(int x, int y, int z);
+
+	// Allocated through MapAllocator only
+	static void* operator new(size_t) = delete;
+	static void operator delete(void* pointer);
+
 	TileLocation locs[rme::MapLayers];
 };
 
@@ -84,6 +85,10 @@ public:
 	QTreeNode(BaseMap& map);
 	virtual ~QTreeNode();
 
+	// Allocated through MapAllocator only
+	static void* operator new(size_t) = delete;
+	static void operator delete(void* pointer);
+
 	QTreeNode(const QTreeNode&) = delete;
 	QTreeNode& operator=(const QTreeNode&) = delete;
 
@@ -114,9 +119,15 @@ public:
 	bool isVisible(bool underground);
 	bool isRequested(bool underground);
 
+	// Changes whenever a tile of the leaf is replaced or changed in place,
+	// no two leaves of a map ever have the same revision
+	uint64_t getRevision() const noexcept { return revision; }
+	void markChanged();
+
 protected:
 	BaseMap& map;
 	uint32_t visible;
+	uint64_t revision;
 
 	bool isLeaf;
 
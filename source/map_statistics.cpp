@@ -0,0 +1,139 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "map_statistics.h"
+#include "tile.h"
+#include "item.h"
+#include "complexitem.h"
+#include "items.h"
+#include "house.h"
+
+void MapStatistics::countTile(const Tile* tile, uint64_t sign)
+{
+	// Not Tile::empty(), waypoints and house exits change it without the tile being replaced
+	if(!tile || (!tile->ground && tile->items.empty() && !tile->creature && !tile->spawn))
+		return;
+
+	tile_count += sign;
+
+	bool is_detailed = false;
+	if(tile->ground) {
+		countItem(tile->ground, sign, is_detailed);
+	}
+
+	for(const Item* item : tile->items) {
+		countItem(item, sign, is_detailed);
+	}
+
+	if(tile->spawn)
+		spawn_count += sign;
+
+	if(tile->creature)
+		creature_count += sign;
+
+	if(tile->isBlocking())
+		blocking_tile_count += sign;
+	else
+		walkable_tile_count += sign;
+
+	if(is_detailed)
+		detailed_tile_count += sign;
+}
+
+void MapStatistics::countItem(const Item* item, uint64_t sign, bool& is_detailed)
+{
+	item_count += sign;
+	if(item->isGroundTile() || item->isBorder())
+		return;
+
+	is_detailed = true;
+	const ItemType& it = g_items.getItemType(item->getID());
+	if(it.moveable) {
+		loose_item_count += sign;
+	}
+	if(it.isDepot()) {
+		depot_count += sign;
+	}
+	if(item->getActionID() > 0) {
+		action_item_count += sign;
+	}
+	if(item->getUniqueID() > 0) {
+		unique_item_count += sign;
+	}
+	if(const Container* c = dynamic_cast<const Container*>(item)) {
+		if(c->getItemCount()) {
+			container_count += sign;
+		}
+	}
+}
+
+void MapStatistics::merge(const MapStatistics& other)
+{
+	tile_count += other.tile_count;
+	detailed_tile_count += other.detailed_tile_count;
+	blocking_tile_count += other.blocking_tile_count;
+	walkable_tile_count += other.walkable_tile_count;
+	spawn_count += other.spawn_count;
+	creature_count += other.creature_count;
+	item_count += other.item_count;
+	loose_item_count += other.loose_item_count;
+	depot_count += other.depot_count;
+	action_item_count += other.action_item_count;
+	unique_item_count += other.unique_item_count;
+	container_count += other.container_count;
+}
+
+std::string MapStatistics::describeDifferences(const MapStatistics& counted) const
+{
+	static const std::pair<const char*, uint64_t MapStatistics::*> counts[] = {
+		{"tiles", &MapStatistics::tile_count},
+		{"detailed tiles", &MapStatistics::detailed_tile_count},
+		{"blocking tiles", &MapStatistics::blocking_tile_count},
+		{"walkable tiles", &MapStatistics::walkable_tile_count},
+		{"spawns", &MapStatistics::spawn_count},
+		{"creatures", &MapStatistics::creature_count},
+		{"items", &MapStatistics::item_count},
+		{"loose items", &MapStatistics::loose_item_count},
+		{"depots", &MapStatistics::depot_count},
+		{"action items", &MapStatistics::action_item_count},
+		{"unique items", &MapStatistics::unique_item_count},
+		{"containers", &MapStatistics::container_count},
+	};
+
+	std::ostringstream os;
+	for(const auto& count : counts) {
+		if(this->*count.second != counted.*count.second) {
+			if(os.tellp() > 0)
+				os << ", ";
+			os << count.first << " " << this->*count.second << "/" << counted.*count.second;
+		}
+	}
+	return os.str();
+}
+
+HouseStatistics::HouseStatistics(const Houses& houses)
+{
+	for(const auto& entry : houses) {
+		const House* house = entry.second;
+		const uint64_t sqm = house->size();
+		house_sqm[house->id] = sqm;
+		town_sqm[house->townid] += sqm;
+		total_sqm += sqm;
+	}
+}
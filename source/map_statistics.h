@@ -0,0 +1,81 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_MAP_STATISTICS_H_
+#define RME_MAP_STATISTICS_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+class Map;
+class Tile;
+class Item;
+class Houses;
+
+// Counts of the tiles and items of a map, as shown by the statistics
+// dialog. Map adds and takes away the counts of every tile that is replaced
+// (loading, actions, undo and redo), so they are always at hand. Changes
+// made to tiles in place can't be accounted for like that, they make the
+// map count everything again the next time the statistics are asked for.
+struct MapStatistics
+{
+	uint64_t tile_count = 0;
+	uint64_t detailed_tile_count = 0;
+	uint64_t blocking_tile_count = 0;
+	uint64_t walkable_tile_count = 0;
+	uint64_t spawn_count = 0;
+	uint64_t creature_count = 0;
+
+	uint64_t item_count = 0;
+	uint64_t loose_item_count = 0;
+	uint64_t depot_count = 0;
+	uint64_t action_item_count = 0;
+	uint64_t unique_item_count = 0;
+	uint64_t container_count = 0; // Only includes containers containing more than 1 item
+
+	void addTile(const Tile* tile) { countTile(tile, 1); }
+	void removeTile(const Tile* tile) { countTile(tile, -1); }
+
+	// For parallel_foreach_TileOnMap
+	void operator()(Map& map, Tile* tile) { addTile(tile); }
+	void merge(const MapStatistics& other);
+
+	bool operator==(const MapStatistics& other) const = default;
+	// Lists the counts that differ from 'counted', as "name kept/counted"
+	std::string describeDifferences(const MapStatistics& counted) const;
+
+private:
+	// The counts are unsigned, taking away wraps around to the right value
+	void countTile(const Tile* tile, uint64_t sign);
+	void countItem(const Item* item, uint64_t sign, bool& is_detailed);
+};
+
+// Walkable house tiles per house and per town. Tiles join and leave houses in
+// place, so these are not kept along with the counts above. They are counted
+// from the tile lists of the houses instead, which only visits house tiles.
+struct HouseStatistics
+{
+	std::map<uint32_t, uint64_t> house_sqm;
+	// Houses without a (known) town are counted under their town id all the same
+	std::map<uint32_t, uint64_t> town_sqm;
+	uint64_t total_sqm = 0;
+
+	explicit HouseStatistics(const Houses& houses);
+};
+
+#endif
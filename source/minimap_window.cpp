@@ -128,8 +128,20 @@ void MinimapWindow::OnPaint(wxPaintEvent& event)
 	//printf("Draw from %d:%d to %d:%d\n", start_x, start_y, end_x, end_y);
 	uint8_t last = 0;
 	if(g_gui.IsRenderingEnabled()) {
+		const OccupancyMap& occupancy = map.getOccupancy();
 		for(int y = start_y, window_y = 0; y <= end_y; ++y, ++window_y) {
-			for(int x = start_x, window_x = 0; x <= end_x; ++x, ++window_x) {
+			int x = start_x;
+			while(x <= end_x) {
+				// Skip to the next tile, 64 positions at a time where there are none
+				const uint64_t tiles = occupancy.getWord(OccupancyMap::TILES, x, y, floor) >> (x & 63);
+				if(tiles == 0) {
+					x = (x | 63) + 1;
+					continue;
+				}
+				x += std::countr_zero(tiles);
+				if(x > end_x)
+					break;
+
 				const Tile* tile = map.getTile(x, y, floor);
 				if(tile) {
 					uint8_t color = tile->getMiniMapColor();
@@ -138,9 +150,10 @@ void MinimapWindow::OnPaint(wxPaintEvent& event)
 							pdc.SetPen(*pens[color]);
 							last = color;
 						}
-						pdc.DrawPoint(window_x, window_y);
+						pdc.DrawPoint(x - start_x, window_y);
 					}
 				}
+				++x;
 			}
 		}
 
@@ -0,0 +1,164 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "otbm_area_index.h"
+
+namespace {
+	constexpr int DIRTY_CELL_BITS = 6; // 64x64 tiles
+	constexpr int DIRTY_CELLS_PER_ROW = 0x10000 >> DIRTY_CELL_BITS;
+	constexpr size_t DIRTY_CELL_COUNT = size_t(DIRTY_CELLS_PER_ROW) * DIRTY_CELLS_PER_ROW * rme::MapLayers;
+
+	bool getCellIndex(int x, int y, int z, size_t& index)
+	{
+		if(x < 0 || x > 0xFFFF || y < 0 || y > 0xFFFF || z < 0 || z >= rme::MapLayers)
+			return false;
+		index = (size_t(z) * DIRTY_CELLS_PER_ROW + (y >> DIRTY_CELL_BITS)) * DIRTY_CELLS_PER_ROW + (x >> DIRTY_CELL_BITS);
+		return true;
+	}
+
+	bool getFileStamp(const std::string& path, uint64_t& size, int64_t& modified)
+	{
+		wxFileName file(wxstr(path));
+		if(!file.FileExists())
+			return false;
+
+		wxULongLong file_size = file.GetSize();
+		wxDateTime file_modified = file.GetModificationTime();
+		if(file_size == wxInvalidSize || !file_modified.IsValid())
+			return false;
+
+		size = file_size.GetValue();
+		modified = file_modified.GetValue().GetValue();
+		return true;
+	}
+}
+
+uint64_t OTBMAreaIndex::hashPosition(uint64_t hash, int x, int y, int z)
+{
+	// splitmix64 finalizer over the packed position, chained FNV style so the order counts
+	uint64_t value = uint64_t(uint16_t(x)) | (uint64_t(uint16_t(y)) << 16) | (uint64_t(uint8_t(z)) << 32);
+	value += 0x9E3779B97F4A7C15ULL;
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+	value ^= value >> 31;
+	return (hash ^ value) * 0x100000001B3ULL;
+}
+
+OTBMAreaIndex::OTBMAreaIndex() :
+	source_size(0),
+	source_modified(0)
+{
+	////
+}
+
+void OTBMAreaIndex::clear()
+{
+	areas.clear();
+	source_name.clear();
+	source_size = 0;
+	source_modified = 0;
+	source_version = MapVersion();
+	dirty.clear();
+	dirty.shrink_to_fit();
+}
+
+void OTBMAreaIndex::addArea(uint64_t key, uint64_t offset, uint64_t length, uint32_t tiles)
+{
+	auto result = areas.emplace(key, Area{offset, length, tiles});
+	if(!result.second) {
+		// Two areas with the same hash, neither of them can be trusted
+		result.first->second.length = 0;
+		result.first->second.tiles = 0;
+	}
+}
+
+const OTBMAreaIndex::Area* OTBMAreaIndex::findArea(uint64_t key, uint32_t tiles) const
+{
+	auto it = areas.find(key);
+	if(it == areas.end() || it->second.length == 0 || it->second.tiles != tiles)
+		return nullptr;
+	return &it->second;
+}
+
+bool OTBMAreaIndex::setSource(const std::string& filename, const MapVersion& version)
+{
+	if(!getFileStamp(filename, source_size, source_modified)) {
+		clear();
+		return false;
+	}
+	source_name = filename;
+	source_version = version;
+	return true;
+}
+
+bool OTBMAreaIndex::isSource(const std::string& filename, const std::string& path, const MapVersion& version) const
+{
+	if(areas.empty() || filename != source_name)
+		return false;
+	if(version.otbm != source_version.otbm || version.client != source_version.client)
+		return false;
+
+	uint64_t size;
+	int64_t modified;
+	return getFileStamp(path, size, modified) && size == source_size && modified == source_modified;
+}
+
+void OTBMAreaIndex::markDirty(int x, int y, int z)
+{
+	// Nothing to protect
+	if(areas.empty())
+		return;
+
+	size_t index;
+	if(!getCellIndex(x, y, z, index)) {
+		clear();
+		return;
+	}
+
+	if(dirty.empty())
+		dirty.resize(DIRTY_CELL_COUNT / 64, 0);
+	dirty[index / 64] |= uint64_t(1) << (index % 64);
+}
+
+void OTBMAreaIndex::markDirty(int start_x, int start_y, int end_x, int end_y, int z)
+{
+	if(areas.empty())
+		return;
+
+	// One tile of every cell the box overlaps
+	start_x = std::max(start_x, 0) & ~((1 << DIRTY_CELL_BITS) - 1);
+	start_y = std::max(start_y, 0) & ~((1 << DIRTY_CELL_BITS) - 1);
+	end_x = std::min(end_x, 0xFFFF);
+	end_y = std::min(end_y, 0xFFFF);
+	for(int y = start_y; y <= end_y; y += 1 << DIRTY_CELL_BITS) {
+		for(int x = start_x; x <= end_x; x += 1 << DIRTY_CELL_BITS) {
+			markDirty(x, y, z);
+		}
+	}
+}
+
+bool OTBMAreaIndex::isDirty(int x, int y, int z) const
+{
+	size_t index;
+	if(!getCellIndex(x, y, z, index))
+		return true;
+	if(dirty.empty())
+		return false;
+	return (dirty[index / 64] >> (index % 64)) & 1;
+}
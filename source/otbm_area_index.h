@@ -0,0 +1,89 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_OTBM_AREA_INDEX_H_
+#define RME_OTBM_AREA_INDEX_H_
+
+#include "client_version.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Remembers where every OTBM_TILE_AREA node of the file a map was last loaded
+// from or saved to is stored, and which parts of the map have changed since.
+// Saving again can then copy the nodes of untouched areas from that file
+// instead of serializing their tiles once more.
+//
+// This is experimental (Config::INCREMENTAL_SAVE, off by default): an area is
+// taken as untouched when no change was marked dirty in it and it holds tiles
+// at the same positions, its contents are never compared. A change that
+// bypasses Map::markTileReplaced/markTileChanged is lost. The self check
+// (Config::INCREMENTAL_SAVE_SELF_CHECK) serializes copied areas anyway and
+// writes the fresh bytes when they differ.
+class OTBMAreaIndex
+{
+public:
+	struct Area
+	{
+		uint64_t offset; // Of the NODE_START byte, counted from the end of the file identifier
+		uint64_t length; // Delimiters included
+		uint32_t tiles;
+	};
+
+	// Areas are looked up by the hash of the positions of their tiles, in file order
+	static constexpr uint64_t HASH_SEED = 0xCBF29CE484222325ULL;
+	static uint64_t hashPosition(uint64_t hash, int x, int y, int z);
+
+	OTBMAreaIndex();
+
+	// Forgets the file, the next save serializes the whole map
+	void clear();
+	bool empty() const noexcept { return areas.empty(); }
+	size_t size() const noexcept { return areas.size(); }
+
+	void addArea(uint64_t key, uint64_t offset, uint64_t length, uint32_t tiles);
+	// nullptr if there is no area with exactly these tiles
+	const Area* findArea(uint64_t key, uint32_t tiles) const;
+
+	// Remembers which file the areas belong to, it must be closed already.
+	// Returns false (and clears the index) if the file can't be examined.
+	bool setSource(const std::string& filename, const MapVersion& version);
+	// True if 'path' still holds the file the areas were recorded for. The
+	// file may have been renamed since, 'filename' is the name it was given.
+	bool isSource(const std::string& filename, const std::string& path, const MapVersion& version) const;
+
+	// Tiles changed since the areas were recorded
+	void markDirty(int x, int y, int z);
+	// Every tile from start to end (inclusive) on floor z
+	void markDirty(int start_x, int start_y, int end_x, int end_y, int z);
+	bool isDirty(int x, int y, int z) const;
+
+private:
+	std::unordered_map<uint64_t, Area> areas;
+
+	std::string source_name;
+	uint64_t source_size;
+	int64_t source_modified;
+	MapVersion source_version;
+
+	// One bit per DIRTY_CELL_SIZE x DIRTY_CELL_SIZE tiles of every floor, only
+	// allocated once something changes
+	std::vector<uint64_t> dirty;
+};
+
+#endif
@@ -0,0 +1,772 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "otgz.h"
+
+#include <cstdlib>
+#include <ctime>
+
+namespace {
+	constexpr size_t BLOCK_SIZE = 128 * 1024;
+	constexpr size_t DICTIONARY_SIZE = 32 * 1024;
+	constexpr size_t BLOCKS_PER_THREAD = 2;
+	constexpr size_t INPUT_BUFFER_SIZE = 64 * 1024;
+	constexpr size_t TAR_BLOCK_SIZE = 512;
+
+	FILE* openFile(const std::string& name, bool write)
+	{
+#if defined __VISUALC__ && defined _UNICODE
+		return _wfopen(string2wstring(name).c_str(), write ? L"wb" : L"rb");
+#else
+		return fopen(name.c_str(), write ? "wb" : "rb");
+#endif
+	}
+
+	bool seekFile(FILE* file, uint64_t offset)
+	{
+#ifdef _WIN32
+		return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+		return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+	}
+
+	// crc32_combine takes the length as a (possibly 32 bit) long, extending
+	// the first crc by zeros is linear so the length can be fed in pieces
+	uint32_t combineCrc(uint32_t first, uint32_t second, uint64_t second_length)
+	{
+		constexpr uint64_t STEP = 0x40000000;
+		while(second_length > STEP) {
+			first = crc32_combine(first, 0, static_cast<z_off_t>(STEP));
+			second_length -= STEP;
+		}
+		return crc32_combine(first, 0, static_cast<z_off_t>(second_length)) ^ second;
+	}
+
+	void putLE32(uint8_t* out, uint32_t value)
+	{
+		out[0] = value & 0xFF;
+		out[1] = (value >> 8) & 0xFF;
+		out[2] = (value >> 16) & 0xFF;
+		out[3] = (value >> 24) & 0xFF;
+	}
+
+	void putOctal(uint8_t* field, size_t length, uint64_t value)
+	{
+		// Zero padded, with a terminating NUL
+		field[length - 1] = '\0';
+		for(size_t i = length - 1; i > 0; --i) {
+			field[i - 1] = '0' + (value & 7);
+			value >>= 3;
+		}
+	}
+
+	uint64_t getNumber(const uint8_t* field, size_t length)
+	{
+		uint64_t value = 0;
+		if(field[0] & 0x80) {
+			// Base-256, used for sizes that don't fit in octal
+			for(size_t i = 1; i < length; ++i)
+				value = (value << 8) | field[i];
+			return value;
+		}
+
+		size_t i = 0;
+		while(i < length && field[i] == ' ')
+			++i;
+		for(; i < length && field[i] >= '0' && field[i] <= '7'; ++i)
+			value = (value << 3) | (field[i] - '0');
+		return value;
+	}
+
+	uint32_t getChecksum(const uint8_t* header)
+	{
+		uint32_t sum = 0;
+		for(size_t i = 0; i < TAR_BLOCK_SIZE; ++i)
+			sum += (i >= 148 && i < 156) ? ' ' : header[i];
+		return sum;
+	}
+
+	std::string getString(const uint8_t* field, size_t length)
+	{
+		const uint8_t* end = static_cast<const uint8_t*>(memchr(field, 0, length));
+		return std::string(reinterpret_cast<const char*>(field), end ? end - field : length);
+	}
+
+	// ustar header of a regular file
+	bool makeTarHeader(uint8_t* header, const std::string& name, uint64_t size)
+	{
+		memset(header, 0, TAR_BLOCK_SIZE);
+
+		std::string prefix;
+		std::string file_name = name;
+		if(file_name.size() > 100) {
+			const size_t split = name.rfind('/', 155);
+			if(split == std::string::npos || name.size() - split - 1 > 100)
+				return false;
+			prefix = name.substr(0, split);
+			file_name = name.substr(split + 1);
+		}
+
+		memcpy(header, file_name.data(), file_name.size());
+		putOctal(header + 100, 8, 0644); // mode
+		putOctal(header + 108, 8, 0); // uid
+		putOctal(header + 116, 8, 0); // gid
+		if(size < (uint64_t(1) << 33)) {
+			putOctal(header + 124, 12, size);
+		} else {
+			header[124] = 0x80;
+			for(size_t i = 135; i > 124; --i, size >>= 8)
+				header[i] = size & 0xFF;
+		}
+		putOctal(header + 136, 12, static_cast<uint64_t>(std::time(nullptr)));
+		header[156] = '0';
+		memcpy(header + 257, "ustar", 6);
+		memcpy(header + 263, "00", 2);
+		memcpy(header + 345, prefix.data(), prefix.size());
+
+		const uint32_t checksum = getChecksum(header);
+		putOctal(header + 148, 7, checksum);
+		header[155] = ' ';
+		return true;
+	}
+}
+
+//=============================================================================
+// Gzip writer
+
+GzipFileWriter::GzipFileWriter(const std::string& name, int level) :
+	file(openFile(name, true)),
+	level(level),
+	failed(false),
+	input_size(0),
+	output_size(0),
+	crc(crc32(0, nullptr, 0)),
+	crc_length(0),
+	has_reserved(false),
+	reserved_offset(0),
+	crc_before_reserved(0)
+{
+	current.reserve(BLOCK_SIZE);
+
+	// No name, no modification time, unknown OS
+	const uint8_t header[10] = {0x1F, 0x8B, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xFF};
+	if(file) {
+		writeOutput(header, sizeof(header));
+	}
+}
+
+GzipFileWriter::~GzipFileWriter()
+{
+	if(file) {
+		fclose(file);
+	}
+}
+
+bool GzipFileWriter::write(const uint8_t* data, size_t size)
+{
+	if(!isOk())
+		return false;
+
+	input_size += size;
+	while(size != 0) {
+		const size_t chunk = std::min(size, BLOCK_SIZE - current.size());
+		current.insert(current.end(), data, data + chunk);
+		data += chunk;
+		size -= chunk;
+
+		if(current.size() == BLOCK_SIZE) {
+			sealBlock(false);
+			if(pending.size() >= pool.getThreadCount() * BLOCKS_PER_THREAD && !flushBlocks())
+				return false;
+		}
+	}
+	return true;
+}
+
+bool GzipFileWriter::reserve(const uint8_t* data, size_t size)
+{
+	ASSERT(!has_reserved);
+	if(!isOk() || has_reserved || size > 0xFFFF)
+		return false;
+
+	// Flushing leaves the output on a byte boundary, where a stored block can begin
+	if(!current.empty())
+		sealBlock(false);
+	if(!flushBlocks())
+		return false;
+
+	const uint8_t header[5] = {
+		0, // Not the last block, stored
+		uint8_t(size & 0xFF), uint8_t(size >> 8),
+		uint8_t(~size & 0xFF), uint8_t((~size >> 8) & 0xFF)
+	};
+	if(!writeOutput(header, sizeof(header)))
+		return false;
+
+	has_reserved = true;
+	reserved_offset = output_size;
+	reserved.assign(data, data + size);
+	if(!writeOutput(data, size))
+		return false;
+
+	crc_before_reserved = crc;
+	crc = crc32(0, nullptr, 0);
+	crc_length = 0;
+	input_size += size;
+
+	// The reserved bytes will change, what follows must not refer back to them
+	history.clear();
+	return true;
+}
+
+bool GzipFileWriter::rewriteReserved(const uint8_t* data)
+{
+	ASSERT(has_reserved);
+	if(!isOk() || !has_reserved)
+		return false;
+
+	if(!current.empty())
+		sealBlock(false);
+	if(!flushBlocks())
+		return false;
+
+	memcpy(reserved.data(), data, reserved.size());
+	if(!seekFile(file, reserved_offset) || fwrite(data, 1, reserved.size(), file) != reserved.size() || !seekFile(file, output_size)) {
+		failed = true;
+		return false;
+	}
+	return true;
+}
+
+bool GzipFileWriter::finish()
+{
+	if(!isOk())
+		return false;
+
+	sealBlock(true);
+	if(!flushBlocks())
+		return false;
+
+	uint32_t total_crc = crc;
+	if(has_reserved) {
+		const uint32_t reserved_crc = crc32(0, reserved.data(), static_cast<uInt>(reserved.size()));
+		total_crc = combineCrc(combineCrc(crc_before_reserved, reserved_crc, reserved.size()), crc, crc_length);
+	}
+
+	uint8_t trailer[8];
+	putLE32(trailer, total_crc);
+	putLE32(trailer + 4, static_cast<uint32_t>(input_size));
+	writeOutput(trailer, sizeof(trailer));
+
+	const bool closed = fclose(file) == 0;
+	file = nullptr;
+	return closed && !failed;
+}
+
+void GzipFileWriter::sealBlock(bool last)
+{
+	pending.emplace_back();
+	Block& block = pending.back();
+	block.dictionary = history.size();
+	block.length = current.size();
+	block.last = last;
+	block.crc = 0;
+	block.failed = false;
+	block.input.reserve(history.size() + current.size());
+	block.input.insert(block.input.end(), history.begin(), history.end());
+	block.input.insert(block.input.end(), current.begin(), current.end());
+
+	if(current.size() >= DICTIONARY_SIZE) {
+		history.assign(current.end() - DICTIONARY_SIZE, current.end());
+	} else {
+		history.insert(history.end(), current.begin(), current.end());
+		if(history.size() > DICTIONARY_SIZE)
+			history.erase(history.begin(), history.end() - DICTIONARY_SIZE);
+	}
+	current.clear();
+}
+
+bool GzipFileWriter::flushBlocks()
+{
+	const int block_level = level;
+	pool.run(pending.size(), [&](size_t index) {
+		deflateBlock(pending[index], block_level);
+	});
+
+	for(Block& block : pending) {
+		if(block.failed) {
+			failed = true;
+			break;
+		}
+		crc = combineCrc(crc, block.crc, block.length);
+		crc_length += block.length;
+		if(!writeOutput(block.output.data(), block.output.size()))
+			break;
+	}
+	pending.clear();
+	return isOk();
+}
+
+bool GzipFileWriter::writeOutput(const void* data, size_t size)
+{
+	if(size != 0 && fwrite(data, 1, size, file) != size) {
+		failed = true;
+		return false;
+	}
+	output_size += size;
+	return true;
+}
+
+void GzipFileWriter::deflateBlock(Block& block, int level)
+{
+	const uint8_t* data = block.input.data() + block.dictionary;
+	const size_t size = block.input.size() - block.dictionary;
+	block.crc = crc32(0, data, static_cast<uInt>(size));
+
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	// Raw deflate, the gzip framing is written around all blocks together
+	if(deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		block.failed = true;
+		return;
+	}
+	if(block.dictionary != 0) {
+		deflateSetDictionary(&stream, block.input.data(), static_cast<uInt>(block.dictionary));
+	}
+
+	block.output.resize(deflateBound(&stream, static_cast<uLong>(size)) + 16);
+	stream.next_in = const_cast<Bytef*>(data);
+	stream.avail_in = static_cast<uInt>(size);
+
+	const int flush = block.last ? Z_FINISH : Z_SYNC_FLUSH;
+	size_t produced = 0;
+	while(true) {
+		if(produced == block.output.size())
+			block.output.resize(block.output.size() * 2);
+		stream.next_out = block.output.data() + produced;
+		stream.avail_out = static_cast<uInt>(block.output.size() - produced);
+
+		const int ret = deflate(&stream, flush);
+		produced = block.output.size() - stream.avail_out;
+		if(ret == Z_STREAM_ERROR) {
+			block.failed = true;
+			break;
+		}
+		if(block.last ? ret == Z_STREAM_END : (stream.avail_in == 0 && stream.avail_out != 0))
+			break;
+	}
+
+	block.output.resize(produced);
+	deflateEnd(&stream);
+
+	// Only the output is kept until it is written
+	std::vector<uint8_t>().swap(block.input);
+}
+
+//=============================================================================
+// Gzip reader
+
+GzipFileReader::GzipFileReader(const std::string& name) :
+	file(openFile(name, false)),
+	failed(false),
+	finished(false),
+	input(INPUT_BUFFER_SIZE)
+{
+	memset(&stream, 0, sizeof(stream));
+	// Gzip framing only
+	if(file && inflateInit2(&stream, MAX_WBITS + 16) != Z_OK) {
+		fclose(file);
+		file = nullptr;
+	}
+}
+
+GzipFileReader::~GzipFileReader()
+{
+	if(file) {
+		inflateEnd(&stream);
+		fclose(file);
+	}
+}
+
+size_t GzipFileReader::read(uint8_t* data, size_t size)
+{
+	if(!isOk())
+		return 0;
+
+	stream.next_out = data;
+	stream.avail_out = static_cast<uInt>(size);
+	while(stream.avail_out != 0 && !finished) {
+		if(stream.avail_in == 0) {
+			const size_t read = fread(input.data(), 1, input.size(), file);
+			if(read == 0) {
+				// Truncated
+				failed = true;
+				break;
+			}
+			stream.next_in = input.data();
+			stream.avail_in = static_cast<uInt>(read);
+		}
+
+		const int ret = inflate(&stream, Z_NO_FLUSH);
+		if(ret == Z_STREAM_END) {
+			// Another member may follow
+			if(stream.avail_in == 0) {
+				const size_t read = fread(input.data(), 1, input.size(), file);
+				stream.next_in = input.data();
+				stream.avail_in = static_cast<uInt>(read);
+			}
+			if(stream.avail_in == 0) {
+				finished = true;
+			} else {
+				inflateReset(&stream);
+			}
+		} else if(ret != Z_OK) {
+			failed = true;
+			break;
+		}
+	}
+	return size - stream.avail_out;
+}
+
+bool GzipFileReader::skip(uint64_t size)
+{
+	uint8_t buffer[4096];
+	while(size != 0) {
+		const size_t chunk = static_cast<size_t>(std::min<uint64_t>(size, sizeof(buffer)));
+		if(read(buffer, chunk) != chunk)
+			return false;
+		size -= chunk;
+	}
+	return true;
+}
+
+//=============================================================================
+// Archive writer
+
+OTGZWriter::OTGZWriter(const std::string& name) :
+	gzip(name),
+	entry_size(0),
+	in_entry(false)
+{
+	////
+}
+
+bool OTGZWriter::addFile(const std::string& name, const std::string& data)
+{
+	uint8_t header[TAR_BLOCK_SIZE];
+	if(in_entry || !makeTarHeader(header, name, data.size()))
+		return false;
+
+	return gzip.write(header, sizeof(header))
+		&& gzip.write(reinterpret_cast<const uint8_t*>(data.data()), data.size())
+		&& writePadding(data.size());
+}
+
+bool OTGZWriter::beginFile(const std::string& name)
+{
+	uint8_t header[TAR_BLOCK_SIZE];
+	if(in_entry || !makeTarHeader(header, name, 0))
+		return false;
+
+	in_entry = true;
+	entry_name = name;
+	entry_size = 0;
+	return gzip.reserve(header, sizeof(header));
+}
+
+bool OTGZWriter::write(const uint8_t* data, size_t size)
+{
+	ASSERT(in_entry);
+	entry_size += size;
+	return gzip.write(data, size);
+}
+
+bool OTGZWriter::endFile()
+{
+	uint8_t header[TAR_BLOCK_SIZE];
+	if(!in_entry || !makeTarHeader(header, entry_name, entry_size))
+		return false;
+
+	in_entry = false;
+	return writePadding(entry_size) && gzip.rewriteReserved(header);
+}
+
+bool OTGZWriter::finish()
+{
+	// End of archive
+	const uint8_t zeros[TAR_BLOCK_SIZE * 2] = {};
+	return !in_entry && gzip.write(zeros, sizeof(zeros)) && gzip.finish();
+}
+
+bool OTGZWriter::writePadding(uint64_t size)
+{
+	const uint8_t zeros[TAR_BLOCK_SIZE] = {};
+	const size_t padding = static_cast<size_t>((TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE);
+	return gzip.write(zeros, padding);
+}
+
+//=============================================================================
+// Archive reader
+
+OTGZReader::OTGZReader(const std::string& name) :
+	gzip(name),
+	failed(false),
+	entry_left(0),
+	entry_padding(0)
+{
+	////
+}
+
+bool OTGZReader::nextFile(std::string& name, uint64_t& size)
+{
+	if(!isOk() || !gzip.skip(entry_left + entry_padding)) {
+		failed = true;
+		return false;
+	}
+	entry_left = entry_padding = 0;
+
+	// Set by pax and GNU headers for the entry that follows them
+	std::string long_name;
+	uint64_t long_size = 0;
+	bool has_long_size = false;
+
+	uint8_t header[TAR_BLOCK_SIZE];
+	while(readBlock(header)) {
+		if(std::all_of(header, header + TAR_BLOCK_SIZE, [](uint8_t c) { return c == 0; }))
+			return false; // End of archive
+
+		const uint32_t checksum = static_cast<uint32_t>(getNumber(header + 148, 8));
+		if(checksum != getChecksum(header)) {
+			failed = true;
+			return false;
+		}
+
+		const char type = static_cast<char>(header[156]);
+		const uint64_t entry_size = getNumber(header + 124, 12);
+		const uint64_t padding = (TAR_BLOCK_SIZE - entry_size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+
+		if(type == 'x' || type == 'L') {
+			std::string data(static_cast<size_t>(entry_size), '\0');
+			if(gzip.read(reinterpret_cast<uint8_t*>(&data[0]), data.size()) != data.size() || !gzip.skip(padding)) {
+				failed = true;
+				return false;
+			}
+
+			if(type == 'L') {
+				long_name = data.c_str();
+				continue;
+			}
+
+			// "<length> <key>=<value>\n" records
+			size_t offset = 0;
+			while(offset < data.size()) {
+				const size_t space = data.find(' ', offset);
+				const size_t length = std::strtoul(data.c_str() + offset, nullptr, 10);
+				if(space == std::string::npos || length == 0 || offset + length > data.size())
+					break;
+
+				const std::string record = data.substr(space + 1, offset + length - space - 2);
+				const size_t equals = record.find('=');
+				if(equals != std::string::npos) {
+					const std::string key = record.substr(0, equals);
+					if(key == "path") {
+						long_name = record.substr(equals + 1);
+					} else if(key == "size") {
+						long_size = std::strtoull(record.c_str() + equals + 1, nullptr, 10);
+						has_long_size = true;
+					}
+				}
+				offset += length;
+			}
+			continue;
+		}
+
+		if(type != '0' && type != '\0') {
+			// Directories, links and global headers
+			if(!gzip.skip(entry_size + padding)) {
+				failed = true;
+				return false;
+			}
+			long_name.clear();
+			has_long_size = false;
+			continue;
+		}
+
+		if(!long_name.empty()) {
+			name = long_name;
+		} else {
+			const std::string prefix = getString(header + 345, 155);
+			name = getString(header, 100);
+			if(!prefix.empty())
+				name = prefix + "/" + name;
+		}
+		size = has_long_size ? long_size : entry_size;
+
+		entry_left = size;
+		entry_padding = (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+		return true;
+	}
+	return false;
+}
+
+size_t OTGZReader::read(uint8_t* data, size_t size)
+{
+	const size_t wanted = static_cast<size_t>(std::min<uint64_t>(size, entry_left));
+	const size_t read = gzip.read(data, wanted);
+	entry_left -= read;
+	if(read != wanted)
+		failed = true;
+	return read;
+}
+
+bool OTGZReader::readAll(std::string& data)
+{
+	data.resize(static_cast<size_t>(entry_left));
+	return data.empty() || read(reinterpret_cast<uint8_t*>(&data[0]), data.size()) == data.size();
+}
+
+bool OTGZReader::readBlock(uint8_t* block)
+{
+	if(gzip.read(block, TAR_BLOCK_SIZE) != TAR_BLOCK_SIZE) {
+		failed = true;
+		return false;
+	}
+	return true;
+}
+
+//=============================================================================
+// Archive node file handles
+
+OTGZNodeFileWriteHandle::OTGZNodeFileWriteHandle(OTGZWriter& archive, const std::string& identifier) :
+	archive(archive),
+	open(archive.isOk())
+{
+	if(identifier.length() != 4) {
+		error_code = FILE_INVALID_IDENTIFIER;
+		return;
+	}
+	if(!archive.write(reinterpret_cast<const uint8_t*>(identifier.data()), 4)) {
+		error_code = FILE_WRITE_ERROR;
+	}
+	cache = (uint8_t*)malloc(cache_size + 1);
+	local_write_index = 0;
+}
+
+OTGZNodeFileWriteHandle::~OTGZNodeFileWriteHandle()
+{
+	close();
+}
+
+void OTGZNodeFileWriteHandle::close()
+{
+	if(open) {
+		renewCache();
+		open = false;
+	}
+}
+
+void OTGZNodeFileWriteHandle::renewCache()
+{
+	if(cache) {
+		if(!archive.write(cache, local_write_index)) {
+			error_code = FILE_WRITE_ERROR;
+		}
+		flushed_size += local_write_index;
+	} else {
+		cache = (uint8_t*)malloc(cache_size + 1);
+	}
+	local_write_index = 0;
+}
+
+OTGZNodeFileReadHandle::OTGZNodeFileReadHandle(OTGZReader& archive, uint64_t size, const std::vector<std::string>& acceptable_identifiers) :
+	archive(archive),
+	open(false),
+	file_size(size),
+	left(size)
+{
+	uint8_t ver[4];
+	if(left < 4 || archive.read(ver, 4) != 4) {
+		error_code = FILE_SYNTAX_ERROR;
+		return;
+	}
+	left -= 4;
+
+	// 0x00 00 00 00 is accepted as a wildcard version
+	if(ver[0] != 0 || ver[1] != 0 || ver[2] != 0 || ver[3] != 0) {
+		bool accepted = false;
+		for(const std::string& identifier : acceptable_identifiers) {
+			if(memcmp(ver, identifier.c_str(), 4) == 0) {
+				accepted = true;
+				break;
+			}
+		}
+
+		if(!accepted) {
+			error_code = FILE_SYNTAX_ERROR;
+			return;
+		}
+	}
+	open = true;
+}
+
+OTGZNodeFileReadHandle::~OTGZNodeFileReadHandle()
+{
+	close();
+}
+
+void OTGZNodeFileReadHandle::close()
+{
+	freeNode(root_node);
+	root_node = nullptr;
+	open = false;
+	free(cache);
+	cache = nullptr;
+	cache_length = 0;
+	local_read_index = 0;
+}
+
+bool OTGZNodeFileReadHandle::renewCache()
+{
+	if(!cache) {
+		cache = (uint8_t*)malloc(cache_size);
+	}
+	cache_length = archive.read(cache, static_cast<size_t>(std::min<uint64_t>(cache_size, left)));
+	left -= cache_length;
+	local_read_index = 0;
+	if(cache_length == 0 || !archive.isOk()) {
+		return false;
+	}
+	return true;
+}
+
+BinaryNode* OTGZNodeFileReadHandle::getRootNode()
+{
+	assert(root_node == nullptr); // You should never do this twice
+	uint8_t first;
+	if(!open || left == 0 || archive.read(&first, 1) != 1 || first != NODE_START) {
+		error_code = FILE_SYNTAX_ERROR;
+		return nullptr;
+	}
+	--left;
+
+	root_node = getNode(nullptr);
+	root_node->load();
+	return root_node;
+}
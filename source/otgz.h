@@ -0,0 +1,208 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_OTGZ_H_
+#define RME_OTGZ_H_
+
+#include "filehandle.h"
+#include "worker_pool.h"
+
+#include <zlib.h>
+
+// An .otgz map is a tar archive (world/map.otbm, world/houses.xml and
+// world/spawns.xml) compressed as a single gzip member. Both directions are
+// streamed, neither the archive nor the map is ever held in memory as a whole.
+
+// Writes a gzip file, deflating fixed size blocks of the input on the worker
+// threads. Every block is primed with the 32 KiB of input in front of it and
+// ends on a byte boundary (like pigz does), so the blocks join up into one
+// ordinary deflate stream. Only a few blocks per thread are in flight.
+class GzipFileWriter
+{
+public:
+	explicit GzipFileWriter(const std::string& name, int level = Z_DEFAULT_COMPRESSION);
+	~GzipFileWriter();
+
+	GzipFileWriter(const GzipFileWriter&) = delete;
+	GzipFileWriter& operator=(const GzipFileWriter&) = delete;
+
+	bool isOk() const noexcept { return file != nullptr && !failed; }
+
+	bool write(const uint8_t* data, size_t size);
+	// Stores the bytes uncompressed so that rewriteReserved can replace them
+	// (with as many bytes) later on. Only one region of at most 64 KiB can be reserved.
+	bool reserve(const uint8_t* data, size_t size);
+	bool rewriteReserved(const uint8_t* data);
+	// Compresses what is left, writes the gzip trailer and closes the file
+	bool finish();
+
+	uint64_t getInputSize() const noexcept { return input_size; }
+
+private:
+	struct Block
+	{
+		std::vector<uint8_t> input; // The dictionary followed by the data
+		size_t dictionary;
+		size_t length; // Of the data
+		bool last;
+		std::vector<uint8_t> output;
+		uint32_t crc;
+		bool failed;
+	};
+
+	void sealBlock(bool last);
+	bool flushBlocks();
+	bool writeOutput(const void* data, size_t size);
+	static void deflateBlock(Block& block, int level);
+
+	FILE* file;
+	int level;
+	bool failed;
+	WorkerPool pool;
+
+	std::vector<uint8_t> current;
+	// The tail of the input before 'current'
+	std::vector<uint8_t> history;
+	std::vector<Block> pending;
+
+	uint64_t input_size;
+	uint64_t output_size;
+	// CRC of the input since the reserved region (or since the start)
+	uint32_t crc;
+	uint64_t crc_length;
+
+	bool has_reserved;
+	uint64_t reserved_offset; // In the file, of the first reserved byte
+	std::vector<uint8_t> reserved;
+	uint32_t crc_before_reserved;
+};
+
+// Reads the data of a gzip file (of any number of members) as it is inflated
+class GzipFileReader
+{
+public:
+	explicit GzipFileReader(const std::string& name);
+	~GzipFileReader();
+
+	GzipFileReader(const GzipFileReader&) = delete;
+	GzipFileReader& operator=(const GzipFileReader&) = delete;
+
+	bool isOk() const noexcept { return file != nullptr && !failed; }
+
+	// Returns the number of bytes read, less than 'size' only at the end of the data or on errors
+	size_t read(uint8_t* data, size_t size);
+	bool skip(uint64_t size);
+
+private:
+	FILE* file;
+	z_stream stream;
+	bool failed;
+	bool finished;
+	std::vector<uint8_t> input;
+};
+
+class OTGZWriter
+{
+public:
+	explicit OTGZWriter(const std::string& name);
+
+	bool isOk() const noexcept { return gzip.isOk(); }
+
+	bool addFile(const std::string& name, const std::string& data);
+	// Starts an entry whose size is only known once endFile is called,
+	// its contents are passed to write. Only one such entry is possible.
+	bool beginFile(const std::string& name);
+	bool write(const uint8_t* data, size_t size);
+	bool endFile();
+
+	bool finish();
+
+private:
+	bool writePadding(uint64_t size);
+
+	GzipFileWriter gzip;
+	std::string entry_name;
+	uint64_t entry_size;
+	bool in_entry;
+};
+
+class OTGZReader
+{
+public:
+	explicit OTGZReader(const std::string& name);
+
+	bool isOk() const noexcept { return gzip.isOk() && !failed; }
+
+	// Moves on to the next regular file, false at the end of the archive
+	bool nextFile(std::string& name, uint64_t& size);
+	// Reads from the current file
+	size_t read(uint8_t* data, size_t size);
+	bool readAll(std::string& data);
+
+private:
+	bool readBlock(uint8_t* block);
+
+	GzipFileReader gzip;
+	bool failed;
+	uint64_t entry_left;
+	uint64_t entry_padding;
+};
+
+// Writes the nodes into an entry started with OTGZWriter::beginFile
+class OTGZNodeFileWriteHandle : public NodeFileWriteHandle
+{
+public:
+	OTGZNodeFileWriteHandle(OTGZWriter& archive, const std::string& identifier);
+	virtual ~OTGZNodeFileWriteHandle();
+
+	virtual void close();
+	virtual bool isOpen() { return open; }
+	virtual bool isOk() { return open && error_code == FILE_NO_ERROR; }
+
+protected:
+	virtual void renewCache();
+
+	OTGZWriter& archive;
+	bool open;
+};
+
+// Reads the nodes out of the current file of an archive while it is being decompressed
+class OTGZNodeFileReadHandle : public NodeFileReadHandle
+{
+public:
+	OTGZNodeFileReadHandle(OTGZReader& archive, uint64_t size, const std::vector<std::string>& acceptable_identifiers);
+	virtual ~OTGZNodeFileReadHandle();
+
+	virtual void close();
+	virtual BinaryNode* getRootNode();
+
+	virtual bool isOpen() { return open; }
+	virtual bool isOk() { return open && error_code == FILE_NO_ERROR; }
+
+	virtual size_t size() { return static_cast<size_t>(file_size); }
+	virtual size_t tell() { return static_cast<size_t>(file_size - left - (cache_length - local_read_index)); }
+
+protected:
+	virtual bool renewCache();
+
+	OTGZReader& archive;
+	bool open;
+	uint64_t file_size;
+	uint64_t left;
+};
+
+#endif
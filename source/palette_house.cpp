@@ -336,12 +336,10 @@ void HousePalettePanel::OnListBoxDoubleClick(wxCommandEvent& event)
 	if (House* house = reinterpret_cast<House*>(event.GetClientData())) {
 		const Position& position = house->getExit();
 		if (!position.isValid()) {
-			// find a valid tile position
-			for (const Position& tilePosition : house->getTiles()) {
-				if (tilePosition.isValid()) {
-					g_gui.SetScreenCenterPosition(tilePosition);
-					break;
-				}
+			// center on the house itself, on its highest floor
+			Position min_pos, max_pos;
+			if (house->getBounds(min_pos, max_pos)) {
+				g_gui.SetScreenCenterPosition(Position((min_pos.x + max_pos.x) / 2, (min_pos.y + max_pos.y) / 2, min_pos.z));
 			}
 		} else {
 			g_gui.SetScreenCenterPosition(position);
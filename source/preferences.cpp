@@ -82,6 +82,16 @@ wxNotebookPage* PreferencesWindow::CreateGeneralPage()
 	always_make_backup_chkbox->SetValue(g_settings.getInteger(Config::ALWAYS_MAKE_BACKUP) == 1);
 	sizer->Add(always_make_backup_chkbox, 0, wxLEFT | wxTOP, 5);
 
+	incremental_save_chkbox = newd wxCheckBox(general_page, wxID_ANY, "Incremental map saving (experimental)");
+	incremental_save_chkbox->SetValue(g_settings.getInteger(Config::INCREMENTAL_SAVE) == 1);
+	incremental_save_chkbox->SetToolTip("Experimental: when saving a map, parts of it that haven't changed since it was last loaded or saved are copied from the old file instead of being written again. A part counts as unchanged when no edit was recorded in it, its contents are not compared.");
+	sizer->Add(incremental_save_chkbox, 0, wxLEFT | wxTOP, 5);
+
+	item_index_chkbox = newd wxCheckBox(general_page, wxID_ANY, "Index item ids");
+	item_index_chkbox->SetValue(g_settings.getInteger(Config::ITEM_INDEX) == 1);
+	item_index_chkbox->SetToolTip("Keeps track of where every item, action id, unique id and text is placed, so that searching for and replacing items doesn't have to go through the whole map. Uses some more memory.");
+	sizer->Add(item_index_chkbox, 0, wxLEFT | wxTOP, 5);
+
 	update_check_on_startup_chkbox = newd wxCheckBox(general_page, wxID_ANY, "Check for updates on startup");
 	update_check_on_startup_chkbox->SetValue(g_settings.getInteger(Config::USE_UPDATER) == 1);
 	sizer->Add(update_check_on_startup_chkbox, 0, wxLEFT | wxTOP, 5);
@@ -586,6 +596,15 @@ void PreferencesWindow::Apply()
 	// General
 	g_settings.setInteger(Config::WELCOME_DIALOG, show_welcome_dialog_chkbox->GetValue());
 	g_settings.setInteger(Config::ALWAYS_MAKE_BACKUP, always_make_backup_chkbox->GetValue());
+	g_settings.setInteger(Config::INCREMENTAL_SAVE, incremental_save_chkbox->GetValue());
+	if(item_index_chkbox->GetValue() != (g_settings.getInteger(Config::ITEM_INDEX) == 1)) {
+		g_settings.setInteger(Config::ITEM_INDEX, item_index_chkbox->GetValue());
+		for(int index = 0; index < g_gui.GetTabCount(); ++index) {
+			if(MapTab* tab = dynamic_cast<MapTab*>(g_gui.GetTab(index))) {
+				tab->GetMap()->setItemIndexEnabled(item_index_chkbox->GetValue());
+			}
+		}
+	}
 	g_settings.setInteger(Config::USE_UPDATER, update_check_on_startup_chkbox->GetValue());
 	g_settings.setInteger(Config::ONLY_ONE_INSTANCE, only_one_instance_chkbox->GetValue());
 	g_settings.setInteger(Config::UNDO_SIZE, undo_size_spin->GetValue());
@@ -340,13 +340,10 @@ void ReplaceItemsDialog::OnExecuteButtonClicked(wxCommandEvent& WXUNUSED(event))
 
 	int done = 0;
 	for(const ReplacingItem& info : items) {
-		ItemFinder finder(info.replaceId, (uint32_t)g_settings.getInteger(Config::REPLACE_SIZE));
-
-		// search on map
-		foreach_ItemOnMap(editor->getMap(), finder, selectionOnly);
+		std::vector<std::pair<Tile*, Item*>> result;
+		editor->findItems(info.replaceId, selectionOnly, (uint32_t)g_settings.getInteger(Config::REPLACE_SIZE), result);
 
 		uint32_t total = 0;
-		const auto& result = finder.result;
 
 		if(!result.empty()) {
 			BatchAction* batch = editor->createBatch(ACTION_REPLACE_ITEMS);
@@ -41,9 +41,23 @@ Selection::~Selection()
 	delete session;
 }
 
+bool Selection::getOccupancyBounds(Position& min_pos, Position& max_pos) const
+{
+	// Going through the tiles costs a cache miss for each, the bitmaps a few
+	// words for every block of the map, that only pays off for many tiles
+	const OccupancyMap& occupancy = editor.getMap().getOccupancy();
+	if(tiles.size() < 4096 || occupancy.count(OccupancyMap::SELECTED) != tiles.size())
+		return false;
+	return occupancy.getBounds(OccupancyMap::SELECTED, min_pos, max_pos);
+}
+
 Position Selection::minPosition() const
 {
 	Position min_pos(0x10000, 0x10000, 0x10);
+	Position max_pos;
+	if(getOccupancyBounds(min_pos, max_pos))
+		return min_pos;
+
 	for(const Tile* tile : tiles) {
 		if(!tile) continue;
 		const Position& tile_pos = tile->getPosition();
@@ -59,7 +73,11 @@ Position Selection::minPosition() const
 
 Position Selection::maxPosition() const
 {
+	Position min_pos;
 	Position max_pos;
+	if(getOccupancyBounds(min_pos, max_pos))
+		return max_pos;
+
 	for(const Tile* tile : tiles) {
 		if(!tile) continue;
 		const Position& tile_pos = tile->getPosition();
@@ -214,6 +232,7 @@ void Selection::clear()
 	} else {
 		for(Tile* tile : tiles) {
 			tile->deselect();
+			editor.getMap().updateOccupancy(tile);
 		}
 		tiles.clear();
 	}
@@ -86,6 +86,9 @@ public:
 	Tile* getSelectedTile() { ASSERT(size() == 1); return *tiles.begin(); }
 
 private:
+	// Bounds of large selections out of the occupancy bitmaps of the map
+	bool getOccupancyBounds(Position& min_pos, Position& max_pos) const;
+
 	Editor& editor;
 	BatchAction* session;
 	Action* subsession;
@@ -245,6 +245,10 @@ void Settings::IO(IOMode mode)
 	Int(BORDERIZE_DRAG_THRESHOLD, 6000);
 	Int(BORDERIZE_PASTE_THRESHOLD, 10000);
 	Int(ALWAYS_MAKE_BACKUP, 0);
+	Int(INCREMENTAL_SAVE, 0);
+	Int(INCREMENTAL_SAVE_SELF_CHECK, 0);
+	Int(ITEM_INDEX, 1);
+	Int(ITEM_INDEX_SELF_CHECK, 0);
 	Int(USE_AUTOMAGIC, 1);
 	Int(HOUSE_BRUSH_REMOVE_ITEMS, 0);
 	Int(AUTO_ASSIGN_DOORID, 1);
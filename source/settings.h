@@ -79,6 +79,10 @@ namespace Config {
 		BORDERIZE_PASTE_THRESHOLD,
 		ICON_BACKGROUND,
 		ALWAYS_MAKE_BACKUP,
+		INCREMENTAL_SAVE,
+		INCREMENTAL_SAVE_SELF_CHECK,
+		ITEM_INDEX,
+		ITEM_INDEX_SELF_CHECK,
 		USE_AUTOMAGIC,
 		HOUSE_BRUSH_REMOVE_ITEMS,
 		AUTO_ASSIGN_DOORID,
@@ -38,24 +38,103 @@ void Spawns::addSpawn(Tile* tile)
 {
 	ASSERT(tile->spawn);
 
-	auto it = spawns.insert(tile->getPosition());
-	ASSERT(it.second);
+	const Position& position = tile->getPosition();
+	if(!spawns.insert(position).second) {
+		removeArea(position);
+	}
+	addArea(position, tile->spawn->getSize());
 }
 
-void Spawns::removeSpawn(Tile* tile) {
-	ASSERT(tile->spawn);
-	spawns.erase(tile->getPosition());
-#if 0
-	SpawnPositionList::iterator iter = begin();
-	while(iter != end()) {
-		if(*iter == tile->getPosition()) {
-			spawns.erase(iter);
-			return;
+void Spawns::removeSpawn(Tile* tile)
+{
+	const Position& position = tile->getPosition();
+	if(spawns.erase(position) != 0) {
+		removeArea(position);
+	}
+}
+
+void Spawns::erase(SpawnPositionList::iterator iter)
+{
+	removeArea(*iter);
+	spawns.erase(iter);
+}
+
+uint32_t Spawns::getSpawnCount(const Position& position) const
+{
+	uint32_t count = 0;
+	forEachSpawn(position, [&count](const Position&, int) { ++count; });
+	return count;
+}
+
+const Spawns::AreaList* Spawns::getCell(const Position& position) const
+{
+	if(!isInside(position))
+		return nullptr;
+
+	const auto& floor = cells[position.z];
+	auto it = floor.find(getCellKey(position.x >> CELL_SHIFT, position.y >> CELL_SHIFT));
+	if(it == floor.end())
+		return nullptr;
+	return &it->second;
+}
+
+void Spawns::addArea(const Position& center, int radius)
+{
+	if(!isInside(center))
+		return;
+
+	const int start_x = std::max(center.x - radius, 0) >> CELL_SHIFT;
+	const int start_y = std::max(center.y - radius, 0) >> CELL_SHIFT;
+	const int end_x = std::min(center.x + radius, rme::MapMaxWidth) >> CELL_SHIFT;
+	const int end_y = std::min(center.y + radius, rme::MapMaxHeight) >> CELL_SHIFT;
+
+	auto& floor = cells[center.z];
+	for(int cy = start_y; cy <= end_y; ++cy) {
+		for(int cx = start_x; cx <= end_x; ++cx) {
+			floor[getCellKey(cx, cy)].push_back(Area { center.x, center.y, radius });
+		}
+	}
+	++revision;
+}
+
+void Spawns::removeArea(const Position& center)
+{
+	// The cell of the center holds the spawn, whatever its radius is
+	const AreaList* cell = getCell(center);
+	if(!cell)
+		return;
+
+	auto is_center = [&center](const Area& area) { return area.x == center.x && area.y == center.y; };
+	auto found = std::find_if(cell->begin(), cell->end(), is_center);
+	if(found == cell->end())
+		return;
+
+	const int radius = found->radius;
+	++revision;
+
+	const int start_x = std::max(center.x - radius, 0) >> CELL_SHIFT;
+	const int start_y = std::max(center.y - radius, 0) >> CELL_SHIFT;
+	const int end_x = std::min(center.x + radius, rme::MapMaxWidth) >> CELL_SHIFT;
+	const int end_y = std::min(center.y + radius, rme::MapMaxHeight) >> CELL_SHIFT;
+
+	auto& floor = cells[center.z];
+	for(int cy = start_y; cy <= end_y; ++cy) {
+		for(int cx = start_x; cx <= end_x; ++cx) {
+			auto it = floor.find(getCellKey(cx, cy));
+			if(it == floor.end())
+				continue;
+
+			AreaList& areas = it->second;
+			auto area = std::find_if(areas.begin(), areas.end(), is_center);
+			if(area != areas.end()) {
+				*area = areas.back();
+				areas.pop_back();
+			}
+			if(areas.empty()) {
+				floor.erase(it);
+			}
 		}
-		++iter;
 	}
-	ASSERT(false);
-#endif
 }
 
 std::ostream& operator<<(std::ostream& os, const Spawn& spawn) {
@@ -18,6 +18,10 @@
 #ifndef RME_SPAWN_H_
 #define RME_SPAWN_H_
 
+#include "const.h"
+
+#include <unordered_map>
+
 class Tile;
 
 class Spawn
@@ -49,21 +53,77 @@ protected:
 typedef std::set<Position> SpawnPositionList;
 typedef std::list<Spawn*> SpawnList;
 
+// The spawns of a map, by the position of their centers. Every spawn is also
+// kept in the cells (CELL_SIZE x CELL_SIZE tiles of its floor) that its area
+// overlaps, so the spawns around a position are found among the few spawns
+// of one cell instead of by searching the map around it.
 class Spawns
 {
 public:
+	static constexpr int CELL_SHIFT = 5;
+	static constexpr int CELL_SIZE = 1 << CELL_SHIFT;
+
+	// Adding a spawn that is already there updates its radius
 	void addSpawn(Tile* tile);
+	// Does nothing if there is no spawn on the position of the tile
 	void removeSpawn(Tile* tile);
 
+	// Number of spawns whose area contains the position
+	uint32_t getSpawnCount(const Position& position) const;
+	// Calls f(center, radius) for every spawn whose area contains the position
+	template <typename F>
+	void forEachSpawn(const Position& position, F&& f) const;
+
 	SpawnPositionList::iterator begin() noexcept { return spawns.begin(); }
 	SpawnPositionList::const_iterator begin() const noexcept { return spawns.begin(); }
 	SpawnPositionList::iterator end() noexcept { return spawns.end(); }
 	SpawnPositionList::const_iterator end() const noexcept { return spawns.end(); }
-	void erase(SpawnPositionList::iterator iter) noexcept { spawns.erase(iter); }
+	void erase(SpawnPositionList::iterator iter);
 	SpawnPositionList::iterator find(Position& pos) { return spawns.find(pos); }
 
+	// Changes whenever an area is added or removed
+	uint64_t getRevision() const noexcept { return revision; }
+
 private:
+	struct Area
+	{
+		int x;
+		int y;
+		int radius;
+
+		bool contains(int px, int py) const noexcept {
+			return std::abs(px - x) <= radius && std::abs(py - y) <= radius;
+		}
+	};
+	typedef std::vector<Area> AreaList;
+
+	static bool isInside(const Position& position) noexcept {
+		return position.x >= 0 && position.x <= rme::MapMaxWidth && position.y >= 0 && position.y <= rme::MapMaxHeight &&
+			position.z >= rme::MapMinLayer && position.z <= rme::MapMaxLayer;
+	}
+	static uint32_t getCellKey(int cx, int cy) noexcept {
+		return static_cast<uint32_t>(cx) << 16 | static_cast<uint32_t>(cy);
+	}
+	const AreaList* getCell(const Position& position) const;
+
+	void addArea(const Position& center, int radius);
+	void removeArea(const Position& center);
+
 	SpawnPositionList spawns;
+	std::unordered_map<uint32_t, AreaList> cells[rme::MapLayers];
+	uint64_t revision = 0;
 };
 
+template <typename F>
+inline void Spawns::forEachSpawn(const Position& position, F&& f) const
+{
+	if(const AreaList* cell = getCell(position)) {
+		for(const Area& area : *cell) {
+			if(area.contains(position.x, position.y)) {
+				f(Position(area.x, area.y, position.z), area.radius);
+			}
+		}
+	}
+}
+
 #endif
@@ -0,0 +1,145 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+#include "sprite_batch.h"
+
+void SpriteBatch::add(float x, float y, float size, const TextureRegion& region, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+	const uint32_t texture = region.texture;
+	const float max_x = x + size;
+	const float max_y = y + size;
+
+	// Look for a command with the same texture that the quad can join
+	// without being drawn before something it overlaps
+	size_t index = commands.size();
+	for(size_t i = commands.size(); i > 0 && commands.size() - i < LOOKBACK; --i) {
+		const Command& command = commands[i - 1];
+		if(command.texture == texture) {
+			index = i - 1;
+			break;
+		}
+		if(x < command.max_x && command.min_x < max_x && y < command.max_y && command.min_y < max_y) {
+			break;
+		}
+	}
+
+	if(index == commands.size()) {
+		commands.push_back({ texture, 0, 0, x, y, max_x, max_y });
+	} else {
+		Command& command = commands[index];
+		command.min_x = std::min(command.min_x, x);
+		command.min_y = std::min(command.min_y, y);
+		command.max_x = std::max(command.max_x, max_x);
+		command.max_y = std::max(command.max_y, max_y);
+	}
+	commands[index].count += 4;
+
+	quads.push_back({ x, y, size, region.u0, region.v0, region.u1, region.v1, r, g, b, a, static_cast<uint32_t>(index) });
+	prepared = false;
+}
+
+void SpriteBatch::prepare()
+{
+	if(prepared)
+		return;
+
+	uint32_t first = 0;
+	for(Command& command : commands) {
+		command.first = first;
+		first += command.count;
+	}
+
+	// Quads go behind the ones recorded before them in the same command
+	std::vector<uint32_t> next(commands.size());
+	for(size_t i = 0; i < commands.size(); ++i) {
+		next[i] = commands[i].first;
+	}
+
+	vertices.resize(quads.size() * 4);
+	for(const Quad& quad : quads) {
+		Vertex* vertex = &vertices[next[quad.command]];
+		next[quad.command] += 4;
+
+		const float max_x = quad.x + quad.size;
+		const float max_y = quad.y + quad.size;
+		vertex[0] = { quad.x, quad.y, quad.u0, quad.v0, quad.r, quad.g, quad.b, quad.a };
+		vertex[1] = { max_x,  quad.y, quad.u1, quad.v0, quad.r, quad.g, quad.b, quad.a };
+		vertex[2] = { max_x,  max_y,  quad.u1, quad.v1, quad.r, quad.g, quad.b, quad.a };
+		vertex[3] = { quad.x, max_y,  quad.u0, quad.v1, quad.r, quad.g, quad.b, quad.a };
+	}
+	prepared = true;
+}
+
+void SpriteBatch::flush()
+{
+	if(quads.empty())
+		return;
+
+	prepare();
+	draw();
+	clear();
+}
+
+void SpriteBatch::clear() noexcept
+{
+	quads.clear();
+	commands.clear();
+	vertices.clear();
+	prepared = false;
+}
+
+void SpriteBatch::draw()
+{
+	// Untextured commands switch texturing off, the caller's state is put back afterwards
+	const bool textured = glIsEnabled(GL_TEXTURE_2D) == GL_TRUE;
+	bool texturing = textured;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].x);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].u);
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &vertices[0].r);
+
+	for(const Command& command : commands) {
+		if(command.texture == 0) {
+			if(texturing) {
+				glDisable(GL_TEXTURE_2D);
+				texturing = false;
+			}
+		} else {
+			if(!texturing) {
+				glEnable(GL_TEXTURE_2D);
+				texturing = true;
+			}
+			glBindTexture(GL_TEXTURE_2D, command.texture);
+		}
+		glDrawArrays(GL_QUADS, command.first, command.count);
+	}
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	if(texturing != textured) {
+		if(textured)
+			glEnable(GL_TEXTURE_2D);
+		else
+			glDisable(GL_TEXTURE_2D);
+	}
+}
@@ -0,0 +1,86 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_SPRITE_BATCH_H_
+#define RME_SPRITE_BATCH_H_
+
+#include "texture_atlas.h"
+
+// Collects the quads MapDrawer blits and draws them with a few glDrawArrays
+// calls instead of a glBegin/glEnd pair per quad. A quad is moved forward
+// into an earlier command with the same texture when none of the commands
+// it skips overlaps it, so the picture stays the same as drawing the quads
+// in order. Recording doesn't touch OpenGL, prepare() builds the vertices
+// and commands without a context and draw() issues them.
+class SpriteBatch
+{
+public:
+	struct Vertex
+	{
+		float x, y;
+		float u, v;
+		uint8_t r, g, b, a;
+	};
+
+	struct Command
+	{
+		// 0 draws untextured quads
+		uint32_t texture;
+		uint32_t first; // Vertex, set by prepare()
+		uint32_t count; // Vertices
+		// Of all the quads in the command
+		float min_x, min_y, max_x, max_y;
+	};
+
+	// How many commands back a quad may be moved
+	static constexpr size_t LOOKBACK = 16;
+
+	void add(float x, float y, float size, const TextureRegion& region, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+	void addSquare(float x, float y, float size, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+		add(x, y, size, TextureRegion(), r, g, b, a);
+	}
+
+	bool empty() const noexcept { return quads.empty(); }
+	size_t getQuadCount() const noexcept { return quads.size(); }
+
+	// Fills in the vertices and the first vertex of each command
+	void prepare();
+	// Draws what was recorded, in order, and clears the batch
+	void flush();
+	void clear() noexcept;
+
+	const std::vector<Command>& getCommands() const noexcept { return commands; }
+	const std::vector<Vertex>& getVertices() const noexcept { return vertices; }
+
+private:
+	struct Quad
+	{
+		float x, y, size;
+		float u0, v0, u1, v1;
+		uint8_t r, g, b, a;
+		uint32_t command;
+	};
+
+	void draw();
+
+	std::vector<Quad> quads;
+	std::vector<Command> commands;
+	std::vector<Vertex> vertices;
+	bool prepared = false;
+};
+
+#endif
@@ -0,0 +1,158 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+#include "texture_atlas.h"
+
+// Slots in use have an odd generation, removing the sprite or emptying
+// the page makes it even again so that old handles stop matching.
+
+TextureAtlas::TextureAtlas() :
+	pixels(SLOT_SIZE * SLOT_SIZE * 4),
+	frame(1),
+	page_limit(0),
+	sprite_count(0)
+{
+	////
+}
+
+TextureAtlas::~TextureAtlas()
+{
+	for(Page& page : pages) {
+		glDeleteTextures(1, &page.texture);
+	}
+}
+
+void TextureAtlas::add(const uint8_t* rgba, Handle& handle)
+{
+	remove(handle);
+
+	Page* page = getFreePage();
+	const uint16_t index = page->free_slots.back();
+	page->free_slots.pop_back();
+	page->last_frame = frame;
+
+	uint32_t& generation = page->generations[index];
+	++generation;
+	handle.slot = static_cast<uint32_t>(page - pages.data()) * SLOTS_PER_PAGE + index;
+	handle.generation = generation;
+	++sprite_count;
+
+	// Repeat the outermost pixels into the border
+	for(int y = 0; y < SLOT_SIZE; ++y) {
+		const int source_y = std::clamp(y - 1, 0, rme::SpritePixels - 1);
+		for(int x = 0; x < SLOT_SIZE; ++x) {
+			const int source_x = std::clamp(x - 1, 0, rme::SpritePixels - 1);
+			std::memcpy(&pixels[(y * SLOT_SIZE + x) * 4], &rgba[(source_y * rme::SpritePixels + source_x) * 4], 4);
+		}
+	}
+
+	glBindTexture(GL_TEXTURE_2D, page->texture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0,
+		(index % SLOTS_PER_ROW) * SLOT_SIZE, (index / SLOTS_PER_ROW) * SLOT_SIZE,
+		SLOT_SIZE, SLOT_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+void TextureAtlas::remove(Handle& handle)
+{
+	if(contains(handle)) {
+		Page& page = pages[handle.slot / SLOTS_PER_PAGE];
+		const uint16_t index = handle.slot % SLOTS_PER_PAGE;
+		++page.generations[index];
+		page.free_slots.push_back(index);
+		--sprite_count;
+	}
+	handle = Handle();
+}
+
+bool TextureAtlas::contains(const Handle& handle) const noexcept
+{
+	if((handle.generation & 1) == 0)
+		return false;
+
+	const size_t page = handle.slot / SLOTS_PER_PAGE;
+	return page < pages.size() && pages[page].generations[handle.slot % SLOTS_PER_PAGE] == handle.generation;
+}
+
+TextureRegion TextureAtlas::getRegion(const Handle& handle)
+{
+	ASSERT(contains(handle));
+
+	Page& page = pages[handle.slot / SLOTS_PER_PAGE];
+	page.last_frame = frame;
+
+	const uint32_t index = handle.slot % SLOTS_PER_PAGE;
+	const float x = (index % SLOTS_PER_ROW) * SLOT_SIZE + 1;
+	const float y = (index / SLOTS_PER_ROW) * SLOT_SIZE + 1;
+
+	TextureRegion region;
+	region.texture = page.texture;
+	region.u0 = x / PAGE_SIZE;
+	region.v0 = y / PAGE_SIZE;
+	region.u1 = (x + rme::SpritePixels) / PAGE_SIZE;
+	region.v1 = (y + rme::SpritePixels) / PAGE_SIZE;
+	return region;
+}
+
+TextureAtlas::Page* TextureAtlas::getFreePage()
+{
+	for(Page& page : pages) {
+		if(!page.free_slots.empty())
+			return &page;
+	}
+
+	if(page_limit != 0 && pages.size() >= page_limit) {
+		Page* oldest = nullptr;
+		for(Page& page : pages) {
+			if(page.last_frame != frame && (!oldest || page.last_frame < oldest->last_frame))
+				oldest = &page;
+		}
+		if(oldest) {
+			evict(*oldest);
+			return oldest;
+		}
+	}
+
+	Page& page = pages.emplace_back();
+	page.generations.resize(SLOTS_PER_PAGE);
+	page.free_slots.reserve(SLOTS_PER_PAGE);
+	for(int index = SLOTS_PER_PAGE - 1; index >= 0; --index) {
+		page.free_slots.push_back(static_cast<uint16_t>(index));
+	}
+
+	glGenTextures(1, &page.texture);
+	glBindTexture(GL_TEXTURE_2D, page.texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // Linear Filtering
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Linear Filtering
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, 0x812F); // GL_CLAMP_TO_EDGE
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, 0x812F); // GL_CLAMP_TO_EDGE
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, PAGE_SIZE, PAGE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	return &page;
+}
+
+void TextureAtlas::evict(Page& page)
+{
+	page.free_slots.clear();
+	for(int index = SLOTS_PER_PAGE - 1; index >= 0; --index) {
+		uint32_t& generation = page.generations[index];
+		if(generation & 1) {
+			++generation;
+			--sprite_count;
+		}
+		page.free_slots.push_back(static_cast<uint16_t>(index));
+	}
+}
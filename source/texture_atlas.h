@@ -0,0 +1,89 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_TEXTURE_ATLAS_H_
+#define RME_TEXTURE_ATLAS_H_
+
+// Where a sprite is on a GL texture, texture 0 means there is nothing to draw
+struct TextureRegion
+{
+	GLuint texture = 0;
+	float u0 = 0.f, v0 = 0.f;
+	float u1 = 1.f, v1 = 1.f;
+};
+
+// Packs the 32x32 sprite images into a few large textures (pages) so that
+// consecutive blits mostly use the same texture. Every slot has a one pixel
+// border repeating the edge of the sprite, linear filtering never picks up
+// the neighbouring sprites. When all pages are full and no more may be made,
+// the page used least recently is emptied, except for pages used during the
+// current frame which may still be waiting in a SpriteBatch.
+class TextureAtlas
+{
+public:
+	static constexpr int PAGE_SIZE = 1024;
+	static constexpr int SLOT_SIZE = rme::SpritePixels + 2;
+	static constexpr int SLOTS_PER_ROW = PAGE_SIZE / SLOT_SIZE;
+	static constexpr int SLOTS_PER_PAGE = SLOTS_PER_ROW * SLOTS_PER_ROW;
+
+	// Stays valid until the sprite is removed or its page is emptied
+	struct Handle
+	{
+		uint32_t slot = 0;
+		uint32_t generation = 0;
+	};
+
+	TextureAtlas();
+	~TextureAtlas();
+
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+	// Copies 32x32 RGBA pixels into a free slot, needs the GL context
+	void add(const uint8_t* rgba, Handle& handle);
+	void remove(Handle& handle);
+	bool contains(const Handle& handle) const noexcept;
+	// Also marks the page as used during this frame
+	TextureRegion getRegion(const Handle& handle);
+
+	void nextFrame() noexcept { ++frame; }
+	// 0 means no limit, pages in use during the frame are kept anyway
+	void setPageLimit(size_t limit) noexcept { page_limit = limit; }
+
+	size_t getSpriteCount() const noexcept { return sprite_count; }
+	size_t getPageCount() const noexcept { return pages.size(); }
+
+private:
+	struct Page
+	{
+		GLuint texture = 0;
+		uint64_t last_frame = 0;
+		std::vector<uint32_t> generations;
+		std::vector<uint16_t> free_slots;
+	};
+
+	Page* getFreePage();
+	void evict(Page& page);
+
+	std::vector<Page> pages;
+	std::vector<uint8_t> pixels;
+	uint64_t frame;
+	size_t page_limit;
+	size_t sprite_count;
+};
+
+#endif
@@ -66,6 +66,11 @@ Tile::~Tile()
 	delete spawn;
 }
 
+void Tile::operator delete(void* pointer)
+{
+	SlabPool::release(pointer);
+}
+
 Tile* Tile::deepCopy(BaseMap& map) const
 {
 	Tile* copy = map.allocator.allocateTile(location);
@@ -107,7 +112,6 @@ int Tile::size() const
 	if(spawn) ++sz;
 	if(location) {
 		if(location->getHouseExits()) ++sz;
-		if(location->getSpawnCount()) ++sz;
 		if(location->getWaypointCount()) ++ sz;
 	}
 	return sz;
@@ -64,6 +64,10 @@ public:
 
 	~Tile();
 
+	// Tiles live in the slabs of MapAllocator, allocate them through it
+	static void* operator new(size_t) = delete;
+	static void operator delete(void* pointer);
+
 	// Argument is a the map to allocate the tile from
 	Tile* deepCopy(BaseMap& map) const;
 
@@ -92,7 +96,8 @@ public: //Functions
 
 	// Get memory footprint size
 	uint32_t memsize() const;
-	// Get number of items on the tile
+	// Get number of items on the tile, the spawn areas it lies in are left to
+	// Map::getTileSize
 	bool empty() const { return size() == 0; }
 	int size() const;
 
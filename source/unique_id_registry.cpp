@@ -0,0 +1,68 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "unique_id_registry.h"
+
+UniqueIdRegistry::UniqueIdRegistry()
+{
+	////
+}
+
+void UniqueIdRegistry::add(uint16_t uid, const Position& position)
+{
+	if(entries.empty())
+		entries.resize(0x10000);
+
+	PositionVector& positions = entries[uid];
+	positions.push_back(position);
+	if(positions.size() == 2)
+		duplicates.insert(uid);
+}
+
+void UniqueIdRegistry::remove(uint16_t uid, const Position& position)
+{
+	if(entries.empty())
+		return;
+
+	PositionVector& positions = entries[uid];
+	auto it = std::find(positions.begin(), positions.end(), position);
+	if(it == positions.end())
+		return;
+
+	// Order doesn't matter, so don't shift the rest
+	*it = positions.back();
+	positions.pop_back();
+	if(positions.size() == 1)
+		duplicates.erase(uid);
+}
+
+void UniqueIdRegistry::clear()
+{
+	entries.clear();
+	entries.shrink_to_fit();
+	duplicates.clear();
+}
+
+const PositionVector& UniqueIdRegistry::getPositions(uint16_t uid) const
+{
+	static const PositionVector empty;
+	if(entries.empty())
+		return empty;
+	return entries[uid];
+}
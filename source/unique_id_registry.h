@@ -0,0 +1,51 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_UNIQUE_ID_REGISTRY_H_
+#define RME_UNIQUE_ID_REGISTRY_H_
+
+#include "position.h"
+
+#include <set>
+#include <vector>
+
+// Tracks every use of every unique id on a map, so lookups and duplicate
+// checks never have to scan the map.
+class UniqueIdRegistry
+{
+public:
+	UniqueIdRegistry();
+
+	void add(uint16_t uid, const Position& position);
+	void remove(uint16_t uid, const Position& position);
+	void clear();
+
+	bool contains(uint16_t uid) const { return getCount(uid) != 0; }
+	size_t getCount(uint16_t uid) const { return entries.empty() ? 0 : entries[uid].size(); }
+	// One position per use, a tile holding the id twice is listed twice
+	const PositionVector& getPositions(uint16_t uid) const;
+
+	// Ids that are used more than once, in ascending order
+	const std::set<uint16_t>& getDuplicates() const noexcept { return duplicates; }
+
+private:
+	// Indexed by unique id, only allocated once the first id is added
+	std::vector<PositionVector> entries;
+	std::set<uint16_t> duplicates;
+};
+
+#endif
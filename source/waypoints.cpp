@@ -30,12 +30,7 @@ Waypoints::~Waypoints()
 void Waypoints::addWaypoint(Waypoint* wp)
 {
 	removeWaypoint(wp->name);
-	if(wp->pos.isValid()) {
-		Tile* t = map.getTile(wp->pos);
-		if(!t)
-			map.setTile(wp->pos, t = map.allocator(map.createTileL(wp->pos)));
-		t->getLocation()->increaseWaypointCount();
-	}
+	addPosition(wp);
 	waypoints.insert(std::make_pair(as_lower_str(wp->name), wp));
 }
 
@@ -49,16 +44,26 @@ Waypoint* Waypoints::getWaypoint(std::string name)
 }
 
 Waypoint* Waypoints::getWaypoint(const Position& position)
+{
+	return const_cast<Waypoint*>(static_cast<const Waypoints*>(this)->getWaypoint(position));
+}
+
+const Waypoint* Waypoints::getWaypoint(const Position& position) const
 {
 	if(!position.isValid())
 		return nullptr;
-	// TODO find waypoint by position hash.
-	for(WaypointMap::iterator it = waypoints.begin(); it != waypoints.end(); it++) {
-		Waypoint* waypoint = it->second;
-		if(waypoint && waypoint->pos == position)
-			return waypoint;
-	}
-	return nullptr;
+
+	auto it = positions.find(getPositionKey(position));
+	if(it == positions.end())
+		return nullptr;
+	return it->second;
+}
+
+void Waypoints::moveWaypoint(Waypoint* wp, const Position& position)
+{
+	removePosition(wp);
+	wp->pos = position;
+	addPosition(wp);
 }
 
 void Waypoints::removeWaypoint(std::string name)
@@ -67,6 +72,36 @@ void Waypoints::removeWaypoint(std::string name)
 	WaypointMap::iterator iter = waypoints.find(name);
 	if(iter == waypoints.end())
 		return;
+	removePosition(iter->second);
 	delete iter->second;
 	waypoints.erase(iter);
 }
+
+void Waypoints::addPosition(Waypoint* wp)
+{
+	if(!wp->pos.isValid())
+		return;
+
+	Tile* t = map.getTile(wp->pos);
+	if(!t)
+		map.setTile(wp->pos, t = map.allocator(map.createTileL(wp->pos)));
+	t->getLocation()->increaseWaypointCount();
+	positions.emplace(getPositionKey(wp->pos), wp);
+}
+
+void Waypoints::removePosition(Waypoint* wp)
+{
+	if(!wp->pos.isValid())
+		return;
+
+	auto range = positions.equal_range(getPositionKey(wp->pos));
+	for(auto it = range.first; it != range.second; ++it) {
+		if(it->second == wp) {
+			positions.erase(it);
+			TileLocation* location = map.getTileL(wp->pos);
+			if(location && location->getWaypointCount() > 0)
+				location->decreaseWaypointCount();
+			return;
+		}
+	}
+}
@@ -20,6 +20,8 @@
 
 #include "position.h"
 
+#include <unordered_map>
+
 class Waypoint
 {
 public:
@@ -29,6 +31,14 @@ public:
 
 typedef std::map<std::string, Waypoint*> WaypointMap;
 
+// Waypoints by (lower case) name, and by position. Waypoints must be added,
+// moved and removed through this class so that both stay in sync, it also
+// keeps the waypoint counts of the tile locations.
+//
+// Only single positions are indexed, there is no grid for area queries. The
+// drawer tells from the waypoint count of a location whether the tile has a
+// waypoint and then looks it up by position, so drawing costs the same no
+// matter how many waypoints the map has.
 class Waypoints
 {
 public:
@@ -37,7 +47,10 @@ public:
 
 	void addWaypoint(Waypoint* wp);
 	Waypoint* getWaypoint(std::string name);
+	// Through the position hash, nullptr if there is no waypoint there
 	Waypoint* getWaypoint(const Position& position);
+	const Waypoint* getWaypoint(const Position& position) const;
+	void moveWaypoint(Waypoint* wp, const Position& position);
 	void removeWaypoint(std::string name);
 
 	WaypointMap waypoints;
@@ -48,7 +61,16 @@ public:
 	WaypointMap::const_iterator end() const { return waypoints.end(); }
 
 private:
+	static uint64_t getPositionKey(const Position& position) noexcept {
+		return static_cast<uint64_t>(static_cast<uint16_t>(position.x)) |
+			static_cast<uint64_t>(static_cast<uint16_t>(position.y)) << 16 |
+			static_cast<uint64_t>(static_cast<uint8_t>(position.z)) << 32;
+	}
+	void addPosition(Waypoint* wp);
+	void removePosition(Waypoint* wp);
+
 	Map& map;
+	std::unordered_multimap<uint64_t, Waypoint*> positions;
 };
 
 #endif
@@ -0,0 +1,37 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "worker_pool.h"
+#include "settings.h"
+
+WorkerPool::WorkerPool(size_t threads) :
+	thread_count(threads == 0 ? getDefaultThreadCount() : threads)
+{
+	////
+}
+
+size_t WorkerPool::getDefaultThreadCount()
+{
+	return static_cast<size_t>(std::max(g_settings.getInteger(Config::WORKER_THREADS), 1));
+}
+
+size_t WorkerPool::getHardwareThreadCount()
+{
+	return std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 64);
+}
@@ -0,0 +1,200 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_WORKER_POOL_H_
+#define RME_WORKER_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs bulk map work (loading, saving, scans) on a set of short-lived worker threads.
+// Tasks must not touch the GUI or any shared map structure without their own locking.
+class WorkerPool
+{
+public:
+	// 0 uses the "worker threads" preference
+	explicit WorkerPool(size_t threads = 0);
+
+	size_t getThreadCount() const noexcept { return thread_count; }
+
+	// Calls task(index) for every index in [0, count) and returns once all calls are done.
+	template <typename Task>
+	void run(size_t count, Task task);
+
+	// Calls produce(index) on the workers and consume(index) on the calling thread in
+	// index order, as soon as that index has been produced. At most 'window' produced
+	// but not yet consumed indices exist at any time (0 picks a default).
+	template <typename Produce, typename Consume>
+	void runOrdered(size_t count, Produce produce, Consume consume, size_t window = 0);
+
+	// The "worker threads" preference
+	static size_t getDefaultThreadCount();
+	// One thread per core (at most 64), for work that always scales, such as decoding a map
+	static size_t getHardwareThreadCount();
+
+private:
+	size_t thread_count;
+};
+
+template <typename Task>
+void WorkerPool::run(size_t count, Task task)
+{
+	if(count == 0)
+		return;
+
+	const size_t workers = std::min(thread_count, count);
+	if(workers <= 1) {
+		for(size_t index = 0; index < count; ++index)
+			task(index);
+		return;
+	}
+
+	std::atomic<size_t> next(0);
+	std::atomic<bool> abort(false);
+	std::exception_ptr failure;
+	std::mutex failure_mutex;
+
+	auto work = [&]() {
+		size_t index;
+		while(!abort && (index = next++) < count) {
+			try {
+				task(index);
+			} catch(...) {
+				std::lock_guard<std::mutex> lock(failure_mutex);
+				if(!failure)
+					failure = std::current_exception();
+				abort = true;
+			}
+		}
+	};
+
+	// The calling thread takes part as well
+	std::vector<std::thread> threads;
+	threads.reserve(workers - 1);
+	for(size_t i = 1; i < workers; ++i)
+		threads.emplace_back(work);
+	work();
+
+	for(std::thread& thread : threads)
+		thread.join();
+
+	if(failure)
+		std::rethrow_exception(failure);
+}
+
+template <typename Produce, typename Consume>
+void WorkerPool::runOrdered(size_t count, Produce produce, Consume consume, size_t window)
+{
+	if(count == 0)
+		return;
+
+	if(thread_count <= 1 || count == 1) {
+		for(size_t index = 0; index < count; ++index) {
+			produce(index);
+			consume(index);
+		}
+		return;
+	}
+
+	if(window == 0)
+		window = thread_count * 4;
+
+	std::mutex mutex;
+	std::condition_variable produced;
+	std::condition_variable consumed;
+	std::vector<uint8_t> ready(count, 0);
+	size_t next = 0;
+	size_t consumed_count = 0;
+	bool abort = false;
+	std::exception_ptr failure;
+
+	auto fail = [&]() {
+		std::lock_guard<std::mutex> lock(mutex);
+		if(!failure)
+			failure = std::current_exception();
+		abort = true;
+	};
+
+	auto work = [&]() {
+		while(true) {
+			size_t index;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				consumed.wait(lock, [&]() { return abort || next >= count || next < consumed_count + window; });
+				if(abort || next >= count)
+					return;
+				index = next++;
+			}
+
+			try {
+				produce(index);
+			} catch(...) {
+				fail();
+				produced.notify_all();
+				consumed.notify_all();
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				ready[index] = 1;
+			}
+			produced.notify_all();
+		}
+	};
+
+	// The calling thread only consumes, so every worker gets a thread of its own
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count);
+	for(size_t i = 0; i < std::min(thread_count, count); ++i)
+		threads.emplace_back(work);
+
+	for(size_t index = 0; index < count; ++index) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			produced.wait(lock, [&]() { return abort || ready[index] != 0; });
+			if(abort)
+				break;
+		}
+
+		try {
+			consume(index);
+		} catch(...) {
+			fail();
+			consumed.notify_all();
+			break;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			++consumed_count;
+		}
+		consumed.notify_all();
+	}
+
+	for(std::thread& thread : threads)
+		thread.join();
+
+	if(failure)
+		std::rethrow_exception(failure);
+}
+
+#endif
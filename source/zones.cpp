@@ -0,0 +1,232 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "zones.h"
+
+bool Zones::add(uint16_t zone_id, const Position& position)
+{
+	if(!isInside(position))
+		return false;
+
+	Zone& zone = zones[zone_id];
+	SpanMap& spans = zone.floors[position.z];
+	const int x = position.x;
+	const int y = position.y;
+	zone.dirty_labels |= 1 << position.z;
+
+	// The run that starts after x, the one before it may hold x already
+	SpanMap::iterator next = spans.upper_bound(getKey(x, y));
+	const bool joins_next = next != spans.end() && getY(next->first) == y && getX(next->first) == x + 1;
+	if(next != spans.begin()) {
+		SpanMap::iterator previous = std::prev(next);
+		if(getY(previous->first) == y) {
+			if(previous->second >= x)
+				return false;
+
+			if(previous->second == x - 1) {
+				previous->second = x;
+				if(joins_next) {
+					previous->second = next->second;
+					spans.erase(next);
+				}
+				++zone.tiles;
+				return true;
+			}
+		}
+	}
+
+	int end_x = x;
+	if(joins_next) {
+		end_x = next->second;
+		next = spans.erase(next);
+	}
+	spans.emplace_hint(next, getKey(x, y), end_x);
+	++zone.tiles;
+	return true;
+}
+
+bool Zones::remove(uint16_t zone_id, const Position& position)
+{
+	if(!isInside(position))
+		return false;
+
+	auto zone_it = zones.find(zone_id);
+	if(zone_it == zones.end())
+		return false;
+
+	Zone& zone = zone_it->second;
+	SpanMap& spans = zone.floors[position.z];
+	const int x = position.x;
+	const int y = position.y;
+
+	SpanMap::iterator span = spans.upper_bound(getKey(x, y));
+	if(span == spans.begin())
+		return false;
+	--span;
+	if(getY(span->first) != y || span->second < x)
+		return false;
+	zone.dirty_labels |= 1 << position.z;
+
+	// Cut x out of the run, what is left on either side stays
+	const int end_x = span->second;
+	if(getX(span->first) == x) {
+		span = spans.erase(span);
+	} else {
+		span->second = x - 1;
+		++span;
+	}
+	if(end_x > x) {
+		spans.emplace_hint(span, getKey(x + 1, y), end_x);
+	}
+
+	if(--zone.tiles == 0) {
+		zones.erase(zone_it);
+	}
+	return true;
+}
+
+bool Zones::contains(uint16_t zone_id, const Position& position) const
+{
+	if(!isInside(position))
+		return false;
+
+	auto zone_it = zones.find(zone_id);
+	if(zone_it == zones.end())
+		return false;
+
+	const SpanMap& spans = zone_it->second.floors[position.z];
+	SpanMap::const_iterator span = spans.upper_bound(getKey(position.x, position.y));
+	if(span == spans.begin())
+		return false;
+	--span;
+	return getY(span->first) == position.y && span->second >= position.x;
+}
+
+void Zones::update(const Position& position, const std::vector<uint16_t>& old_ids, const std::vector<uint16_t>& new_ids)
+{
+	// Tiles hold one or two zones, no need for anything smarter
+	for(uint16_t zone_id : old_ids) {
+		if(std::find(new_ids.begin(), new_ids.end(), zone_id) == new_ids.end())
+			remove(zone_id, position);
+	}
+	for(uint16_t zone_id : new_ids) {
+		add(zone_id, position);
+	}
+}
+
+std::vector<uint16_t> Zones::getZoneIds() const
+{
+	std::vector<uint16_t> ids;
+	ids.reserve(zones.size());
+	for(const auto& zone : zones) {
+		ids.push_back(zone.first);
+	}
+	return ids;
+}
+
+uint64_t Zones::getTileCount(uint16_t zone_id) const
+{
+	auto it = zones.find(zone_id);
+	return it != zones.end() ? it->second.tiles : 0;
+}
+
+void Zones::updateLabels(Zone& zone, int z)
+{
+	zone.dirty_labels &= ~(1 << z);
+
+	struct Run
+	{
+		int start_x, end_x, y;
+		size_t area; // Union-find parent
+	};
+
+	const SpanMap& spans = zone.floors[z];
+	std::vector<Run> runs;
+	runs.reserve(spans.size());
+	for(const auto& span : spans) {
+		runs.push_back({ getX(span.first), span.second, getY(span.first), runs.size() });
+	}
+
+	auto find = [&runs](size_t run) {
+		while(runs[run].area != run) {
+			runs[run].area = runs[runs[run].area].area;
+			run = runs[run].area;
+		}
+		return run;
+	};
+
+	// Join the runs that touch a run of the row above
+	size_t above = 0; // First run of the row above not left of the current run
+	size_t row = 0; // First run of the current row
+	for(size_t i = 0; i < runs.size(); ++i) {
+		if(runs[i].y != runs[row].y) {
+			above = runs[row].y + 1 == runs[i].y ? row : i;
+			row = i;
+		}
+		if(above == row)
+			continue;
+
+		while(above < row && runs[above].end_x < runs[i].start_x)
+			++above;
+		for(size_t j = above; j < row && runs[j].start_x <= runs[i].end_x; ++j) {
+			const size_t a = find(i);
+			const size_t b = find(j);
+			if(a != b)
+				runs[std::max(a, b)].area = std::min(a, b);
+		}
+	}
+
+	// The middle of every area, then the tile closest to it
+	struct Area
+	{
+		double tiles = 0, sum_x = 0, sum_y = 0;
+		double distance = std::numeric_limits<double>::max();
+		uint32_t label = 0;
+	};
+
+	std::vector<Area> areas(runs.size());
+	for(size_t i = 0; i < runs.size(); ++i) {
+		const Run& run = runs[i];
+		Area& area = areas[find(i)];
+		const double length = run.end_x - run.start_x + 1;
+		area.tiles += length;
+		area.sum_x += (double(run.start_x) + run.end_x) * length / 2;
+		area.sum_y += double(run.y) * length;
+	}
+	for(size_t i = 0; i < runs.size(); ++i) {
+		const Run& run = runs[i];
+		Area& area = areas[find(i)];
+		const double center_x = area.sum_x / area.tiles;
+		const double center_y = area.sum_y / area.tiles;
+		const int x = std::clamp(static_cast<int>(std::lround(center_x)), run.start_x, run.end_x);
+		const double distance = (x - center_x) * (x - center_x) + (run.y - center_y) * (run.y - center_y);
+		if(distance < area.distance) {
+			area.distance = distance;
+			area.label = getKey(x, run.y);
+		}
+	}
+
+	std::vector<uint32_t>& labels = zone.labels[z];
+	labels.clear();
+	for(size_t i = 0; i < runs.size(); ++i) {
+		if(runs[i].area == i)
+			labels.push_back(areas[i].label);
+	}
+	std::sort(labels.begin(), labels.end());
+}
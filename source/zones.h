@@ -0,0 +1,130 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_ZONES_H_
+#define RME_ZONES_H_
+
+#include "const.h"
+#include "position.h"
+
+// The zone areas of a map. The zone ids themselves live on the tiles (that
+// is what the brushes, the copy buffer and undo work with), Map mirrors
+// them here as it replaces tiles. Every zone is kept as runs of tiles along
+// the rows of each floor, so a zone can be written out or walked without
+// visiting the map and large zones take little memory.
+//
+// Every connected area of a zone (tiles joined by their sides) has a label
+// position, the tile closest to the middle of the area. Edits only mark the
+// floor of the zone, its labels are found again from the runs the next time
+// they are asked for.
+class Zones
+{
+public:
+	bool empty() const noexcept { return zones.empty(); }
+	size_t size() const noexcept { return zones.size(); }
+	void clear() { zones.clear(); }
+
+	// False if the tile already was (not) in the zone
+	bool add(uint16_t zone_id, const Position& position);
+	bool remove(uint16_t zone_id, const Position& position);
+	bool contains(uint16_t zone_id, const Position& position) const;
+	// Moves a position from the zones in one list to the zones in the other
+	void update(const Position& position, const std::vector<uint16_t>& old_ids, const std::vector<uint16_t>& new_ids);
+
+	// Ids of the zones that have tiles, in order
+	std::vector<uint16_t> getZoneIds() const;
+	uint64_t getTileCount(uint16_t zone_id) const;
+
+	// Calls f(start_x, end_x, y, z) for every run of the zone (end_x included),
+	// by floor, row and column
+	template <typename F>
+	void forEachSpan(uint16_t zone_id, F&& f) const;
+
+	// Calls f(zone_id, x, y) for the labels of the floor inside the area (both
+	// corners included), by zone, row and column
+	template <typename F>
+	void forEachLabel(int z, int start_x, int start_y, int end_x, int end_y, F&& f);
+
+private:
+	// Runs of one floor, by (y, start_x), holding their end_x
+	typedef std::map<uint32_t, int> SpanMap;
+
+	struct Zone
+	{
+		SpanMap floors[rme::MapLayers];
+		// Sorted keys of the label positions, valid unless the floor's bit is set in dirty_labels
+		std::vector<uint32_t> labels[rme::MapLayers];
+		uint16_t dirty_labels = 0;
+		uint64_t tiles = 0;
+	};
+
+	static void updateLabels(Zone& zone, int z);
+
+	static bool isInside(const Position& position) noexcept {
+		return position.x >= 0 && position.x <= 0xFFFF && position.y >= 0 && position.y <= 0xFFFF &&
+			position.z >= rme::MapMinLayer && position.z <= rme::MapMaxLayer;
+	}
+	static uint32_t getKey(int x, int y) noexcept { return static_cast<uint32_t>(y) << 16 | static_cast<uint32_t>(x); }
+	static int getX(uint32_t key) noexcept { return key & 0xFFFF; }
+	static int getY(uint32_t key) noexcept { return key >> 16; }
+
+	std::map<uint16_t, Zone> zones;
+};
+
+template <typename F>
+inline void Zones::forEachSpan(uint16_t zone_id, F&& f) const
+{
+	auto it = zones.find(zone_id);
+	if(it == zones.end())
+		return;
+
+	for(int z = 0; z < rme::MapLayers; ++z) {
+		for(const auto& span : it->second.floors[z]) {
+			f(getX(span.first), span.second, getY(span.first), z);
+		}
+	}
+}
+
+template <typename F>
+inline void Zones::forEachLabel(int z, int start_x, int start_y, int end_x, int end_y, F&& f)
+{
+	if(z < rme::MapMinLayer || z > rme::MapMaxLayer)
+		return;
+
+	start_x = std::max(start_x, 0);
+	start_y = std::max(start_y, 0);
+	end_x = std::min(end_x, 0xFFFF);
+	end_y = std::min(end_y, 0xFFFF);
+	if(start_x > end_x || start_y > end_y)
+		return;
+
+	for(auto& it : zones) {
+		Zone& zone = it.second;
+		if(zone.dirty_labels & (1 << z))
+			updateLabels(zone, z);
+
+		const std::vector<uint32_t>& labels = zone.labels[z];
+		auto label = std::lower_bound(labels.begin(), labels.end(), getKey(start_x, start_y));
+		for(; label != labels.end() && getY(*label) <= end_y; ++label) {
+			const int x = getX(*label);
+			if(x >= start_x && x <= end_x)
+				f(it.first, x, getY(*label));
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,147 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "editor.h"
+#include "copybuffer.h"
+#include "action.h"
+#include "iomap_otbm.h"
+#include "tile.h"
+#include "item.h"
+
+#include "map_generator.h"
+#include "test.h"
+
+namespace {
+	// Two 256x256 areas wide, on two floors
+	MapGeneratorOptions getMapOptions()
+	{
+		MapGeneratorOptions options;
+		options.width = 320;
+		options.height = 64;
+		options.floors = 2;
+		options.houses = 4;
+		options.spawns = 8;
+		options.zones = 0;
+		return options;
+	}
+
+	bool save(Map& map, const std::string& path)
+	{
+		IOMapOTBM saver(map.getVersion());
+		return saver.saveMap(map, wxstr(path));
+	}
+
+	// The way Editor::saveMap does it: the previous file is moved aside and the
+	// unchanged areas are copied from there
+	bool saveIncrementally(Map& map, const std::string& path)
+	{
+		const std::string backup = path + "~";
+		std::remove(backup.c_str());
+		std::rename(path.c_str(), backup.c_str());
+
+		IOMapOTBM saver(map.getVersion());
+		saver.setIncrementalSource(backup);
+		return saver.saveMap(map, wxstr(path));
+	}
+
+	// What a full save writes, the map still remembers the file it was saved to before
+	std::string saveFull(Map& map, const std::string& path)
+	{
+		const OTBMAreaIndex saved_areas = map.saved_areas;
+		const bool saved = save(map, path);
+		map.saved_areas = saved_areas;
+		return saved ? test::readFile(path) : std::string();
+	}
+
+	// Puts an item on a few tiles of one area, through an action like any edit
+	void editSomeTiles(Editor& editor, int x, int y)
+	{
+		Map& map = editor.getMap();
+		Action* action = editor.createAction(ACTION_DRAW);
+		for(int offset = 0; offset < 8; ++offset) {
+			if(Tile* tile = map.getTile(x + offset, y + offset, rme::MapGroundLayer)) {
+				Tile* new_tile = tile->deepCopy(map);
+				new_tile->addItem(Item::Create(210));
+				action->addChange(newd Change(new_tile));
+			}
+		}
+		editor.addAction(action);
+	}
+}
+
+TEST_CASE(incremental_save_matches_full_save)
+{
+	test::ScopedSetting self_check(Config::INCREMENTAL_SAVE_SELF_CHECK, 0);
+
+	CopyBuffer copybuffer;
+	Editor editor(copybuffer, bench::getMapVersion());
+	Map& map = editor.getMap();
+	bench::generateMap(map, getMapOptions());
+
+	const std::string path = test::getTempPath("incremental.otbm");
+	const std::string full_path = test::getTempPath("full.otbm");
+	CHECK(save(map, path));
+
+	// Nothing changed, every area is copied
+	CHECK(saveIncrementally(map, path));
+	CHECK(test::readFile(path) == saveFull(map, full_path));
+
+	editSomeTiles(editor, bench::BASE_POSITION + 10, bench::BASE_POSITION + 10);
+	CHECK(saveIncrementally(map, path));
+	CHECK(test::readFile(path) == saveFull(map, full_path));
+
+	// Edits in the other area, and taking back the first ones
+	editSomeTiles(editor, bench::BASE_POSITION + 300, bench::BASE_POSITION + 20);
+	editor.undo(2);
+	editor.redo(1);
+	CHECK(saveIncrementally(map, path));
+	CHECK(test::readFile(path) == saveFull(map, full_path));
+}
+
+TEST_CASE(incremental_save_self_check_rewrites_stale_areas)
+{
+	CopyBuffer copybuffer;
+	Editor editor(copybuffer, bench::getMapVersion());
+	Map& map = editor.getMap();
+	bench::generateMap(map, getMapOptions());
+
+	const std::string path = test::getTempPath("stale.otbm");
+	const std::string full_path = test::getTempPath("stale-full.otbm");
+	CHECK(save(map, path));
+
+	// Changed behind the map's back, the area is still taken as unchanged
+	Tile* tile = nullptr;
+	for(int x = bench::BASE_POSITION; !tile; ++x) {
+		tile = map.getTile(x, bench::BASE_POSITION, rme::MapGroundLayer);
+	}
+	tile->addItem(Item::Create(210));
+	const std::string expected = saveFull(map, full_path);
+
+	{
+		test::ScopedSetting self_check(Config::INCREMENTAL_SAVE_SELF_CHECK, 0);
+		CHECK(saveIncrementally(map, path));
+		// The old bytes were copied, which is what the self check is for
+		CHECK(test::readFile(path) != expected);
+	}
+	{
+		test::ScopedSetting self_check(Config::INCREMENTAL_SAVE_SELF_CHECK, 1);
+		CHECK(saveIncrementally(map, path));
+		CHECK(test::readFile(path) == expected);
+	}
+}
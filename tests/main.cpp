@@ -0,0 +1,153 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+// rme-tests, runs the tests of the map code without opening a window. It
+// uses the synthetic item types and brushes of rme-bench.
+//
+//   rme-tests [--data=tests/data] [--update-data] [<test> ...]
+//
+// Run it from the root of the repository, or point --data at tests/data.
+
+#include "main.h"
+
+#include "settings.h"
+
+#include "map_generator.h"
+#include "test.h"
+
+#include <fstream>
+#include <wx/init.h>
+
+namespace {
+	struct TestCase
+	{
+		const char* name;
+		test::Function function;
+	};
+
+	struct Failure
+	{
+		std::string message;
+	};
+
+	std::vector<TestCase>& getTestCases()
+	{
+		static std::vector<TestCase> test_cases;
+		return test_cases;
+	}
+
+	std::string data_dir = "tests/data";
+	std::string temp_dir;
+	bool update_data = false;
+}
+
+test::Registration::Registration(const char* name, Function function)
+{
+	getTestCases().push_back({name, function});
+}
+
+void test::fail(const char* file, int line, const std::string& message)
+{
+	throw Failure{std::string(file) + ":" + i2s(line) + ": " + message};
+}
+
+std::string test::getDataPath(const std::string& name)
+{
+	return data_dir + "/" + name;
+}
+
+std::string test::getTempPath(const std::string& name)
+{
+	return temp_dir + "/" + name;
+}
+
+std::string test::readFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+bool test::writeFile(const std::string& path, const std::string& data)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(data.data(), data.size());
+	return file.good();
+}
+
+bool test::isUpdatingData()
+{
+	return update_data;
+}
+
+int main(int argc, char** argv)
+{
+	std::set<std::string> only;
+	for(int i = 1; i < argc; ++i) {
+		const std::string argument = argv[i];
+		if(argument.compare(0, 7, "--data=") == 0) {
+			data_dir = argument.substr(7);
+		} else if(argument == "--update-data") {
+			update_data = true;
+		} else if(argument.compare(0, 2, "--") == 0) {
+			std::cerr << "Unknown option " << argument << std::endl;
+			return 1;
+		} else {
+			only.insert(argument);
+		}
+	}
+
+	// Only the base library, no display is needed
+	wxInitializer initializer(argc, argv);
+	if(!initializer.IsOk()) {
+		std::cerr << "Could not initialize wxWidgets" << std::endl;
+		return 1;
+	}
+
+	temp_dir = nstr(wxFileName::CreateTempFileName("rme-tests"));
+	wxRemoveFile(wxstr(temp_dir));
+	if(!wxFileName::Mkdir(wxstr(temp_dir), wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+		std::cerr << "Could not create " << temp_dir << std::endl;
+		return 1;
+	}
+
+	bench::setupItemsAndBrushes();
+
+	int run = 0;
+	int failed = 0;
+	for(const TestCase& test_case : getTestCases()) {
+		if(!only.empty() && only.count(test_case.name) == 0) {
+			continue;
+		}
+
+		++run;
+		try {
+			test_case.function();
+			std::cout << "[ OK ] " << test_case.name << std::endl;
+		} catch(const Failure& failure) {
+			++failed;
+			std::cout << "[FAIL] " << test_case.name << ": " << failure.message << std::endl;
+		} catch(const std::exception& exception) {
+			++failed;
+			std::cout << "[FAIL] " << test_case.name << ": exception: " << exception.what() << std::endl;
+		}
+	}
+
+	wxFileName::Rmdir(wxstr(temp_dir), wxPATH_RMDIR_RECURSIVE);
+
+	std::cout << run - failed << " of " << run << " tests passed" << std::endl;
+	return failed == 0 ? 0 : 1;
+}
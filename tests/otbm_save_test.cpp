@@ -0,0 +1,142 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "editor.h"
+#include "copybuffer.h"
+#include "iomap_otbm.h"
+#include "tile.h"
+#include "item.h"
+#include "complexitem.h"
+#include "house.h"
+#include "town.h"
+
+#include "map_generator.h"
+#include "test.h"
+
+namespace {
+	Tile* addTile(Map& map, int x, int y, int z, std::initializer_list<Item*> items, uint16_t flags = 0)
+	{
+		Tile* tile = map.allocator(map.createTileL(x, y, z));
+		for(Item* item : items) {
+			tile->addItem(item);
+		}
+		tile->setMapFlags(flags);
+		tile->update();
+		map.setTile(x, y, z, tile);
+		return tile;
+	}
+
+	Item* createItem(uint16_t id, uint16_t subtype = 0xFFFF)
+	{
+		return Item::Create(id, subtype);
+	}
+
+	// Tiles on two floors and in three 256x256 areas (so five tile area nodes),
+	// a stackable item, a container, an action id that needs escaping, a unique
+	// id, a house tile, tile flags, a tile without ground, a town and a waypoint.
+	// It uses the item types of rme-bench, see bench/map_generator.cpp.
+	void buildFixtureMap(Map& map)
+	{
+		map.setSpawnFilename("fixture-spawn.xml");
+		map.setHouseFilename("fixture-house.xml");
+		map.setMapDescription("Save fixture");
+
+		addTile(map, 1000, 1000, 7, { createItem(100), createItem(200, 25), createItem(210) });
+
+		Item* door_key = createItem(220);
+		door_key->setActionID(0x12FE);
+		addTile(map, 1001, 1000, 7, { createItem(104), door_key }, TILESTATE_PROTECTIONZONE);
+
+		Container* container = static_cast<Container*>(createItem(300));
+		container->getVector().push_back(createItem(201, 3));
+		container->getVector().push_back(createItem(230));
+		Tile* house_tile = addTile(map, 1021, 1001, 7, { createItem(100), container });
+
+		Item* lever = createItem(215);
+		lever->setUniqueID(2000);
+		addTile(map, 1300, 1000, 7, { createItem(101), lever });
+		addTile(map, 1000, 1300, 7, { createItem(105) });
+
+		addTile(map, 1000, 1000, 6, { createItem(102), createItem(240) });
+		addTile(map, 1301, 1001, 6, { createItem(250) });
+
+		Town* town = newd Town(1);
+		town->setName("Fixture Town");
+		town->setTemplePosition(Position(1000, 1000, 7));
+		map.towns.addTown(town);
+
+		House* house = newd House(map);
+		house->id = 5;
+		house->name = "Fixture House";
+		house->townid = town->getID();
+		map.houses.addHouse(house);
+		house->addTile(house_tile);
+
+		Waypoint* waypoint = newd Waypoint();
+		waypoint->name = "temple";
+		waypoint->pos = Position(1001, 1000, 7);
+		map.waypoints.addWaypoint(waypoint);
+	}
+
+	// The first description names the version of the editor. It is left out of
+	// the comparison so that the expected file outlives version bumps. Nothing
+	// in front of it needs escaping for this map.
+	std::string withoutEditorVersion(const std::string& data)
+	{
+		// File identifier, root node with the map and items versions and the map
+		// size, map data node and the attribute byte of the description
+		const size_t offset = 4 + 2 + 4 + 2 + 2 + 4 + 4 + 2 + 1;
+		if(data.size() < offset + 2)
+			return data;
+
+		const size_t length = uint8_t(data[offset]) | uint8_t(data[offset + 1]) << 8;
+		return data.substr(0, offset) + data.substr(offset + 2 + length);
+	}
+}
+
+// The tile areas are serialized on the worker threads, the file must come out
+// the same as tests/data/save_fixture.otbm no matter how many threads there are
+TEST_CASE(otbm_save_matches_expected_file)
+{
+	CopyBuffer copybuffer;
+	Editor editor(copybuffer, bench::getMapVersion());
+	Map& map = editor.getMap();
+	buildFixtureMap(map);
+
+	const std::string expected_path = test::getDataPath("save_fixture.otbm");
+	const std::string path = test::getTempPath("save_fixture.otbm");
+	test::ScopedSetting magic_number(Config::SAVE_WITH_OTB_MAGIC_NUMBER, 0);
+
+	for(int threads : { 1, 4, 16 }) {
+		test::ScopedSetting worker_threads(Config::WORKER_THREADS, threads);
+
+		IOMapOTBM saver(map.getVersion());
+		CHECK_MESSAGE(saver.saveMap(map, wxstr(path)), nstr(saver.getError()));
+
+		const std::string data = test::readFile(path);
+		if(threads == 1 && test::isUpdatingData()) {
+			CHECK(test::writeFile(expected_path, data));
+		}
+
+		const std::string expected = test::readFile(expected_path);
+		CHECK_MESSAGE(!expected.empty(), "Could not read " + expected_path);
+		CHECK_MESSAGE(withoutEditorVersion(data) == withoutEditorVersion(expected),
+			"The map saved on " + i2s(threads) + " threads differs from " + expected_path);
+	}
+}
@@ -0,0 +1,111 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "editor.h"
+#include "copybuffer.h"
+#include "iomap_otbm.h"
+#include "otgz.h"
+
+#include "map_generator.h"
+#include "test.h"
+
+namespace {
+	// Big enough for the compressor to split the map into several blocks
+	MapGeneratorOptions getMapOptions()
+	{
+		MapGeneratorOptions options;
+		options.width = 256;
+		options.height = 256;
+		options.houses = 8;
+		options.spawns = 16;
+		options.zones = 0;
+		return options;
+	}
+
+	bool save(Map& map, const std::string& path)
+	{
+		IOMapOTBM saver(map.getVersion());
+		return saver.saveMap(map, wxstr(path));
+	}
+
+	// Loads 'path' into a new map, saves that as a plain .otbm and returns the
+	// map, spawn and house files it wrote
+	std::string loadAndSave(const std::string& path, const std::string& otbm_path)
+	{
+		CopyBuffer copybuffer;
+		Editor editor(copybuffer, bench::getMapVersion());
+		Map& map = editor.getMap();
+		IOMapOTBM loader(bench::getMapVersion());
+		CHECK_MESSAGE(loader.loadMap(map, wxstr(path)), nstr(loader.getError()));
+		CHECK(save(map, otbm_path));
+		return test::readFile(otbm_path)
+			+ test::readFile(test::getTempPath(map.getSpawnFilename()))
+			+ test::readFile(test::getTempPath(map.getHouseFilename()));
+	}
+}
+
+TEST_CASE(otgz_round_trip_matches_otbm)
+{
+	// The archive entry always starts with the OTBM identifier
+	test::ScopedSetting magic_number(Config::SAVE_WITH_OTB_MAGIC_NUMBER, 1);
+	test::ScopedSetting worker_threads(Config::WORKER_THREADS, 4);
+
+	CopyBuffer copybuffer;
+	Editor editor(copybuffer, bench::getMapVersion());
+	Map& map = editor.getMap();
+	bench::generateMap(map, getMapOptions());
+
+	const std::string otbm_path = test::getTempPath("round-trip.otbm");
+	const std::string otgz_path = test::getTempPath("round-trip.otgz");
+	CHECK(save(map, otbm_path));
+	CHECK(save(map, otgz_path));
+
+	// The map inside the archive is the plain file, byte for byte
+	const std::string otbm = test::readFile(otbm_path);
+	OTGZReader archive(otgz_path);
+	CHECK(archive.isOk());
+
+	std::string name;
+	uint64_t size;
+	std::string archived;
+	bool has_spawns = false;
+	bool has_houses = false;
+	while(archive.nextFile(name, size)) {
+		if(name == "world/map.otbm") {
+			CHECK(archive.readAll(archived));
+			CHECK(archived.size() == size);
+		} else if(name == "world/spawns.xml") {
+			has_spawns = true;
+		} else if(name == "world/houses.xml") {
+			has_houses = true;
+		}
+	}
+	CHECK(archive.isOk());
+	CHECK(has_spawns && has_houses);
+	CHECK(!otbm.empty());
+	CHECK_MESSAGE(archived == otbm, "world/map.otbm differs from " + otbm_path);
+
+	// And both read back into the same map, spawns and houses included. The
+	// plain map first, it reads the spawn and house files next to it that the
+	// second save writes over.
+	const std::string from_otbm = loadAndSave(otbm_path, test::getTempPath("from-otbm.otbm"));
+	const std::string from_otgz = loadAndSave(otgz_path, test::getTempPath("from-otgz.otbm"));
+	CHECK(!from_otbm.empty());
+	CHECK(from_otgz == from_otbm);
+}
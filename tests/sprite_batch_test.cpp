@@ -0,0 +1,145 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "sprite_batch.h"
+
+#include "test.h"
+
+// SpriteBatch::prepare() builds the vertices and commands that flush() hands
+// to OpenGL, so these run without a context
+
+namespace {
+	TextureRegion getRegion(uint32_t texture, float u0 = 0.f, float v0 = 0.f)
+	{
+		TextureRegion region;
+		region.texture = texture;
+		region.u0 = u0;
+		region.v0 = v0;
+		region.u1 = u0 + 0.25f;
+		region.v1 = v0 + 0.25f;
+		return region;
+	}
+
+	// Texture and vertex count of every command, in the order they are drawn
+	std::vector<std::pair<uint32_t, uint32_t>> getCommands(const SpriteBatch& batch)
+	{
+		std::vector<std::pair<uint32_t, uint32_t>> result;
+		for(const SpriteBatch::Command& command : batch.getCommands()) {
+			result.emplace_back(command.texture, command.count);
+		}
+		return result;
+	}
+
+	// Top left corner of every quad, in the order they are drawn
+	std::vector<std::pair<float, float>> getCorners(const SpriteBatch& batch)
+	{
+		std::vector<std::pair<float, float>> result;
+		const std::vector<SpriteBatch::Vertex>& vertices = batch.getVertices();
+		for(size_t i = 0; i < vertices.size(); i += 4) {
+			result.emplace_back(vertices[i].x, vertices[i].y);
+		}
+		return result;
+	}
+
+	using Commands = std::vector<std::pair<uint32_t, uint32_t>>;
+	using Corners = std::vector<std::pair<float, float>>;
+}
+
+TEST_CASE(sprite_batch_groups_quads_by_texture)
+{
+	SpriteBatch batch;
+	// A row of tiles, none overlaps another
+	batch.add(0, 0, 32, getRegion(1), 255, 255, 255, 255);
+	batch.add(32, 0, 32, getRegion(2), 255, 255, 255, 255);
+	batch.add(64, 0, 32, getRegion(1, 0.25f), 255, 255, 255, 255);
+	batch.addSquare(96, 0, 32, 255, 0, 0, 128);
+	batch.add(128, 0, 32, getRegion(2, 0.5f), 255, 255, 255, 255);
+	batch.addSquare(160, 0, 32, 0, 255, 0, 128);
+	CHECK(batch.getQuadCount() == 6);
+
+	batch.prepare();
+	CHECK(getCommands(batch) == Commands({ {1, 8}, {2, 8}, {0, 8} }));
+	// Within a command the quads keep the order they were added in
+	CHECK(getCorners(batch) == Corners({ {0, 0}, {64, 0}, {32, 0}, {128, 0}, {96, 0}, {160, 0} }));
+
+	const std::vector<SpriteBatch::Command>& commands = batch.getCommands();
+	CHECK(commands[0].first == 0 && commands[1].first == 8 && commands[2].first == 16);
+}
+
+TEST_CASE(sprite_batch_keeps_overlapping_quads_in_order)
+{
+	SpriteBatch batch;
+	// Ground, a sprite on top of it and another ground sprite over both
+	batch.add(0, 0, 32, getRegion(1), 255, 255, 255, 255);
+	batch.add(0, 0, 32, getRegion(2), 255, 255, 255, 255);
+	batch.add(16, 16, 32, getRegion(1), 255, 255, 255, 255);
+	// The square overlaps the quad before it. The last quad overlaps neither
+	// of them, so it joins the command of the second quad.
+	batch.addSquare(40, 40, 8, 0, 0, 0, 255);
+	batch.add(0, 0, 8, getRegion(2), 255, 255, 255, 255);
+
+	batch.prepare();
+	CHECK(getCommands(batch) == Commands({ {1, 4}, {2, 8}, {1, 4}, {0, 4} }));
+	CHECK(getCorners(batch) == Corners({ {0, 0}, {0, 0}, {0, 0}, {16, 16}, {40, 40} }));
+}
+
+TEST_CASE(sprite_batch_writes_quad_vertices)
+{
+	SpriteBatch batch;
+	batch.add(10, 20, 32, getRegion(3, 0.5f, 0.25f), 1, 2, 3, 4);
+	batch.addSquare(50, 60, 8, 5, 6, 7, 8);
+	batch.prepare();
+
+	const std::vector<SpriteBatch::Vertex>& vertices = batch.getVertices();
+	CHECK(vertices.size() == 8);
+
+	// Corners go clockwise from the top left, with the texture coordinates of the region
+	const float expected[8][4] = {
+		{ 10, 20, 0.5f, 0.25f }, { 42, 20, 0.75f, 0.25f }, { 42, 52, 0.75f, 0.5f }, { 10, 52, 0.5f, 0.5f },
+		{ 50, 60, 0.f, 0.f }, { 58, 60, 1.f, 0.f }, { 58, 68, 1.f, 1.f }, { 50, 68, 0.f, 1.f },
+	};
+	for(size_t i = 0; i < vertices.size(); ++i) {
+		const SpriteBatch::Vertex& vertex = vertices[i];
+		CHECK_MESSAGE(vertex.x == expected[i][0] && vertex.y == expected[i][1] &&
+			vertex.u == expected[i][2] && vertex.v == expected[i][3], "Vertex " + i2s(i));
+	}
+	CHECK(vertices[0].r == 1 && vertices[0].g == 2 && vertices[0].b == 3 && vertices[0].a == 4);
+	CHECK(vertices[7].r == 5 && vertices[7].g == 6 && vertices[7].b == 7 && vertices[7].a == 8);
+}
+
+TEST_CASE(sprite_batch_looks_back_a_limited_number_of_commands)
+{
+	SpriteBatch batch;
+	batch.add(0, 0, 32, getRegion(1), 255, 255, 255, 255);
+	for(uint32_t i = 0; i < SpriteBatch::LOOKBACK; ++i) {
+		batch.add(32.f * (i + 1), 0, 32, getRegion(100 + i), 255, 255, 255, 255);
+	}
+	// The command of texture 1 is now too far back to be joined
+	batch.add(0, 64, 32, getRegion(1), 255, 255, 255, 255);
+	batch.prepare();
+
+	const std::vector<SpriteBatch::Command>& commands = batch.getCommands();
+	CHECK(commands.size() == SpriteBatch::LOOKBACK + 2);
+	CHECK(commands.front().texture == 1 && commands.front().count == 4);
+	CHECK(commands.back().texture == 1 && commands.back().count == 4);
+
+	batch.clear();
+	CHECK(batch.empty());
+	CHECK(batch.getCommands().empty() && batch.getVertices().empty());
+}
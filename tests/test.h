@@ -0,0 +1,86 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_TESTS_TEST_H_
+#define RME_TESTS_TEST_H_
+
+#include "settings.h"
+
+#include <string>
+
+// A test is a function registered with TEST_CASE, a failed CHECK ends it and
+// the runner goes on with the next one. See tests/main.cpp.
+
+namespace test {
+	using Function = void (*)();
+
+	struct Registration
+	{
+		Registration(const char* name, Function function);
+	};
+
+	[[noreturn]] void fail(const char* file, int line, const std::string& message);
+
+	// Files checked in under tests/data
+	std::string getDataPath(const std::string& name);
+	// A scratch directory that is removed when the run is over
+	std::string getTempPath(const std::string& name);
+
+	std::string readFile(const std::string& path);
+	bool writeFile(const std::string& path, const std::string& data);
+	// Set with --update-data, tests write what they produce over their expected files
+	bool isUpdatingData();
+
+	// Changes an integer setting until the end of the scope
+	class ScopedSetting
+	{
+	public:
+		ScopedSetting(Config::Key key, int value) :
+			key(key),
+			previous(g_settings.getInteger(key))
+		{
+			g_settings.setInteger(key, value);
+		}
+		~ScopedSetting() { g_settings.setInteger(key, previous); }
+
+		ScopedSetting(const ScopedSetting&) = delete;
+		ScopedSetting& operator=(const ScopedSetting&) = delete;
+
+	private:
+		Config::Key key;
+		int previous;
+	};
+}
+
+#define TEST_CASE(name) \
+	static void test_##name(); \
+	static test::Registration registration_##name(#name, test_##name); \
+	static void test_##name()
+
+#define CHECK(condition) \
+	do { \
+		if(!(condition)) \
+			test::fail(__FILE__, __LINE__, #condition); \
+	} while(false)
+
+#define CHECK_MESSAGE(condition, message) \
+	do { \
+		if(!(condition)) \
+			test::fail(__FILE__, __LINE__, message); \
+	} while(false)
+
+#endif